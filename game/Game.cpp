@@ -29,6 +29,47 @@ namespace coup {
     }
 
 
+    namespace {
+        constexpr uint8_t PACK_FORMAT = 1;
+        constexpr uint8_t NO_PLAYER = 0xFF;
+
+        Player *createRole(const Role role, const string &name) {
+            switch (role) {
+                case Role::Governor: return new Governor(name);
+                case Role::Spy: return new Spy(name);
+                case Role::Baron: return new Baron(name);
+                case Role::General: return new General(name);
+                case Role::Judge: return new Judge(name);
+                case Role::Merchant: return new Merchant(name);
+                default:
+                    throw InitError("Corrupt game snapshot: bad role");
+            }
+        }
+
+        /** @brief Bounds-checked little-endian reads over a snapshot. */
+        struct PackReader {
+            const uint8_t *data;
+            size_t length;
+            size_t pos = 0;
+
+            uint8_t u8() {
+                if (pos >= length) throw InitError("Corrupt game snapshot: truncated");
+                return data[pos++];
+            }
+
+            uint16_t u16() {
+                const uint16_t low = u8();
+                return static_cast<uint16_t>(low | u8() << 8);
+            }
+
+            uint32_t u32() {
+                const uint32_t low = u16();
+                return low | static_cast<uint32_t>(u16()) << 16;
+            }
+        };
+    }
+
+
     Game::Game(const vector<string> &names) {
         // Assign each player a specific role for testing
         for (size_t i = 0; i < names.size(); ++i) {
@@ -37,6 +78,19 @@ namespace coup {
         currentPlayerTurn = 0; // Start with the first player
     }
 
+    Game::Game(const vector<string> &names, const vector<Role> &roles) {
+        if (roles.size() != names.size()) {
+            throw InitError("Every player needs a role");
+        }
+        for (const Role role: roles) {
+            if (role == Role::Unknown) throw InitError("Every player needs a role");
+        }
+        for (size_t i = 0; i < names.size(); ++i) {
+            players.push_back(createRole(roles[i], names[i]));
+        }
+        currentPlayerTurn = 0;
+    }
+
     Game::Game(const std::vector<std::string>& names, bool debugRole) {
         for (const auto& name : names) {
             if (debugRole) {
@@ -90,7 +144,7 @@ namespace coup {
                 players.push_back(nullptr);
             }
         }
-        // Add any other data members here as needed
+        copyHistory(other);
     }
 
     // Copy assignment operator
@@ -117,12 +171,106 @@ namespace coup {
                 players.push_back(nullptr);
             }
         }
-        // Add any other data members here as needed
+        copyHistory(other);
 
         return *this;
     }
 
 
+    //----------------------------------------------------------------------------
+    // Compact snapshots
+    //----------------------------------------------------------------------------
+
+    vector<uint8_t> Game::pack() const {
+        auto indexOf = [this](const Player *p) -> uint8_t {
+            for (size_t i = 0; i < players.size(); ++i) {
+                if (players[i] == p) return static_cast<uint8_t>(i);
+            }
+            return NO_PLAYER;
+        };
+        vector<uint8_t> out;
+        out.reserve(16 + players.size() * 12);
+        auto u16 = [&out](const uint32_t v) {
+            out.push_back(static_cast<uint8_t>(v));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+        };
+        out.push_back(PACK_FORMAT);
+        out.push_back(static_cast<uint8_t>(players.size()));
+        out.push_back(static_cast<uint8_t>(currentPlayerTurn));
+        u16(static_cast<uint32_t>(turnCount));
+        u16(static_cast<uint32_t>(turnCount) >> 16);
+        u16(static_cast<uint32_t>(historySize));
+        u16(static_cast<uint32_t>(historySize) >> 16);
+        for (const Player *p: players) {
+            out.push_back(static_cast<uint8_t>(p->getRole()));
+            out.push_back(static_cast<uint8_t>(p->getName().size()));
+            out.insert(out.end(), p->getName().begin(), p->getName().end());
+            u16(static_cast<uint32_t>(p->getCoins()));
+            out.push_back(static_cast<uint8_t>(p->getNumOfTurns()));
+            out.push_back(static_cast<uint8_t>(p->canGather | p->canTax << 1 | p->canBribe << 2 |
+                                               p->canArrest << 3 | p->canCoup << 4 | p->coupShield << 5));
+            out.push_back(indexOf(p->getLastArrestedPlayer()));
+        }
+        // Ring slots in storage order; only the filled ones while the ring is not full yet
+        for (size_t i = 0; i < recentActionCount(); ++i) {
+            out.push_back(static_cast<uint8_t>(history[i].action));
+            out.push_back(indexOf(history[i].actor));
+            out.push_back(indexOf(history[i].target));
+        }
+        return out;
+    }
+
+    Game Game::unpack(const uint8_t *data, const size_t length) {
+        PackReader in{data, length};
+        if (in.u8() != PACK_FORMAT) {
+            throw InitError("Corrupt game snapshot: unknown format");
+        }
+        Game game(vector<string>{});
+        const size_t count = in.u8();
+        game.currentPlayerTurn = in.u8();
+        game.turnCount = static_cast<int>(in.u32());
+        game.historySize = in.u32();
+        vector<uint8_t> arrestedBy(count);
+        for (size_t i = 0; i < count; ++i) {
+            const Role role = static_cast<Role>(in.u8());
+            string name(in.u8(), '\0');
+            for (char &c: name) c = static_cast<char>(in.u8());
+            Player *p = createRole(role, name);
+            game.players.push_back(p); // owned by game from here on, even if a later read throws
+            p->addCoins(in.u16());
+            const int turns = in.u8();
+            p->resetPlayerTurn();
+            if (turns == 0) p->playerUsedTurn();
+            for (int t = 1; t < turns; ++t) p->addExtraTurn();
+            const uint8_t flags = in.u8(); // after playerUsedTurn, which clears debuffs
+            p->canGather = flags & 1;
+            p->canTax = flags >> 1 & 1;
+            p->canBribe = flags >> 2 & 1;
+            p->canArrest = flags >> 3 & 1;
+            p->canCoup = flags >> 4 & 1;
+            p->coupShield = flags >> 5 & 1;
+            arrestedBy[i] = in.u8();
+        }
+        auto player = [&game](const uint8_t index) -> Player *{
+            if (index == NO_PLAYER) return nullptr;
+            if (index >= game.players.size()) throw InitError("Corrupt game snapshot: bad player index");
+            return game.players[index];
+        };
+        for (size_t i = 0; i < count; ++i) {
+            game.players[i]->setLastArrestedPlayer(player(arrestedBy[i]));
+        }
+        for (size_t i = 0; i < game.recentActionCount(); ++i) {
+            const ActionType action = static_cast<ActionType>(in.u8());
+            const Player *actor = player(in.u8());
+            game.history[i] = ActionRecord{action, actor, player(in.u8())};
+        }
+        if (in.pos != length || (count > 0 && game.currentPlayerTurn >= static_cast<int>(count))) {
+            throw InitError("Corrupt game snapshot: inconsistent");
+        }
+        return game;
+    }
+
+
     void Game::getRandomRole(vector<Player *> &players) {
         srand(static_cast<unsigned>(time(nullptr)));
         for (Player *&p: players) {
@@ -181,10 +329,55 @@ namespace coup {
         }
     }
 
-    int Game::getTurn() {
+    int Game::getTurn() const {
         return currentPlayerTurn;
     }
 
+    int Game::getTurnCount() const {
+        return turnCount;
+    }
+
+    //------------------------------------------------------------------------------
+    // Recent-action history
+    //------------------------------------------------------------------------------
+
+    void Game::recordAction(const ActionType action, const Player *actor, const Player *target) {
+        history[historySize % history.size()] = ActionRecord{action, actor, target};
+        ++historySize;
+    }
+
+    size_t Game::recentActionCount() const {
+        return historySize < history.size() ? historySize : history.size();
+    }
+
+    const ActionRecord &Game::recentAction(const size_t back) const {
+        if (back >= recentActionCount()) {
+            throw out_of_range("No such recent action");
+        }
+        return history[(historySize - 1 - back) % history.size()];
+    }
+
+    void Game::copyHistory(const Game &other) {
+        turnCount = other.turnCount;
+        historySize = other.historySize;
+        // Point records at this game's clones, matched by seat index
+        auto remap = [&](const Player *p) -> const Player *{
+            for (size_t i = 0; i < other.players.size(); ++i) {
+                if (other.players[i] == p) return players[i];
+            }
+            return nullptr;
+        };
+        for (size_t i = 0; i < history.size(); ++i) {
+            history[i] = ActionRecord{
+                other.history[i].action, remap(other.history[i].actor), remap(other.history[i].target)
+            };
+        }
+        // Player clones still point at the other game's players
+        for (size_t i = 0; i < players.size(); ++i) {
+            if (players[i]) players[i]->setLastArrestedPlayer(remap(other.players[i]->getLastArrestedPlayer()));
+        }
+    }
+
     void Game::isMerchantTurn(Player *current) {
         if (current->getRole() == Role::Merchant) {
             if (current->getCoins() >= 3) {
@@ -198,6 +391,7 @@ namespace coup {
         current->resetPlayerTurn(); // Reset per-turn flags
         current->removeDebuff(); // Clear status effects
         currentPlayerTurn = (getTurn() + 1) % players.size();
+        ++turnCount;
         isMerchantTurn(current); // check if current player is Merchant to use passive
 
     }
@@ -255,6 +449,7 @@ namespace coup {
     void Game::skipTurn(Player *currentPlayer) {
         currentPlayer->removeDebuff();
         currentPlayer->playerUsedTurn();
+        recordAction(ActionType::Skip, currentPlayer);
 
     }
 
@@ -275,6 +470,7 @@ namespace coup {
             throw GatherError("Gather action failed.");
         }
         currentPlayer->gather();
+        recordAction(ActionType::Gather, currentPlayer);
     }
 
 
@@ -290,6 +486,7 @@ namespace coup {
         }
 
         currentPlayer->tax();
+        recordAction(ActionType::Tax, currentPlayer);
     }
 
 
@@ -304,6 +501,16 @@ namespace coup {
             throw JudgeBlockBribeError("Bribe blocked by judge logic.");
         }
         currentPlayer->bribe();
+        recordAction(ActionType::Bribe, currentPlayer);
+    }
+
+
+    void Game::useAbility(Player *currentPlayer) {
+        if (players[currentPlayerTurn] != currentPlayer) {
+            throw TurnError("It's not your turn.");
+        }
+        currentPlayer->useAbility(*this);
+        recordAction(ActionType::Ability, currentPlayer);
     }
 
 
@@ -318,6 +525,7 @@ namespace coup {
             throw ArrestError("Arrest failed: blocked by spy");
         }
         currentPlayer->arrest(targetPlayer);
+        recordAction(ActionType::Arrest, currentPlayer, targetPlayer);
     }
 
 
@@ -329,6 +537,7 @@ namespace coup {
             throw SelfError("You can not sanction yourself");
         }
         currentPlayer->sanction(targetPlayer);
+        recordAction(ActionType::Sanction, currentPlayer, targetPlayer);
         // Handle judge retaliation
         if (targetPlayer->getRole() == Role::Judge) {
             try {
@@ -359,6 +568,12 @@ namespace coup {
             if (players[i] == targetPlayer) {
                 if (i < currentPlayerTurn) --currentPlayerTurn;
                 players.erase(players.begin() + i);
+                recordAction(ActionType::Coup, currentPlayer, targetPlayer);
+                // Forget the removed player so the history never holds a dangling pointer
+                for (ActionRecord &record: history) {
+                    if (record.actor == targetPlayer) record.actor = nullptr;
+                    if (record.target == targetPlayer) record.target = nullptr;
+                }
                 delete targetPlayer;
                 break;
             }
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "player/Player.hpp"
@@ -13,7 +16,22 @@ namespace coup {
         Bribe,    ///< Pay coins to gain an extra turn
         Arrest,   ///< Steal a coin from another player
         Sanction, ///< Impose a penalty on another player
-        Coup      ///< Eliminate a player at high cost
+        Coup,     ///< Eliminate a player at high cost
+        Gather,   ///< Collect a single coin
+        Ability,  ///< Use the role's active ability
+        Skip      ///< Give up the current action
+    };
+
+    /**
+     * @struct ActionRecord
+     * @brief One entry of the game's recent-action history.
+     *
+     * Pointers are cleared when the player they refer to is couped.
+     */
+    struct ActionRecord {
+        ActionType action = ActionType::Skip; ///< What was played
+        const Player* actor = nullptr;        ///< Who played it
+        const Player* target = nullptr;       ///< Target, nullptr for self actions
     };
 
     /**
@@ -25,6 +43,24 @@ namespace coup {
     class Game {
     private:
         int currentPlayerTurn = 0;  ///< Index of the player whose turn it is
+        int turnCount = 0;          ///< Turns completed since the game started
+
+        std::array<ActionRecord, 8> history{}; ///< Ring buffer of recent actions
+        size_t historySize = 0;                ///< Actions recorded so far (all time)
+
+        /**
+         * @brief Append an action to the recent-action history.
+         * @param action Action that succeeded
+         * @param actor Acting player
+         * @param target Target player, nullptr for self actions
+         */
+        void recordAction(ActionType action, const Player* actor, const Player* target = nullptr);
+
+        /**
+         * @brief Copy counters, history and last arrests from another game, remapping player pointers.
+         * @param other Game being copied (its players must already be cloned into this one)
+         */
+        void copyHistory(const Game& other);
 
         //------------------------------------------------------------------------
         // Internal helpers for coin management
@@ -87,6 +123,14 @@ namespace coup {
          */
         explicit Game(const std::vector<std::string> &names, bool debugRole);
 
+        /**
+         * @brief Initialize a new game with a chosen role for every player.
+         * @param names List of player names
+         * @param roles Role per name (Role::Unknown is not allowed)
+         * @throws InitError if the sizes differ or a role is Unknown
+         */
+        Game(const std::vector<std::string> &names, const std::vector<Role> &roles);
+
         /**
          * @brief Randomly assign a role to a player by name.
          * @param name The name of the player
@@ -131,10 +175,28 @@ namespace coup {
         /**
          * @return Index of the player whose turn it currently is.
          */
-        int getTurn();
+        int getTurn() const;
 
         void isMerchantTurn(Player *current);
 
+        /**
+         * @return Number of turns completed since the game started.
+         */
+        int getTurnCount() const;
+
+        /**
+         * @return Number of actions available through recentAction (at most 8).
+         */
+        size_t recentActionCount() const;
+
+        /**
+         * @brief Access the recent-action history, newest first.
+         * @param back 0 for the latest action, 1 for the one before, ...
+         * @return The recorded action
+         * @throws std::out_of_range if back >= recentActionCount()
+         */
+        const ActionRecord& recentAction(size_t back) const;
+
         /**
          * @return Name of the player whose turn it currently is.
          */
@@ -186,6 +248,12 @@ namespace coup {
          */
         void bribe(Player* currentPlayer);
 
+        /**
+         * @brief Use the acting player's role ability.
+         * @param currentPlayer Acting player
+         */
+        void useAbility(Player* currentPlayer);
+
         /**
          * @brief Arrest another player, stealing a coin.
          * @param currentPlayer Acting player
@@ -237,6 +305,25 @@ namespace coup {
          */
         bool handleBlock(Player* blocker, bool didBlock, const std::string& actionName, int cost = 0);
 
+        //------------------------------------------------------------------------
+        // Compact snapshots
+        //------------------------------------------------------------------------
+
+        /**
+         * @brief Serialize the whole game state into a few dozen bytes.
+         *
+         * Covers every player (role, name, coins, turns left, ability flags,
+         * last arrest), the turn and the recent-action history.
+         * @return Bytes for unpack()
+         */
+        std::vector<uint8_t> pack() const;
+
+        /**
+         * @brief Rebuild a game from pack() output.
+         * @throws InitError if the bytes are not a valid snapshot
+         */
+        static Game unpack(const uint8_t* data, size_t length);
+
         //------------------------------------------------------------------------
         // Testing and setup helpers
         //------------------------------------------------------------------------
@@ -197,3 +197,13 @@ public:
     explicit SanctionError(const std::string& message)
         : std::runtime_error(message) {}
 };
+
+/**
+ * @class ProtocolError
+ * @brief Thrown when a network frame is malformed or names an unknown table or seat.
+ */
+class ProtocolError : public std::runtime_error {
+public:
+    explicit ProtocolError(const std::string& message)
+        : std::runtime_error(message) {}
+};
@@ -0,0 +1,106 @@
+#include "ActionSpace.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        bool canBeArrestedBy(const Player *current, const Player *target) {
+            if (current->getLastArrestedPlayer() == target) return false;
+            switch (target->getRole()) {
+                case Role::General: return true;
+                case Role::Merchant: return target->getCoins() >= 2;
+                default: return target->getCoins() >= 1;
+            }
+        }
+    }
+
+    uint32_t legalActionMask(const Game &game) {
+        const auto &players = game.getPlayers();
+        if (players.size() < 2) {
+            return 0;
+        }
+        const size_t turn = static_cast<size_t>(game.getTurn());
+        const Player *current = players[turn];
+        const int coins = current->getCoins();
+        const int opponents = static_cast<int>(players.size()) - 1;
+
+        uint32_t mask = 0;
+        if (coins >= Game::FORCE_COUP) {
+            for (int offset = 1; offset <= opponents; ++offset) {
+                mask |= 1u << (actions::COUP + offset - 1);
+            }
+            return mask;
+        }
+
+        mask |= 1u << actions::SKIP;
+        if (current->isGatherAllow()) mask |= 1u << actions::GATHER;
+        if (current->isTaxAllow()) mask |= 1u << actions::TAX;
+        if (coins >= Game::BRIBE_COST) mask |= 1u << actions::BRIBE;
+        if (current->getRole() == Role::Baron && coins >= 3) mask |= 1u << actions::ABILITY;
+
+        for (int offset = 1; offset <= opponents; ++offset) {
+            const Player *target = players[(turn + offset) % players.size()];
+            if (current->isArrestAllow() && canBeArrestedBy(current, target)) {
+                mask |= 1u << (actions::ARREST + offset - 1);
+            }
+            if (coins >= Game::SANCTION_COST) mask |= 1u << (actions::SANCTION + offset - 1);
+            if (coins >= Game::COUP_COST) mask |= 1u << (actions::COUP + offset - 1);
+        }
+        return mask;
+    }
+
+    ActionType decodeAction(const Game &game, const int action, Player *&target) {
+        target = nullptr;
+        if (action < 0 || action >= actions::COUNT) {
+            throw ActionError("Action index out of range");
+        }
+        switch (action) {
+            case actions::GATHER: return ActionType::Gather;
+            case actions::TAX: return ActionType::Tax;
+            case actions::BRIBE: return ActionType::Bribe;
+            case actions::ABILITY: return ActionType::Ability;
+            case actions::SKIP: return ActionType::Skip;
+            default: break;
+        }
+        const int offset = (action - actions::ARREST) % actions::MAX_OFFSET + 1;
+        const auto &players = game.getPlayers();
+        if (offset >= static_cast<int>(players.size())) {
+            throw ActionError("Target offset beyond the table");
+        }
+        target = players[(static_cast<size_t>(game.getTurn()) + offset) % players.size()];
+        if (action < actions::SANCTION) return ActionType::Arrest;
+        if (action < actions::COUP) return ActionType::Sanction;
+        return ActionType::Coup;
+    }
+
+    void applyAction(Game &game, const int action) {
+        if (action < 0 || action >= actions::COUNT || !((legalActionMask(game) >> action) & 1u)) {
+            throw ActionError("Illegal action index: " + to_string(action));
+        }
+        Player *current = game.getPlayers().at(game.getTurn());
+        Player *target = nullptr;
+        switch (decodeAction(game, action, target)) {
+            case ActionType::Gather: game.gather(current);
+                break;
+            case ActionType::Tax: game.tax(current);
+                break;
+            case ActionType::Bribe: game.bribe(current);
+                break;
+            case ActionType::Ability: game.useAbility(current);
+                break;
+            case ActionType::Skip: game.skipTurn(current);
+                break;
+            case ActionType::Arrest: game.arrest(current, target);
+                break;
+            case ActionType::Sanction: game.sanction(current, target);
+                break;
+            case ActionType::Coup: game.coup(current, target);
+                break;
+        }
+        // advanceTurnIfNeeded prints the game-over banner; only call it while play continues
+        if (game.getPlayers().size() > 1) {
+            game.advanceTurnIfNeeded();
+        }
+    }
+} // namespace coup
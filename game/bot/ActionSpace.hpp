@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @brief Flat action indices shared by bots and environments.
+     *
+     * Targeted actions are encoded by seat offset from the acting player in
+     * turn order: offset 1 is the next player, offset 2 the one after, and so on.
+     */
+    namespace actions {
+        constexpr int GATHER = 0;
+        constexpr int TAX = 1;
+        constexpr int BRIBE = 2;
+        constexpr int ABILITY = 3;
+        constexpr int SKIP = 4;
+        constexpr int MAX_OFFSET = 5;                 ///< Up to five opponents
+        constexpr int ARREST = 5;                     ///< ARREST + offset - 1
+        constexpr int SANCTION = ARREST + MAX_OFFSET; ///< SANCTION + offset - 1
+        constexpr int COUP = SANCTION + MAX_OFFSET;   ///< COUP + offset - 1
+        constexpr int COUNT = COUP + MAX_OFFSET;      ///< Total number of action indices
+    }
+
+    /**
+     * @brief Bit mask of the actions the current player may take without an exception.
+     *
+     * Mirrors the checks in Game and Player plus the GUI rules: forced coup at
+     * FORCE_COUP coins and the ability button for Baron only.
+     * @param game Running game
+     * @return Bit i set if action index i is legal
+     */
+    uint32_t legalActionMask(const Game& game);
+
+    /**
+     * @brief Decode an action index into an action type and target player.
+     * @param game Running game
+     * @param action Flat action index
+     * @param target Set to the targeted player, or nullptr for self actions
+     * @return Decoded action type
+     * @throws ActionError if the index or offset is out of range
+     */
+    ActionType decodeAction(const Game& game, int action, Player*& target);
+
+    /**
+     * @brief Play an action for the current player and advance the turn.
+     *
+     * Block prompts are declined, as in a table without human blockers.
+     * @param game Running game
+     * @param action Flat action index
+     * @throws ActionError if the action is not legal
+     */
+    void applyAction(Game& game, int action);
+} // namespace coup
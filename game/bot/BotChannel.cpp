@@ -0,0 +1,275 @@
+#include "BotChannel.hpp"
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr uint32_t MAGIC = 0x43424F54;  ///< "CBOT"
+        constexpr unsigned SPINS = 2000;        ///< Empty polls before a waiting side starts yielding
+        constexpr unsigned TAG_INDEX_BITS = 20; ///< Low tag bits: request within its batch; high bits: batch
+
+        static_assert(atomic<uint64_t>::is_always_lock_free, "ring indices must be address-free");
+        static_assert(is_trivially_copyable<BotRequest>::value, "requests are copied into shared memory");
+    }
+
+    /**
+     * @brief Header at the start of the mapping, followed by the request and answer slots.
+     */
+    struct BotChannel::Shared {
+        atomic<uint32_t> magic{0};
+        uint32_t slots = 0;
+        atomic<uint32_t> closed{0};
+        alignas(64) atomic<uint64_t> requestHead{0}; ///< Next request the bot takes
+        alignas(64) atomic<uint64_t> requestTail{0}; ///< Next request slot the engine fills
+        alignas(64) atomic<uint64_t> answerHead{0};  ///< Next answer the engine takes
+        alignas(64) atomic<uint64_t> answerTail{0};  ///< Next answer slot the bot fills
+
+        BotRequest *requests() {
+            return reinterpret_cast<BotRequest *>(this + 1);
+        }
+
+        BotAnswer *answers() {
+            return reinterpret_cast<BotAnswer *>(requests() + slots);
+        }
+
+        static size_t bytesFor(const size_t slots) {
+            return sizeof(Shared) + slots * (sizeof(BotRequest) + sizeof(BotAnswer));
+        }
+    };
+
+    BotChannel::BotChannel(Shared *shared, const size_t bytes, string name, const bool owner)
+        : shared(shared), bytes(bytes), name(move(name)), owner(owner) {
+    }
+
+    BotChannel BotChannel::create(const string &name, const size_t slots) {
+        if (slots == 0) {
+            throw InitError("BotChannel needs a positive ring size");
+        }
+        size_t size = 1;
+        while (size < slots) size <<= 1;
+        const size_t bytes = Shared::bytesFor(size);
+        shm_unlink(name.c_str()); // a channel left behind by a crashed engine
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw runtime_error("Cannot create bot channel " + name + ": " + strerror(errno));
+        }
+        void *memory = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+            memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        const string error = strerror(errno);
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw runtime_error("Cannot map bot channel " + name + ": " + error);
+        }
+        Shared *shared = new(memory) Shared();
+        shared->slots = static_cast<uint32_t>(size);
+        shared->magic.store(MAGIC, memory_order_release); // the bot only trusts a finished header
+        return BotChannel(shared, bytes, name, true);
+    }
+
+    BotChannel BotChannel::attach(const string &name) {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            throw runtime_error("Cannot open bot channel " + name + ": " + strerror(errno));
+        }
+        struct stat info{};
+        void *memory = MAP_FAILED;
+        size_t bytes = 0;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Shared)) {
+            bytes = static_cast<size_t>(info.st_size);
+            memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            throw runtime_error("Cannot map bot channel " + name);
+        }
+        Shared *shared = static_cast<Shared *>(memory);
+        if (shared->magic.load(memory_order_acquire) != MAGIC || Shared::bytesFor(shared->slots) != bytes) {
+            munmap(memory, bytes);
+            throw runtime_error(name + " is not a bot channel");
+        }
+        return BotChannel(shared, bytes, name, false);
+    }
+
+    BotChannel::BotChannel(BotChannel &&other) noexcept
+        : shared(other.shared), bytes(other.bytes), name(move(other.name)), owner(other.owner),
+          peerHead(other.peerHead), peerTail(other.peerTail) {
+        other.shared = nullptr;
+    }
+
+    BotChannel &BotChannel::operator=(BotChannel &&other) noexcept {
+        if (this != &other) {
+            release();
+            shared = other.shared;
+            bytes = other.bytes;
+            name = move(other.name);
+            owner = other.owner;
+            peerHead = other.peerHead;
+            peerTail = other.peerTail;
+            other.shared = nullptr;
+        }
+        return *this;
+    }
+
+    BotChannel::~BotChannel() {
+        release();
+    }
+
+    void BotChannel::release() {
+        if (!shared) return;
+        if (owner) {
+            close();
+            shm_unlink(name.c_str()); // a bot still attached keeps its mapping
+        }
+        munmap(shared, bytes);
+        shared = nullptr;
+    }
+
+    //------------------------------------------------------------------------------
+    // Rings
+    //------------------------------------------------------------------------------
+
+    bool BotChannel::sendRequest(const DecisionRequest &request, const uint32_t tag) {
+        const uint64_t t = shared->requestTail.load(memory_order_relaxed);
+        if (t - peerHead == shared->slots) {
+            peerHead = shared->requestHead.load(memory_order_acquire);
+            if (t - peerHead == shared->slots) return false;
+        }
+        BotRequest &slot = shared->requests()[t & (shared->slots - 1)];
+        slot.tag = tag;
+        slot.legal = request.legal;
+        slot.kind = request.kind;
+        slot.challenged = request.challenged;
+        encodeObservation(*request.state, request.player, slot.observation);
+        shared->requestTail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    bool BotChannel::receiveAnswer(BotAnswer &out) {
+        const uint64_t h = shared->answerHead.load(memory_order_relaxed);
+        if (h == peerTail) {
+            peerTail = shared->answerTail.load(memory_order_acquire);
+            if (h == peerTail) return false;
+        }
+        out = shared->answers()[h & (shared->slots - 1)];
+        shared->answerHead.store(h + 1, memory_order_release);
+        return true;
+    }
+
+    bool BotChannel::receiveRequest(BotRequest &out) {
+        const uint64_t h = shared->requestHead.load(memory_order_relaxed);
+        if (h == peerTail) {
+            peerTail = shared->requestTail.load(memory_order_acquire);
+            if (h == peerTail) return false;
+        }
+        out = shared->requests()[h & (shared->slots - 1)];
+        shared->requestHead.store(h + 1, memory_order_release);
+        return true;
+    }
+
+    bool BotChannel::sendAnswer(const BotAnswer &answer) {
+        const uint64_t t = shared->answerTail.load(memory_order_relaxed);
+        if (t - peerHead == shared->slots) {
+            peerHead = shared->answerHead.load(memory_order_acquire);
+            if (t - peerHead == shared->slots) return false;
+        }
+        shared->answers()[t & (shared->slots - 1)] = answer;
+        shared->answerTail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    void BotChannel::close() {
+        shared->closed.store(1, memory_order_release);
+    }
+
+    bool BotChannel::closed() const {
+        return shared->closed.load(memory_order_acquire) != 0;
+    }
+
+    size_t BotChannel::capacity() const {
+        return shared->slots;
+    }
+
+    //------------------------------------------------------------------------------
+    // Policy and bot loop
+    //------------------------------------------------------------------------------
+
+    BatchPolicy remoteBatchPolicy(BotChannel &channel, const int timeoutMs) {
+        uint32_t batches = 0;
+        return [&channel, timeoutMs, batches](const vector<DecisionRequest> &requests, vector<int> &answers) mutable {
+            if (requests.size() > (1u << TAG_INDEX_BITS)) {
+                throw runtime_error("A bot batch holds at most " + to_string(1u << TAG_INDEX_BITS) + " requests");
+            }
+            // Answers still coming for a batch that timed out carry its number and are dropped
+            const uint32_t batch = ++batches << TAG_INDEX_BITS;
+            const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+            size_t sent = 0;
+            size_t received = 0;
+            unsigned idle = 0;
+            // Keep the request ring full and drain answers as they come; a batch may exceed the ring
+            while (received < requests.size()) {
+                bool progress = false;
+                while (sent < requests.size() &&
+                       channel.sendRequest(requests[sent], batch | static_cast<uint32_t>(sent))) {
+                    ++sent;
+                    progress = true;
+                }
+                BotAnswer answer;
+                while (channel.receiveAnswer(answer)) {
+                    progress = true;
+                    const uint32_t index = answer.tag & ((1u << TAG_INDEX_BITS) - 1);
+                    if ((answer.tag ^ batch) >> TAG_INDEX_BITS != 0 || index >= answers.size()) continue;
+                    answers[index] = answer.answer;
+                    ++received;
+                }
+                if (progress) {
+                    idle = 0;
+                } else if (++idle > SPINS) {
+                    if (chrono::steady_clock::now() > deadline) {
+                        throw runtime_error("Bot process stopped answering");
+                    }
+                    this_thread::yield();
+                }
+            }
+        };
+    }
+
+    size_t serveBot(BotChannel &channel, const function<int(const BotRequest &)> &decide) {
+        size_t answered = 0;
+        unsigned idle = 0;
+        BotRequest request;
+        while (true) {
+            // Read the flag first: every request sent before close() is then visible below
+            const bool closing = channel.closed();
+            if (channel.receiveRequest(request)) {
+                const BotAnswer answer{request.tag, decide(request)};
+                while (!channel.sendAnswer(answer)) this_thread::yield();
+                ++answered;
+                idle = 0;
+                continue;
+            }
+            if (closing) return answered;
+            if (++idle > SPINS) this_thread::yield();
+        }
+    }
+} // namespace coup
+
+#endif // __linux__
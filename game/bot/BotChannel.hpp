@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "DecisionService.hpp"
+#include "Observation.hpp"
+
+namespace coup {
+    /**
+     * @struct BotRequest
+     * @brief One decision as an out-of-process bot sees it; copied into shared memory as is.
+     */
+    struct alignas(64) BotRequest {
+        uint32_t tag = 0;                           ///< Echoed back in the answer
+        uint32_t legal = 0;                         ///< Legal answers as a bit mask
+        DecisionKind kind = DecisionKind::Turn;
+        ActionType challenged = ActionType::Skip;   ///< Block only: the action that may be blocked
+        int8_t observation[obs::SIZE] = {};         ///< encodeObservation() for the decider
+    };
+
+    /**
+     * @struct BotAnswer
+     * @brief A bot's reply to the request with the same tag.
+     */
+    struct BotAnswer {
+        uint32_t tag = 0;
+        int32_t answer = 0;
+    };
+
+    /**
+     * @class BotChannel
+     * @brief Two lock-free SPSC rings in POSIX shared memory between the engine and one bot process (Linux).
+     *
+     * Requests (observations) flow engine -> bot and answers flow back. Each ring
+     * keeps head and tail on their own cache lines and each side caches the
+     * other's index, as SpscQueue does, so a decision costs two cache-line
+     * handoffs instead of two socket round trips. The indices are address-free
+     * atomics, valid in both mappings. Exactly one engine thread and one bot
+     * thread may use a channel.
+     */
+    class BotChannel {
+    public:
+        /**
+         * @brief Create a channel (replacing a stale one of the same name); the creator unlinks it.
+         * @param name Shared memory name, "/" followed by letters, digits, '.', '-' or '_'
+         * @param slots Ring size, rounded up to a power of two
+         * @throws InitError if slots is 0
+         * @throws std::runtime_error if the memory cannot be created
+         */
+        static BotChannel create(const std::string& name, size_t slots = 256);
+
+        /**
+         * @brief Map a channel created by the engine, from the bot process.
+         * @throws std::runtime_error if it does not exist or is not a channel
+         */
+        static BotChannel attach(const std::string& name);
+
+        BotChannel(BotChannel&& other) noexcept;
+        BotChannel& operator=(BotChannel&& other) noexcept;
+        BotChannel(const BotChannel&) = delete;
+        BotChannel& operator=(const BotChannel&) = delete;
+        ~BotChannel();
+
+        /**
+         * @brief Engine side: encode a decision for the bot.
+         * @return False if the request ring is full
+         */
+        bool sendRequest(const DecisionRequest& request, uint32_t tag);
+
+        /**
+         * @brief Engine side: take the next answer.
+         * @return False if none is waiting
+         */
+        bool receiveAnswer(BotAnswer& out);
+
+        /**
+         * @brief Bot side: take the next request.
+         * @return False if none is waiting
+         */
+        bool receiveRequest(BotRequest& out);
+
+        /**
+         * @brief Bot side: reply.
+         * @return False if the answer ring is full
+         */
+        bool sendAnswer(const BotAnswer& answer);
+
+        /** @brief Tell the bot no more requests will come. */
+        void close();
+
+        bool closed() const;
+
+        size_t capacity() const;
+
+    private:
+        struct Shared;
+
+        Shared* shared = nullptr;
+        size_t bytes = 0;
+        std::string name;
+        bool owner = false;
+        uint64_t peerHead = 0;  ///< Cached head of the ring this side produces into
+        uint64_t peerTail = 0;  ///< Cached tail of the ring this side consumes from
+
+        BotChannel(Shared* shared, size_t bytes, std::string name, bool owner);
+        void release();
+    };
+
+    /**
+     * @brief Policy that hands every request of a batch to a bot process and waits for the answers.
+     *
+     * Spins briefly, then yields, while the bot thinks. The channel must outlive the policy.
+     * Tags carry a batch number, so late answers to a batch that timed out are ignored.
+     * @param timeoutMs Longest wait for one batch
+     * @throws std::runtime_error (from the policy) if the bot stops answering or a batch
+     *         exceeds 2^20 requests
+     */
+    BatchPolicy remoteBatchPolicy(BotChannel& channel, int timeoutMs = 5000);
+
+    /**
+     * @brief Bot side loop: answer requests until the engine closes the channel.
+     * @param decide Maps a request to its answer
+     * @return Requests answered
+     */
+    size_t serveBot(BotChannel& channel, const std::function<int(const BotRequest&)>& decide);
+} // namespace coup
@@ -0,0 +1,546 @@
+#include "CfrTrainer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    //------------------------------------------------------------------------------
+    // Heads-up abstraction
+    //------------------------------------------------------------------------------
+
+    namespace {
+        constexpr int BLOCK_COST_GENERAL = 5; ///< General pays 5 to block a coup
+        constexpr char CHECKPOINT_MAGIC[4] = {'C', 'F', 'R', '1'};
+        constexpr int ITERATIONS_PER_WORKER = 16; ///< Iterations per thread per batch
+
+        int roleIndex(const Role role) {
+            const int index = static_cast<int>(role);
+            if (index < 0 || index > 5) {
+                throw InitError("CFR abstraction needs a concrete role");
+            }
+            return index;
+        }
+
+        int opponentBucket(const int coins) {
+            if (coins <= 2) return 0;
+            if (coins < Game::COUP_COST) return 1;
+            if (coins < Game::FORCE_COUP) return 2;
+            return 3;
+        }
+
+        bool isBit(const unsigned mask, const int bit) {
+            return (mask >> bit) & 1u;
+        }
+    }
+
+    int HeadsUpState::decider() const {
+        return pending >= 0 ? 1 - toMove : toMove;
+    }
+
+    Decision HeadsUpState::decision() const {
+        switch (pending) {
+            case static_cast<int>(CfrAction::Tax): return Decision::BlockTax;
+            case static_cast<int>(CfrAction::Bribe): return Decision::BlockBribe;
+            case static_cast<int>(CfrAction::Arrest): return Decision::BlockArrest;
+            case static_cast<int>(CfrAction::Coup): return Decision::BlockCoup;
+            default: return Decision::Act;
+        }
+    }
+
+    bool HeadsUpState::isTerminal() const {
+        return winner >= 0 || plies >= CfrTrainer::MAX_PLIES;
+    }
+
+    double HeadsUpState::utility(const int seat) const {
+        if (winner >= 0) {
+            return winner == seat ? 1.0 : -1.0;
+        }
+        // Ply limit: score the coin lead, kept below the value of a real win
+        const double lead = (coins[seat] - coins[1 - seat]) / static_cast<double>(Game::FORCE_COUP);
+        return 0.5 * max(-1.0, min(1.0, lead));
+    }
+
+    unsigned HeadsUpState::legalMask() const {
+        if (pending >= 0) {
+            return 0b11; // allow / block
+        }
+        const int self = toMove;
+        const int opp = 1 - self;
+        const int own = coins[self];
+        if (own >= Game::FORCE_COUP) {
+            return 1u << static_cast<int>(CfrAction::Coup);
+        }
+        unsigned mask = 0;
+        if (!sanctioned[self]) {
+            mask |= 1u << static_cast<int>(CfrAction::Gather);
+            if (!taxBlocked) mask |= 1u << static_cast<int>(CfrAction::Tax);
+        }
+        if (own >= Game::BRIBE_COST) mask |= 1u << static_cast<int>(CfrAction::Bribe);
+        const int needed = roles[opp] == Role::General ? 0 : roles[opp] == Role::Merchant ? 2 : 1;
+        if (!arrestBlocked && !hasArrested[self] && coins[opp] >= needed) {
+            mask |= 1u << static_cast<int>(CfrAction::Arrest);
+        }
+        if (own >= Game::SANCTION_COST) mask |= 1u << static_cast<int>(CfrAction::Sanction);
+        if (own >= Game::COUP_COST) mask |= 1u << static_cast<int>(CfrAction::Coup);
+        if (mask == 0) {
+            mask = 1u << static_cast<int>(CfrAction::Skip);
+        }
+        return mask;
+    }
+
+    void HeadsUpState::apply(const int action) {
+        ++plies;
+        const int self = toMove;
+        const int opp = 1 - self;
+
+        // Same effect as Player::playerUsedTurn followed by Game::advanceTurnIfNeeded
+        auto consumeTurn = [&]() {
+            --turnsLeft;
+            sanctioned[self] = false;
+            taxBlocked = false;
+            arrestBlocked = false;
+            if (turnsLeft > 0) return;
+            if (roles[self] == Role::Merchant && coins[self] >= 3) {
+                coins[self] += 1;
+            }
+            toMove = opp;
+            turnsLeft = 1;
+        };
+
+        auto resolve = [&](const CfrAction act) {
+            switch (act) {
+                case CfrAction::Gather:
+                    coins[self] += 1;
+                    consumeTurn();
+                    break;
+                case CfrAction::Tax:
+                    coins[self] += roles[self] == Role::Governor ? 3 : 2;
+                    consumeTurn();
+                    break;
+                case CfrAction::Bribe:
+                    coins[self] -= Game::BRIBE_COST;
+                    turnsLeft += 1;
+                    break;
+                case CfrAction::Arrest:
+                    hasArrested[self] = true;
+                    if (roles[opp] == Role::Merchant) {
+                        coins[opp] -= 2;
+                    } else if (roles[opp] != Role::General) {
+                        coins[opp] -= 1;
+                        coins[self] += 1;
+                    }
+                    consumeTurn();
+                    break;
+                case CfrAction::Sanction:
+                    coins[self] -= Game::SANCTION_COST;
+                    if (roles[opp] == Role::Baron) coins[opp] += 1;
+                    if (roles[opp] == Role::Judge && coins[self] >= 1) coins[self] -= 1;
+                    sanctioned[opp] = true;
+                    consumeTurn();
+                    break;
+                case CfrAction::Coup:
+                    coins[self] -= Game::COUP_COST;
+                    winner = self;
+                    break;
+                case CfrAction::Skip:
+                    consumeTurn();
+                    break;
+            }
+        };
+
+        if (pending >= 0) {
+            const auto act = static_cast<CfrAction>(pending);
+            pending = -1;
+            if (action == 0) {
+                resolve(act);
+                return;
+            }
+            // Blocked: same costs as Game::playerPayAfterBlock, turn not consumed
+            switch (act) {
+                case CfrAction::Tax: taxBlocked = true;
+                    break;
+                case CfrAction::Bribe: coins[self] -= Game::BRIBE_COST;
+                    break;
+                case CfrAction::Arrest: arrestBlocked = true;
+                    break;
+                case CfrAction::Coup:
+                    coins[opp] -= BLOCK_COST_GENERAL;
+                    coins[self] -= Game::COUP_COST;
+                    break;
+                default:
+                    break;
+            }
+            return;
+        }
+
+        const auto act = static_cast<CfrAction>(action);
+        const Role blocker = roles[opp];
+        const bool blockable =
+                (act == CfrAction::Tax && blocker == Role::Governor) ||
+                (act == CfrAction::Bribe && blocker == Role::Judge) ||
+                (act == CfrAction::Arrest && blocker == Role::Spy) ||
+                (act == CfrAction::Coup && blocker == Role::General && coins[opp] >= BLOCK_COST_GENERAL);
+        if (blockable) {
+            pending = action;
+            return;
+        }
+        resolve(act);
+    }
+
+    HeadsUpState HeadsUpState::fromGame(const Game &game) {
+        const auto &players = game.getPlayers();
+        if (players.size() != 2) {
+            throw InitError("CFR policy needs a heads-up game");
+        }
+        HeadsUpState state;
+        state.toMove = game.getTurn();
+        for (int i = 0; i < 2; ++i) {
+            const Player *p = players[i];
+            state.coins[i] = p->getCoins();
+            state.roles[i] = p->getRole();
+            state.sanctioned[i] = !p->isGatherAllow();
+            state.hasArrested[i] = p->getLastArrestedPlayer() != nullptr;
+        }
+        const Player *current = players[state.toMove];
+        state.taxBlocked = current->isGatherAllow() && !current->isTaxAllow();
+        state.arrestBlocked = !current->isArrestAllow();
+        state.turnsLeft = max(1, current->getNumOfTurns());
+        return state;
+    }
+
+    //------------------------------------------------------------------------------
+    // Trainer
+    //------------------------------------------------------------------------------
+
+    /**
+     * @brief Sparse per-worker accumulator for one batch.
+     */
+    struct CfrTrainer::Delta {
+        vector<float> regret;
+        vector<float> strategy;
+        vector<int> touched;     ///< Infosets written this batch
+        vector<char> mark;       ///< 1 if the infoset is in touched
+
+        Delta()
+            : regret(static_cast<size_t>(NUM_INFOSETS) * NUM_ACTIONS, 0.0f),
+              strategy(static_cast<size_t>(NUM_INFOSETS) * NUM_ACTIONS, 0.0f),
+              mark(NUM_INFOSETS, 0) {
+        }
+
+        void touch(const int infoSet) {
+            if (!mark[infoSet]) {
+                mark[infoSet] = 1;
+                touched.push_back(infoSet);
+            }
+        }
+    };
+
+    CfrTrainer::CfrTrainer(const unsigned seed)
+        : regrets(static_cast<size_t>(NUM_INFOSETS) * NUM_ACTIONS, 0.0f),
+          strategySum(static_cast<size_t>(NUM_INFOSETS) * NUM_ACTIONS, 0.0f),
+          seed(seed) {
+    }
+
+    long long CfrTrainer::getIterations() const {
+        return iterations;
+    }
+
+    int CfrTrainer::infoSetIndex(const HeadsUpState &state) {
+        const int self = state.decider();
+        const int opp = 1 - self;
+        unsigned flags = 0;
+        if (state.sanctioned[self]) flags |= 1u;
+        if (state.decision() == Decision::Act) {
+            if (state.taxBlocked) flags |= 2u;
+            if (state.arrestBlocked || state.hasArrested[self]) flags |= 4u;
+            if (state.turnsLeft > 1) flags |= 8u;
+        }
+        int index = static_cast<int>(state.decision());
+        index = index * 6 + roleIndex(state.roles[self]);
+        index = index * 6 + roleIndex(state.roles[opp]);
+        index = index * COIN_BUCKETS + min(max(state.coins[self], 0), COIN_BUCKETS - 1);
+        index = index * OPP_BUCKETS + opponentBucket(state.coins[opp]);
+        index = index * (1 << FLAG_BITS) + static_cast<int>(flags);
+        return index;
+    }
+
+    array<float, CfrTrainer::NUM_ACTIONS> CfrTrainer::currentStrategy(const int infoSet, const unsigned legal) const {
+        array<float, NUM_ACTIONS> strategy{};
+        const float *row = &regrets[static_cast<size_t>(infoSet) * NUM_ACTIONS];
+        float total = 0.0f;
+        int count = 0;
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            strategy[a] = row[a];
+            total += row[a];
+            ++count;
+        }
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            strategy[a] = total > 0.0f ? strategy[a] / total : 1.0f / count;
+        }
+        return strategy;
+    }
+
+    array<float, CfrTrainer::NUM_ACTIONS> CfrTrainer::averageStrategy(const int infoSet, const unsigned legal) const {
+        array<float, NUM_ACTIONS> strategy{};
+        const float *row = &strategySum[static_cast<size_t>(infoSet) * NUM_ACTIONS];
+        float total = 0.0f;
+        int count = 0;
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            total += row[a];
+            ++count;
+        }
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            strategy[a] = total > 0.0f ? row[a] / total : 1.0f / count;
+        }
+        return strategy;
+    }
+
+    double CfrTrainer::traverse(const HeadsUpState state, const int traverser, mt19937 &rng,
+                                Delta &delta, const float weight) const {
+        if (state.isTerminal()) {
+            return state.utility(traverser);
+        }
+        const unsigned legal = state.legalMask();
+        const int infoSet = infoSetIndex(state);
+        const auto strategy = currentStrategy(infoSet, legal);
+        const size_t row = static_cast<size_t>(infoSet) * NUM_ACTIONS;
+
+        if (state.decider() == traverser) {
+            array<double, NUM_ACTIONS> values{};
+            double nodeValue = 0.0;
+            for (int a = 0; a < NUM_ACTIONS; ++a) {
+                if (!isBit(legal, a)) continue;
+                HeadsUpState child = state;
+                child.apply(a);
+                values[a] = traverse(child, traverser, rng, delta, weight);
+                nodeValue += strategy[a] * values[a];
+            }
+            delta.touch(infoSet);
+            for (int a = 0; a < NUM_ACTIONS; ++a) {
+                if (isBit(legal, a)) {
+                    delta.regret[row + a] += static_cast<float>(values[a] - nodeValue);
+                }
+            }
+            return nodeValue;
+        }
+
+        // Opponent node: sample one action and accumulate the average strategy
+        delta.touch(infoSet);
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            delta.strategy[row + a] += weight * strategy[a];
+        }
+        uniform_real_distribution<float> pick(0.0f, 1.0f);
+        float r = pick(rng);
+        int chosen = -1;
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            chosen = a;
+            r -= strategy[a];
+            if (r <= 0.0f) break;
+        }
+        HeadsUpState child = state;
+        child.apply(chosen);
+        return traverse(child, traverser, rng, delta, weight);
+    }
+
+    void CfrTrainer::runBatch(vector<Delta> &deltas, const int count) {
+        const int workers = static_cast<int>(deltas.size());
+        const float weight = static_cast<float>(iterations + 1); // linear averaging (CFR+)
+
+        auto work = [&](const int worker, const int share) {
+            mt19937 rng(seed + static_cast<unsigned>(iterations) * 7919u + static_cast<unsigned>(worker));
+            uniform_int_distribution<int> roleDist(0, 5);
+            uniform_int_distribution<int> coinDist(0, Game::FORCE_COUP - 1);
+            for (int i = 0; i < share; ++i) {
+                // Roots are spread over roles and coin counts because the tree is depth-limited
+                HeadsUpState root;
+                root.roles = {static_cast<Role>(roleDist(rng)), static_cast<Role>(roleDist(rng))};
+                root.coins = {coinDist(rng), coinDist(rng)};
+                root.toMove = static_cast<int>(rng() & 1u);
+                for (int traverser = 0; traverser < 2; ++traverser) {
+                    traverse(root, traverser, rng, deltas[worker], weight);
+                }
+            }
+        };
+
+        auto shareOf = [&](const int worker) {
+            return count / workers + (worker < count % workers ? 1 : 0);
+        };
+        vector<thread> pool;
+        for (int w = 1; w < workers; ++w) {
+            pool.emplace_back(work, w, shareOf(w));
+        }
+        work(0, shareOf(0));
+        for (auto &t: pool) {
+            t.join();
+        }
+
+        // Merge: regret floor at zero is what makes this CFR+
+        for (Delta &d: deltas) {
+            for (const int infoSet: d.touched) {
+                const size_t row = static_cast<size_t>(infoSet) * NUM_ACTIONS;
+                for (int a = 0; a < NUM_ACTIONS; ++a) {
+                    regrets[row + a] = max(0.0f, regrets[row + a] + d.regret[row + a]);
+                    strategySum[row + a] += d.strategy[row + a];
+                    d.regret[row + a] = 0.0f;
+                    d.strategy[row + a] = 0.0f;
+                }
+                d.mark[infoSet] = 0;
+            }
+            d.touched.clear();
+        }
+        iterations += count;
+    }
+
+    void CfrTrainer::train(const int iterationsToRun, const int threads, const int checkpointEvery,
+                           const string &checkpointPath) {
+        vector<Delta> deltas(static_cast<size_t>(max(1, threads)));
+        const int batchSize = static_cast<int>(deltas.size()) * ITERATIONS_PER_WORKER;
+        long long nextCheckpoint = checkpointEvery > 0 ? iterations + checkpointEvery : -1;
+
+        int remaining = iterationsToRun;
+        while (remaining > 0) {
+            int count = min(remaining, batchSize);
+            if (nextCheckpoint > 0) {
+                count = static_cast<int>(min<long long>(count, nextCheckpoint - iterations));
+            }
+            runBatch(deltas, count);
+            remaining -= count;
+            if (nextCheckpoint > 0 && iterations >= nextCheckpoint) {
+                saveCheckpoint(checkpointPath);
+                nextCheckpoint += checkpointEvery;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Persistence
+    //------------------------------------------------------------------------------
+
+    void CfrTrainer::saveCheckpoint(const string &path) const {
+        const string tmp = path + ".tmp";
+        {
+            ofstream out(tmp, ios::binary | ios::trunc);
+            if (!out) {
+                throw runtime_error("Cannot write checkpoint: " + path);
+            }
+            const uint64_t count = regrets.size();
+            out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+            out.write(reinterpret_cast<const char *>(&iterations), sizeof(iterations));
+            out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            out.write(reinterpret_cast<const char *>(regrets.data()), count * sizeof(float));
+            out.write(reinterpret_cast<const char *>(strategySum.data()), count * sizeof(float));
+            if (!out) {
+                throw runtime_error("Failed writing checkpoint: " + path);
+            }
+        }
+        // Replace atomically so a crash never leaves a half-written checkpoint
+        if (rename(tmp.c_str(), path.c_str()) != 0) {
+            throw runtime_error("Cannot replace checkpoint: " + path);
+        }
+    }
+
+    void CfrTrainer::loadCheckpoint(const string &path) {
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open checkpoint: " + path);
+        }
+        char magic[sizeof(CHECKPOINT_MAGIC)];
+        long long savedIterations = 0;
+        uint64_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char *>(&savedIterations), sizeof(savedIterations));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || count != regrets.size()) {
+            throw runtime_error("Checkpoint does not match this abstraction: " + path);
+        }
+        in.read(reinterpret_cast<char *>(regrets.data()), count * sizeof(float));
+        in.read(reinterpret_cast<char *>(strategySum.data()), count * sizeof(float));
+        if (!in) {
+            throw runtime_error("Truncated checkpoint: " + path);
+        }
+        iterations = savedIterations;
+    }
+
+    void CfrTrainer::writePolicy(const string &path) const {
+        ofstream out(path, ios::trunc);
+        if (!out) {
+            throw runtime_error("Cannot write policy: " + path);
+        }
+        out << "coup-cfr-policy 1 " << NUM_INFOSETS << ' ' << NUM_ACTIONS << '\n';
+        for (int infoSet = 0; infoSet < NUM_INFOSETS; ++infoSet) {
+            const float *row = &strategySum[static_cast<size_t>(infoSet) * NUM_ACTIONS];
+            float total = 0.0f;
+            for (int a = 0; a < NUM_ACTIONS; ++a) total += row[a];
+            if (total <= 0.0f) continue;
+            out << infoSet;
+            for (int a = 0; a < NUM_ACTIONS; ++a) {
+                out << ' ' << row[a] / total;
+            }
+            out << '\n';
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Policy table
+    //------------------------------------------------------------------------------
+
+    PolicyTable::PolicyTable(const string &path)
+        : probs(static_cast<size_t>(CfrTrainer::NUM_INFOSETS) * CfrTrainer::NUM_ACTIONS, 0.0f),
+          present(CfrTrainer::NUM_INFOSETS, false) {
+        ifstream in(path);
+        if (!in) {
+            throw runtime_error("Cannot open policy: " + path);
+        }
+        string tag;
+        int version = 0, infoSets = 0, actions = 0;
+        in >> tag >> version >> infoSets >> actions;
+        if (tag != "coup-cfr-policy" || version != 1 ||
+            infoSets != CfrTrainer::NUM_INFOSETS || actions != CfrTrainer::NUM_ACTIONS) {
+            throw runtime_error("Policy does not match this abstraction: " + path);
+        }
+        int infoSet = 0;
+        while (in >> infoSet) {
+            if (infoSet < 0 || infoSet >= CfrTrainer::NUM_INFOSETS) {
+                throw runtime_error("Bad infoset in policy: " + path);
+            }
+            for (int a = 0; a < CfrTrainer::NUM_ACTIONS; ++a) {
+                in >> probs[static_cast<size_t>(infoSet) * CfrTrainer::NUM_ACTIONS + a];
+            }
+            present[infoSet] = true;
+        }
+    }
+
+    array<float, CfrTrainer::NUM_ACTIONS> PolicyTable::distribution(const HeadsUpState &state) const {
+        const unsigned legal = state.legalMask();
+        const int infoSet = CfrTrainer::infoSetIndex(state);
+        array<float, CfrTrainer::NUM_ACTIONS> out{};
+        float total = 0.0f;
+        int count = 0;
+        for (int a = 0; a < CfrTrainer::NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            out[a] = present[infoSet] ? probs[static_cast<size_t>(infoSet) * CfrTrainer::NUM_ACTIONS + a] : 0.0f;
+            total += out[a];
+            ++count;
+        }
+        for (int a = 0; a < CfrTrainer::NUM_ACTIONS; ++a) {
+            if (!isBit(legal, a)) continue;
+            out[a] = total > 0.0f ? out[a] / total : 1.0f / count;
+        }
+        return out;
+    }
+
+    int PolicyTable::bestAction(const HeadsUpState &state) const {
+        const auto dist = distribution(state);
+        return static_cast<int>(max_element(dist.begin(), dist.end()) - dist.begin());
+    }
+} // namespace coup
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @brief Kind of decision a player faces in the heads-up abstraction.
+     *
+     * Block decisions mirror the prompts in GamePanel::AskBlock that end in
+     * Game::playerPayAfterBlock.
+     */
+    enum class Decision {
+        Act,         ///< Choose the next action of the turn
+        BlockTax,    ///< Governor decides whether to block tax
+        BlockBribe,  ///< Judge decides whether to block bribe
+        BlockArrest, ///< Spy decides whether to block arrest
+        BlockCoup    ///< General decides whether to block coup
+    };
+
+    /**
+     * @brief Abstract actions for the Act decision.
+     * Block decisions use 0 = allow and 1 = block.
+     */
+    enum class CfrAction {
+        Gather,
+        Tax,
+        Bribe,
+        Arrest,
+        Sanction,
+        Coup,
+        Skip ///< Only legal when nothing else is
+    };
+
+    /**
+     * @struct HeadsUpState
+     * @brief Compact two-player state used by the CFR trainer.
+     *
+     * Follows the same costs and role rules as Game/Player, with coins capped
+     * for the abstraction and a ply limit that ends long games on coin lead.
+     */
+    struct HeadsUpState {
+        std::array<int, 2> coins{0, 0};                  ///< Coin balance per seat
+        std::array<Role, 2> roles{Role::Governor, Role::Spy}; ///< Role per seat
+        std::array<bool, 2> sanctioned{false, false};    ///< Gather/tax disabled by sanction
+        std::array<bool, 2> hasArrested{false, false};   ///< Seat already arrested its opponent
+        bool taxBlocked = false;    ///< Current actor had tax blocked this turn
+        bool arrestBlocked = false; ///< Current actor had arrest blocked this turn
+        int toMove = 0;             ///< Seat whose turn it is
+        int turnsLeft = 1;          ///< Actions remaining in the current turn
+        int pending = -1;           ///< Action waiting on a block decision, -1 if none
+        int plies = 0;              ///< Decisions played so far
+        int winner = -1;            ///< Winning seat, -1 while running
+
+        /** @return Seat that must decide at this state. */
+        int decider() const;
+
+        /** @return Decision kind at this state. */
+        Decision decision() const;
+
+        /** @return True if the game ended or hit the ply limit. */
+        bool isTerminal() const;
+
+        /**
+         * @brief Payoff for a seat at a terminal state, in [-1, 1].
+         * @param seat Seat to score
+         */
+        double utility(int seat) const;
+
+        /** @return Bit mask of legal action indices at this state. */
+        unsigned legalMask() const;
+
+        /**
+         * @brief Apply an action index to the state.
+         * @param action Act index (CfrAction) or block choice (0/1)
+         */
+        void apply(int action);
+
+        /**
+         * @brief Build the abstract state from a live two-player game.
+         * @param game Game with exactly two players
+         * @throws InitError if the game is not heads-up
+         */
+        static HeadsUpState fromGame(const Game& game);
+    };
+
+    /**
+     * @class CfrTrainer
+     * @brief External-sampling Monte Carlo CFR+ for the heads-up abstraction.
+     *
+     * Regrets and average strategy sums live in flat float tables indexed by
+     * infoSet * NUM_ACTIONS + action. Worker threads traverse against a frozen
+     * regret table and return sparse deltas that are merged after each batch.
+     */
+    class CfrTrainer {
+    public:
+        static constexpr int NUM_ACTIONS = 7;   ///< Widest action set (Act)
+        static constexpr int COIN_BUCKETS = 13; ///< Own coins 0..12
+        static constexpr int OPP_BUCKETS = 4;   ///< Opponent coins bucketed
+        static constexpr int FLAG_BITS = 4;     ///< Per-decision state flags
+        static constexpr int MAX_PLIES = 12;    ///< Ply limit of the abstraction
+        static constexpr int NUM_INFOSETS = 5 * 6 * 6 * COIN_BUCKETS * OPP_BUCKETS * (1 << FLAG_BITS);
+
+        /**
+         * @brief Create a trainer with zeroed tables.
+         * @param seed Seed for the sampling RNG of each worker
+         */
+        explicit CfrTrainer(unsigned seed = 1);
+
+        /**
+         * @brief Run CFR+ iterations, optionally in parallel and with checkpoints.
+         * @param iterations Number of iterations (one traversal per seat each)
+         * @param threads Worker threads per batch
+         * @param checkpointEvery Save a checkpoint every N iterations, 0 to disable
+         * @param checkpointPath File used for periodic checkpoints
+         */
+        void train(int iterations, int threads = 1, int checkpointEvery = 0,
+                   const std::string& checkpointPath = "");
+
+        /** @return Iterations completed so far. */
+        long long getIterations() const;
+
+        /**
+         * @brief Flat infoset index of the decider at a state.
+         * @param state Non-terminal state
+         */
+        static int infoSetIndex(const HeadsUpState& state);
+
+        /**
+         * @brief Current regret-matching strategy at an infoset.
+         * @param infoSet Infoset index
+         * @param legal Bit mask of legal actions
+         */
+        std::array<float, NUM_ACTIONS> currentStrategy(int infoSet, unsigned legal) const;
+
+        /**
+         * @brief Normalized average strategy at an infoset (the equilibrium estimate).
+         * @param infoSet Infoset index
+         * @param legal Bit mask of legal actions
+         */
+        std::array<float, NUM_ACTIONS> averageStrategy(int infoSet, unsigned legal) const;
+
+        /**
+         * @brief Write regrets, strategy sums and iteration count.
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void saveCheckpoint(const std::string& path) const;
+
+        /**
+         * @brief Resume from a checkpoint written by saveCheckpoint.
+         * @throws std::runtime_error if the file is missing or malformed
+         */
+        void loadCheckpoint(const std::string& path);
+
+        /**
+         * @brief Export the average strategy as a policy table for bots.
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void writePolicy(const std::string& path) const;
+
+    private:
+        struct Delta;
+
+        std::vector<float> regrets;     ///< Cumulative positive regrets (CFR+)
+        std::vector<float> strategySum; ///< Weighted average strategy sums
+        long long iterations = 0;       ///< Iterations completed
+        unsigned seed;                  ///< Base seed for worker RNGs
+
+        double traverse(HeadsUpState state, int traverser, std::mt19937& rng,
+                        Delta& delta, float weight) const;
+
+        void runBatch(std::vector<Delta>& deltas, int count);
+    };
+
+    /**
+     * @class PolicyTable
+     * @brief Read-only policy exported by CfrTrainer::writePolicy.
+     *
+     * Infosets missing from the file fall back to a uniform legal strategy.
+     */
+    class PolicyTable {
+    public:
+        /**
+         * @brief Load a policy file.
+         * @throws std::runtime_error if the file is missing or malformed
+         */
+        explicit PolicyTable(const std::string& path);
+
+        /**
+         * @brief Action probabilities at a state, restricted to legal actions.
+         * @param state Non-terminal state
+         */
+        std::array<float, CfrTrainer::NUM_ACTIONS> distribution(const HeadsUpState& state) const;
+
+        /**
+         * @brief Most probable legal action at a state.
+         * @param state Non-terminal state
+         */
+        int bestAction(const HeadsUpState& state) const;
+
+    private:
+        std::vector<float> probs;   ///< Flat probabilities, NaN-free, 0 for unknown
+        std::vector<bool> present;  ///< True if the infoset appears in the file
+    };
+} // namespace coup
@@ -0,0 +1,162 @@
+#include "DecisionService.hpp"
+#include <utility>
+#include "ActionSpace.hpp"
+#include "Mlp.hpp"
+#include "Observation.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        int lowestBit(const uint32_t mask) {
+            for (int i = 0; i < 32; ++i) {
+                if ((mask >> i) & 1u) return i;
+            }
+            return -1;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Policies
+    //------------------------------------------------------------------------------
+
+    void heuristicBatchPolicy(const vector<DecisionRequest> &requests, vector<int> &answers) {
+        const uint32_t coupBits = ((1u << actions::MAX_OFFSET) - 1) << actions::COUP;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            const uint32_t legal = requests[i].legal;
+            if (requests[i].kind == DecisionKind::Block) {
+                answers[i] = (legal & TurnPipeline::BLOCK) ? 1 : 0;
+            } else if (legal & coupBits) {
+                answers[i] = lowestBit(legal & coupBits);
+            } else if ((legal >> actions::TAX) & 1u) {
+                answers[i] = actions::TAX;
+            } else if ((legal >> actions::GATHER) & 1u) {
+                answers[i] = actions::GATHER;
+            } else {
+                answers[i] = lowestBit(legal);
+            }
+        }
+    }
+
+    BatchPolicy mlpBatchPolicy(const Mlp &net) {
+        if (net.inputSize() != obs::SIZE || net.policySize() != actions::COUNT) {
+            throw InitError("Network does not match the observation and action space");
+        }
+        vector<float> inputs;
+        vector<float> logits;
+        vector<size_t> rows;
+        return [&net, inputs, logits, rows](const vector<DecisionRequest> &requests,
+                                            vector<int> &answers) mutable {
+            heuristicBatchPolicy(requests, answers); // block prompts keep the heuristic answer
+            rows.clear();
+            for (size_t i = 0; i < requests.size(); ++i) {
+                if (requests[i].kind == DecisionKind::Turn) rows.push_back(i);
+            }
+            if (rows.empty()) return;
+            inputs.resize(rows.size() * obs::SIZE);
+            logits.resize(rows.size() * actions::COUNT);
+            for (size_t r = 0; r < rows.size(); ++r) {
+                const DecisionRequest &req = requests[rows[r]];
+                encodeObservation(*req.state, req.player, &inputs[r * obs::SIZE]);
+            }
+            net.evaluate(inputs.data(), rows.size(), logits.data(), nullptr);
+            for (size_t r = 0; r < rows.size(); ++r) {
+                const uint32_t legal = requests[rows[r]].legal;
+                const float *row = &logits[r * actions::COUNT];
+                int best = -1;
+                for (int a = 0; a < actions::COUNT; ++a) {
+                    if (((legal >> a) & 1u) && (best < 0 || row[a] > row[best])) best = a;
+                }
+                if (best >= 0) answers[rows[r]] = best;
+            }
+        };
+    }
+
+    //------------------------------------------------------------------------------
+    // Service
+    //------------------------------------------------------------------------------
+
+    DecisionService::DecisionService(BatchPolicy policy, const size_t maxBatch)
+        : policy(move(policy)), maxBatch(maxBatch) {
+        if (maxBatch == 0 || !this->policy) {
+            throw InitError("DecisionService needs a policy and a positive batch size");
+        }
+    }
+
+    size_t DecisionService::addGame(const Game &game, const int maxDecisions) {
+        return scheduler.spawn(game, maxDecisions);
+    }
+
+    size_t DecisionService::flush() {
+        const size_t count = queue.size();
+        if (count == 0) return 0;
+        answers.assign(count, -1);
+        policy(queue, answers);
+        ++batches;
+        for (size_t i = 0; i < count; ++i) {
+            scheduler.resume(queue[i].game, answers[i]);
+        }
+        answered += count;
+        queue.clear();
+        return count;
+    }
+
+    size_t DecisionService::step() {
+        size_t served = 0;
+        queue.clear();
+        for (const size_t task: scheduler.ready()) {
+            const TurnPipeline &pipeline = scheduler.pipeline(task);
+            DecisionRequest req;
+            req.game = task;
+            req.kind = pipeline.awaiting() == Await::Block ? DecisionKind::Block : DecisionKind::Turn;
+            req.state = &pipeline.game();
+            req.player = pipeline.decider();
+            req.challenged = pipeline.challenged();
+            req.legal = pipeline.legal();
+            queue.push_back(req);
+            if (queue.size() == maxBatch) served += flush();
+        }
+        return served + flush();
+    }
+
+    size_t DecisionService::run() {
+        const size_t before = batches;
+        while (step() > 0) {
+        }
+        return batches - before;
+    }
+
+    //------------------------------------------------------------------------------
+    // Queries
+    //------------------------------------------------------------------------------
+
+    size_t DecisionService::size() const {
+        return scheduler.size();
+    }
+
+    bool DecisionService::finished(const size_t game) const {
+        return scheduler.finished(game);
+    }
+
+    const Game &DecisionService::game(const size_t game) const {
+        return scheduler.game(game);
+    }
+
+    const Player *DecisionService::winner(const size_t game) const {
+        const Game &g = scheduler.game(game);
+        return g.getPlayers().size() == 1 ? g.getPlayers()[0] : nullptr;
+    }
+
+    int DecisionService::decisions(const size_t game) const {
+        return scheduler.decisions(game);
+    }
+
+    size_t DecisionService::batchesEvaluated() const {
+        return batches;
+    }
+
+    size_t DecisionService::requestsAnswered() const {
+        return answered;
+    }
+} // namespace coup
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../Game.hpp"
+#include "../sim/TurnPipeline.hpp"
+
+namespace coup {
+    class Mlp;
+
+    /**
+     * @brief Kind of decision a suspended game is waiting for.
+     */
+    enum class DecisionKind {
+        Turn, ///< The current player picks a flat action index (ActionSpace.hpp)
+        Block ///< A role holder answers a block prompt: 0 = allow, 1 = block
+    };
+
+    /**
+     * @struct DecisionRequest
+     * @brief One question queued by a suspended game.
+     */
+    struct DecisionRequest {
+        size_t game = 0;                          ///< Game slot in the service
+        DecisionKind kind = DecisionKind::Turn;   ///< What is being asked
+        const Game* state = nullptr;              ///< Game as it stands (read-only)
+        const Player* player = nullptr;           ///< Who decides
+        ActionType challenged = ActionType::Skip; ///< Block only: the action that may be blocked
+        uint32_t legal = 0;                       ///< Legal answers as a bit mask
+    };
+
+    /**
+     * @brief Answers a whole batch at once; answers[i] belongs to requests[i].
+     */
+    using BatchPolicy = std::function<void(const std::vector<DecisionRequest>& requests,
+                                           std::vector<int>& answers)>;
+
+    /**
+     * @brief Rule-of-thumb policy: coup when possible, else tax, else gather; block whenever allowed.
+     */
+    void heuristicBatchPolicy(const std::vector<DecisionRequest>& requests, std::vector<int>& answers);
+
+    /**
+     * @brief Policy that evaluates every turn request of a batch in one Mlp call.
+     *
+     * Block prompts fall back to heuristicBatchPolicy. The network must outlive the policy.
+     * @param net Network with obs::SIZE inputs and actions::COUNT logits
+     * @throws InitError if the network does not match
+     */
+    BatchPolicy mlpBatchPolicy(const Mlp& net);
+
+    /**
+     * @class DecisionService
+     * @brief Runs many games that suspend at decision points and resumes them in batches.
+     *
+     * Every game is a PipelineScheduler task that suspends where its current
+     * player must choose an action or a role holder must answer a block prompt
+     * (the questions GamePanel::AskBlock asks). step() queues one DecisionRequest
+     * per suspended game, hands them to the policy in batches of up to maxBatch
+     * and resumes every game with its answer.
+     */
+    class DecisionService {
+    public:
+        static constexpr int DEFAULT_MAX_DECISIONS = 2000; ///< Per-game cap against endless games
+
+        /**
+         * @param policy Batch policy answering every request
+         * @param maxBatch Largest batch handed to the policy
+         * @throws InitError if maxBatch is 0 or the policy is empty
+         */
+        explicit DecisionService(BatchPolicy policy, size_t maxBatch = 4096);
+
+        DecisionService(const DecisionService&) = delete;
+        DecisionService& operator=(const DecisionService&) = delete;
+
+        /**
+         * @brief Add a game (copied) to be played out.
+         * @param game Game with at least two players
+         * @param maxDecisions Decisions after which the game is stopped without a winner
+         * @return Game slot
+         * @throws InitError if the game has fewer than two players
+         */
+        size_t addGame(const Game& game, int maxDecisions = DEFAULT_MAX_DECISIONS);
+
+        /**
+         * @brief Collect, evaluate and resume until every game is over.
+         * @return Number of policy batches evaluated
+         * @throws ActionError if the policy answers with an illegal choice
+         */
+        size_t run();
+
+        /**
+         * @brief One round: queue the pending decision of every running game and answer them.
+         * @return Number of requests answered (0 once all games are over)
+         */
+        size_t step();
+
+        size_t size() const;
+        bool finished(size_t game) const;
+        const Game& game(size_t game) const;
+
+        /** @return Winner of a finished game, nullptr if it was stopped or is running. */
+        const Player* winner(size_t game) const;
+
+        /** @return Decisions taken in a game so far. */
+        int decisions(size_t game) const;
+
+        size_t batchesEvaluated() const;
+        size_t requestsAnswered() const;
+
+    private:
+        BatchPolicy policy;
+        size_t maxBatch;
+        PipelineScheduler scheduler;
+        std::vector<DecisionRequest> queue;
+        std::vector<int> answers;
+        size_t batches = 0;
+        size_t answered = 0;
+
+        size_t flush();
+    };
+} // namespace coup
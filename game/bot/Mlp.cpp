@@ -0,0 +1,383 @@
+#include "Mlp.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include "ActionSpace.hpp"
+#include "Observation.hpp"
+#include "../GameExceptions.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define COUP_MLP_AVX2 1
+#endif
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr char WEIGHTS_MAGIC[4] = {'M', 'L', 'P', '1'};
+        constexpr int PAD = 16;        ///< Row padding: two AVX float registers / one int8x16 load
+        constexpr int ROW_BLOCK = 4;   ///< Batch rows sharing one pass over a weight row
+
+        int padded(const int n) {
+            return (n + PAD - 1) / PAD * PAD;
+        }
+
+        //--------------------------------------------------------------------------
+        // Kernels
+        //--------------------------------------------------------------------------
+
+#ifdef COUP_MLP_AVX2
+        float horizontalSum(const __m256 v) {
+            const __m128 lo = _mm256_castps256_ps128(v);
+            const __m128 hi = _mm256_extractf128_ps(v, 1);
+            __m128 s = _mm_add_ps(lo, hi);
+            s = _mm_hadd_ps(s, s);
+            s = _mm_hadd_ps(s, s);
+            return _mm_cvtss_f32(s);
+        }
+
+        int32_t horizontalSum(const __m256i v) {
+            const __m128i lo = _mm256_castsi256_si128(v);
+            const __m128i hi = _mm256_extracti128_si256(v, 1);
+            __m128i s = _mm_add_epi32(lo, hi);
+            s = _mm_hadd_epi32(s, s);
+            s = _mm_hadd_epi32(s, s);
+            return _mm_cvtsi128_si32(s);
+        }
+#endif
+
+        /**
+         * @brief Dot products of ROW_BLOCK input rows against one weight row.
+         */
+        void dotBlock(const float *w, const float *x, const int xStride, const int n, float *result) {
+#ifdef COUP_MLP_AVX2
+            __m256 acc[ROW_BLOCK];
+            for (auto &a: acc) a = _mm256_setzero_ps();
+            for (int i = 0; i < n; i += 8) {
+                const __m256 wv = _mm256_loadu_ps(w + i);
+                for (int r = 0; r < ROW_BLOCK; ++r) {
+                    acc[r] = _mm256_fmadd_ps(_mm256_loadu_ps(x + r * xStride + i), wv, acc[r]);
+                }
+            }
+            for (int r = 0; r < ROW_BLOCK; ++r) result[r] = horizontalSum(acc[r]);
+#else
+            for (int r = 0; r < ROW_BLOCK; ++r) {
+                const float *row = x + r * xStride;
+                float sum = 0.0f;
+                for (int i = 0; i < n; ++i) sum += w[i] * row[i];
+                result[r] = sum;
+            }
+#endif
+        }
+
+        float dot(const float *w, const float *x, const int n) {
+#ifdef COUP_MLP_AVX2
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            for (int i = 0; i < n; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(w + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(w + i + 8), acc1);
+            }
+            return horizontalSum(_mm256_add_ps(acc0, acc1));
+#else
+            float sum = 0.0f;
+            for (int i = 0; i < n; ++i) sum += w[i] * x[i];
+            return sum;
+#endif
+        }
+
+        int32_t dot(const int8_t *w, const int8_t *x, const int n) {
+#ifdef COUP_MLP_AVX2
+            __m256i acc = _mm256_setzero_si256();
+            for (int i = 0; i < n; i += 16) {
+                const __m256i xv = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+                const __m256i wv = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i)));
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(xv, wv));
+            }
+            return horizontalSum(acc);
+#else
+            int32_t sum = 0;
+            for (int i = 0; i < n; ++i) sum += static_cast<int32_t>(w[i]) * x[i];
+            return sum;
+#endif
+        }
+
+        /**
+         * @brief Symmetric int8 quantization of n values; returns the dequantization factor.
+         */
+        float quantizeRow(const float *src, const int n, int8_t *dst) {
+            float maxAbs = 0.0f;
+            for (int i = 0; i < n; ++i) maxAbs = max(maxAbs, fabs(src[i]));
+            const float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+            const float inverse = 1.0f / scale;
+            for (int i = 0; i < n; ++i) {
+                dst[i] = static_cast<int8_t>(lrintf(src[i] * inverse));
+            }
+            return scale;
+        }
+
+        /**
+         * @brief Per-thread activation buffers reused across calls.
+         */
+        struct Scratch {
+            vector<float> a;
+            vector<float> b;
+            vector<int8_t> q;
+            vector<float> qScale;
+        };
+
+        Scratch &scratch() {
+            thread_local Scratch s;
+            return s;
+        }
+
+        template<typename T>
+        void writeValue(ofstream &out, const T &value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        T readValue(ifstream &in) {
+            T value{};
+            in.read(reinterpret_cast<char *>(&value), sizeof(T));
+            return value;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Construction and persistence
+    //------------------------------------------------------------------------------
+
+    Mlp::Layer Mlp::makeLayer(const int in, const int out) {
+        if (in <= 0 || out <= 0) {
+            throw InitError("MLP layers need positive sizes");
+        }
+        Layer layer;
+        layer.in = in;
+        layer.out = out;
+        layer.stride = padded(in);
+        layer.weights.assign(static_cast<size_t>(out) * layer.stride, 0.0f);
+        layer.bias.assign(out, 0.0f);
+        return layer;
+    }
+
+    Mlp::Mlp(const int inputSize, const vector<int> &hidden, const int policySize, const uint32_t seed)
+        : input(inputSize) {
+        mt19937 rng(seed);
+        auto init = [&](Layer &layer) {
+            normal_distribution<float> dist(0.0f, sqrt(2.0f / layer.in));
+            for (int o = 0; o < layer.out; ++o) {
+                for (int i = 0; i < layer.in; ++i) {
+                    layer.weights[static_cast<size_t>(o) * layer.stride + i] = dist(rng);
+                }
+            }
+        };
+        int width = inputSize;
+        for (const int h: hidden) {
+            trunk.push_back(makeLayer(width, h));
+            init(trunk.back());
+            width = h;
+        }
+        policyHead = makeLayer(width, policySize);
+        valueHead = makeLayer(width, 1);
+        init(policyHead);
+        init(valueHead);
+    }
+
+    Mlp Mlp::load(const string &path) {
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open weights: " + path);
+        }
+        char magic[sizeof(WEIGHTS_MAGIC)];
+        in.read(magic, sizeof(magic));
+        const auto inputSize = readValue<uint32_t>(in);
+        const auto trunkCount = readValue<uint32_t>(in);
+        if (!in || memcmp(magic, WEIGHTS_MAGIC, sizeof(magic)) != 0 || inputSize == 0 || trunkCount > 64) {
+            throw runtime_error("Not an MLP weight file: " + path);
+        }
+
+        Mlp net;
+        net.input = static_cast<int>(inputSize);
+        int width = net.input;
+        auto readLayer = [&](const bool lastIsValue) {
+            const auto inSize = readValue<uint32_t>(in);
+            const auto out = readValue<uint32_t>(in);
+            if (!in || static_cast<int>(inSize) != width || out == 0 || out > (1u << 16) || (lastIsValue && out != 1)) {
+                throw runtime_error("Inconsistent layer shapes in weights: " + path);
+            }
+            Layer layer = makeLayer(static_cast<int>(inSize), static_cast<int>(out));
+            for (uint32_t o = 0; o < out; ++o) {
+                in.read(reinterpret_cast<char *>(&layer.weights[static_cast<size_t>(o) * layer.stride]),
+                        static_cast<streamsize>(inSize * sizeof(float)));
+            }
+            in.read(reinterpret_cast<char *>(layer.bias.data()), static_cast<streamsize>(out * sizeof(float)));
+            if (!in) {
+                throw runtime_error("Truncated weights: " + path);
+            }
+            return layer;
+        };
+        for (uint32_t l = 0; l < trunkCount; ++l) {
+            net.trunk.push_back(readLayer(false));
+            width = net.trunk.back().out;
+        }
+        net.policyHead = readLayer(false);
+        net.valueHead = readLayer(true);
+        return net;
+    }
+
+    void Mlp::save(const string &path) const {
+        const string tmp = path + ".tmp";
+        {
+            ofstream out(tmp, ios::binary | ios::trunc);
+            if (!out) {
+                throw runtime_error("Cannot write weights: " + path);
+            }
+            out.write(WEIGHTS_MAGIC, sizeof(WEIGHTS_MAGIC));
+            writeValue(out, static_cast<uint32_t>(input));
+            writeValue(out, static_cast<uint32_t>(trunk.size()));
+            auto writeLayer = [&](const Layer &layer) {
+                writeValue(out, static_cast<uint32_t>(layer.in));
+                writeValue(out, static_cast<uint32_t>(layer.out));
+                for (int o = 0; o < layer.out; ++o) {
+                    out.write(reinterpret_cast<const char *>(&layer.weights[static_cast<size_t>(o) * layer.stride]),
+                              static_cast<streamsize>(layer.in * sizeof(float)));
+                }
+                out.write(reinterpret_cast<const char *>(layer.bias.data()),
+                          static_cast<streamsize>(layer.out * sizeof(float)));
+            };
+            for (const Layer &layer: trunk) writeLayer(layer);
+            writeLayer(policyHead);
+            writeLayer(valueHead);
+            if (!out) {
+                throw runtime_error("Failed writing weights: " + path);
+            }
+        }
+        if (rename(tmp.c_str(), path.c_str()) != 0) {
+            throw runtime_error("Cannot replace weights: " + path);
+        }
+    }
+
+    int Mlp::inputSize() const {
+        return input;
+    }
+
+    int Mlp::policySize() const {
+        return policyHead.out;
+    }
+
+    //------------------------------------------------------------------------------
+    // Precision
+    //------------------------------------------------------------------------------
+
+    void Mlp::quantize(Layer &layer) {
+        if (!layer.qWeights.empty()) return;
+        layer.qWeights.assign(layer.weights.size(), 0);
+        layer.qScale.assign(layer.out, 1.0f);
+        for (int o = 0; o < layer.out; ++o) {
+            const size_t row = static_cast<size_t>(o) * layer.stride;
+            layer.qScale[o] = quantizeRow(&layer.weights[row], layer.in, &layer.qWeights[row]);
+        }
+    }
+
+    void Mlp::setPrecision(const Precision value) {
+        if (value == Precision::Int8) {
+            for (Layer &layer: trunk) quantize(layer);
+            quantize(policyHead);
+            quantize(valueHead);
+        }
+        precision = value;
+    }
+
+    Mlp::Precision Mlp::getPrecision() const {
+        return precision;
+    }
+
+    //------------------------------------------------------------------------------
+    // Evaluation
+    //------------------------------------------------------------------------------
+
+    void Mlp::forward(const Layer &layer, const float *in, const size_t batch, float *out, const int outStride,
+                      const bool relu) const {
+        if (precision == Precision::Int8) {
+            Scratch &s = scratch();
+            s.q.assign(batch * layer.stride, 0);
+            s.qScale.resize(batch);
+            for (size_t r = 0; r < batch; ++r) {
+                s.qScale[r] = quantizeRow(in + r * layer.stride, layer.in, &s.q[r * layer.stride]);
+            }
+            for (size_t r = 0; r < batch; ++r) {
+                const int8_t *x = &s.q[r * layer.stride];
+                for (int o = 0; o < layer.out; ++o) {
+                    const int32_t acc = dot(&layer.qWeights[static_cast<size_t>(o) * layer.stride], x, layer.stride);
+                    const float v = layer.bias[o] + static_cast<float>(acc) * layer.qScale[o] * s.qScale[r];
+                    out[r * outStride + o] = relu ? max(v, 0.0f) : v;
+                }
+            }
+            return;
+        }
+
+        size_t r = 0;
+        float block[ROW_BLOCK];
+        for (; r + ROW_BLOCK <= batch; r += ROW_BLOCK) {
+            const float *x = in + r * layer.stride;
+            for (int o = 0; o < layer.out; ++o) {
+                dotBlock(&layer.weights[static_cast<size_t>(o) * layer.stride], x, layer.stride, layer.stride, block);
+                for (int k = 0; k < ROW_BLOCK; ++k) {
+                    const float v = block[k] + layer.bias[o];
+                    out[(r + k) * outStride + o] = relu ? max(v, 0.0f) : v;
+                }
+            }
+        }
+        for (; r < batch; ++r) {
+            const float *x = in + r * layer.stride;
+            for (int o = 0; o < layer.out; ++o) {
+                const float v = dot(&layer.weights[static_cast<size_t>(o) * layer.stride], x, layer.stride)
+                                + layer.bias[o];
+                out[r * outStride + o] = relu ? max(v, 0.0f) : v;
+            }
+        }
+    }
+
+    void Mlp::evaluate(const float *obs, const size_t batch, float *policy, float *value) const {
+        if (batch == 0) return;
+        Scratch &s = scratch();
+        const int stride = padded(input);
+        s.a.assign(batch * stride, 0.0f);
+        for (size_t r = 0; r < batch; ++r) {
+            copy(obs + r * input, obs + (r + 1) * input, &s.a[r * stride]);
+        }
+        for (const Layer &layer: trunk) {
+            const int next = padded(layer.out);
+            s.b.assign(batch * next, 0.0f);
+            forward(layer, s.a.data(), batch, s.b.data(), next, true);
+            swap(s.a, s.b);
+        }
+        forward(policyHead, s.a.data(), batch, policy, policyHead.out, false);
+        if (value) {
+            forward(valueHead, s.a.data(), batch, value, 1, false);
+            for (size_t r = 0; r < batch; ++r) value[r] = tanh(value[r]);
+        }
+    }
+
+    int Mlp::bestLegalAction(const Game &game) const {
+        if (input != obs::SIZE || policyHead.out != actions::COUNT) {
+            throw InitError("Network does not match the observation and action space");
+        }
+        float observation[obs::SIZE];
+        float logits[actions::COUNT];
+        encodeObservation(game, game.getPlayers()[game.getTurn()], observation);
+        evaluate(observation, 1, logits, nullptr);
+
+        const uint32_t legal = legalActionMask(game);
+        int best = -1;
+        for (int a = 0; a < actions::COUNT; ++a) {
+            if (((legal >> a) & 1u) && (best < 0 || logits[a] > logits[best])) best = a;
+        }
+        return best < 0 ? actions::SKIP : best;
+    }
+} // namespace coup
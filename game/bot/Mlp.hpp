@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @class Mlp
+     * @brief Small dependency-free multilayer perceptron for bot policies.
+     *
+     * A ReLU trunk feeds two linear heads: policy logits and a tanh value.
+     * Dense kernels use AVX2/FMA when the compiler targets them (e.g.
+     * -march=native) and a portable loop otherwise. Int8 precision quantizes
+     * weights per output row and activations per input row.
+     *
+     * Weight file (little-endian): "MLP1", uint32 input size, uint32 trunk layer
+     * count, then for every layer (trunk, policy head, value head) uint32 in,
+     * uint32 out, float weights[out][in], float bias[out].
+     */
+    class Mlp {
+    public:
+        enum class Precision {
+            Float32,
+            Int8
+        };
+
+        /**
+         * @brief Build a randomly initialized network (He init, zero bias).
+         * @param inputSize Floats per observation
+         * @param hidden Width of every trunk layer
+         * @param policySize Number of policy logits
+         * @param seed RNG seed
+         * @throws InitError on a non-positive size
+         */
+        Mlp(int inputSize, const std::vector<int>& hidden, int policySize, uint32_t seed = 1);
+
+        /**
+         * @brief Load a network from a weight file.
+         * @throws std::runtime_error if the file is missing or malformed
+         */
+        static Mlp load(const std::string& path);
+
+        /**
+         * @brief Write the network in the weight-file format (atomic replace).
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void save(const std::string& path) const;
+
+        int inputSize() const;
+        int policySize() const;
+
+        /**
+         * @brief Switch the kernels used by evaluate; int8 weights are built on first use.
+         */
+        void setPrecision(Precision precision);
+        Precision getPrecision() const;
+
+        /**
+         * @brief Evaluate a batch of observations.
+         *
+         * Safe to call from several threads at once (scratch space is per thread).
+         * @param obs batch * inputSize() floats, row-major
+         * @param batch Number of rows
+         * @param policy Output, batch * policySize() logits
+         * @param value Output, batch values in [-1, 1] (may be nullptr)
+         */
+        void evaluate(const float* obs, size_t batch, float* policy, float* value) const;
+
+        /**
+         * @brief Pick the highest-scoring legal action for the player to move.
+         *
+         * Needs inputSize() == obs::SIZE and policySize() == actions::COUNT.
+         * @return Flat action index (see ActionSpace.hpp)
+         * @throws InitError if the network does not match the action space
+         */
+        int bestLegalAction(const Game& game) const;
+
+    private:
+        /**
+         * @brief One dense layer; rows are padded with zeros to a SIMD-friendly width.
+         */
+        struct Layer {
+            int in = 0;
+            int out = 0;
+            int stride = 0;              ///< Padded row length (multiple of 16)
+            std::vector<float> weights;  ///< out * stride
+            std::vector<float> bias;     ///< out
+            std::vector<int8_t> qWeights; ///< out * stride, int8 precision only
+            std::vector<float> qScale;   ///< Per-row dequantization factor
+        };
+
+        int input = 0;
+        std::vector<Layer> trunk;
+        Layer policyHead;
+        Layer valueHead;
+        Precision precision = Precision::Float32;
+
+        Mlp() = default;
+
+        static Layer makeLayer(int in, int out);
+        static void quantize(Layer& layer);
+        void forward(const Layer& layer, const float* in, size_t batch, float* out, int outStride, bool relu) const;
+    };
+} // namespace coup
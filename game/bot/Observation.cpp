@@ -0,0 +1,103 @@
+#include "Observation.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        int8_t clampToInt8(const int value) {
+            return static_cast<int8_t>(max(-128, min(127, value)));
+        }
+
+        void setRole(int8_t *oneHot, const Role role) {
+            if (role != Role::Unknown) oneHot[static_cast<int>(role)] = 1;
+        }
+
+        /**
+         * @brief Per-slot factor turning int8 values into floats of similar magnitude.
+         */
+        array<float, obs::SIZE> makeScale() {
+            array<float, obs::SIZE> scale{};
+            scale.fill(1.0f);
+            const float coinScale = 1.0f / Game::FORCE_COUP;
+            scale[obs::COINS] = coinScale;
+            scale[obs::TURN_COUNT] = 1.0f / 64.0f;
+            scale[obs::LAST_ARRESTED] = 1.0f / obs::MAX_OPPONENTS;
+            for (int k = 0; k < obs::MAX_OPPONENTS; ++k) {
+                scale[obs::OPPONENT + k * obs::OPPONENT_STRIDE + obs::OPP_COINS] = coinScale;
+            }
+            for (int k = 0; k < obs::HISTORY_LENGTH; ++k) {
+                const int base = obs::HISTORY + k * obs::HISTORY_STRIDE;
+                scale[base + obs::HIST_ACTION] = 1.0f / 8.0f;
+                scale[base + obs::HIST_ACTOR] = 1.0f / (obs::MAX_OPPONENTS + 1);
+                scale[base + obs::HIST_TARGET] = 1.0f / (obs::MAX_OPPONENTS + 1);
+                scale[base + obs::HIST_AGE] = 1.0f / obs::HISTORY_LENGTH;
+            }
+            return scale;
+        }
+
+        const array<float, obs::SIZE> SCALE = makeScale();
+    }
+
+    void encodeObservation(const Game &game, const Player *viewer, int8_t *out, const bool revealCoins) {
+        const auto &players = game.getPlayers();
+        const size_t count = players.size();
+        size_t seat = count;
+        for (size_t i = 0; i < count; ++i) {
+            if (players[i] == viewer) seat = i;
+        }
+        if (seat == count) {
+            throw invalid_argument("Viewer is not part of this game");
+        }
+        fill(out, out + obs::SIZE, static_cast<int8_t>(0));
+
+        // Offset of a player from the viewer in turn order, -1 if gone
+        auto offsetOf = [&](const Player *p) -> int {
+            for (size_t i = 0; i < count; ++i) {
+                if (players[i] == p) return static_cast<int>((i + count - seat) % count);
+            }
+            return -1;
+        };
+
+        out[obs::COINS] = clampToInt8(viewer->getCoins());
+        setRole(out + obs::ROLE, viewer->getRole());
+        out[obs::CAN_GATHER] = viewer->isGatherAllow();
+        out[obs::CAN_TAX] = viewer->isTaxAllow();
+        out[obs::CAN_ARREST] = viewer->isArrestAllow();
+        out[obs::COUP_SHIELD] = viewer->isCoupShieldActive();
+        out[obs::CAN_BRIBE] = viewer->isBribeAllow();
+        out[obs::TURNS_LEFT] = clampToInt8(viewer->getNumOfTurns());
+        out[obs::IS_MY_TURN] = static_cast<size_t>(game.getTurn()) == seat;
+        out[obs::TURN_COUNT] = clampToInt8(game.getTurnCount());
+        out[obs::LAST_ARRESTED] = clampToInt8(max(0, offsetOf(viewer->getLastArrestedPlayer())));
+
+        const bool seesCoins = revealCoins || viewer->getRole() == Role::Spy;
+        for (size_t k = 1; k < count && k <= obs::MAX_OPPONENTS; ++k) {
+            const Player *p = players[(seat + k) % count];
+            int8_t *slot = out + obs::OPPONENT + (k - 1) * obs::OPPONENT_STRIDE;
+            slot[obs::OPP_PRESENT] = 1;
+            slot[obs::OPP_COINS] = seesCoins ? clampToInt8(p->getCoins()) : static_cast<int8_t>(-1);
+            setRole(slot + obs::OPP_ROLE, p->getRole());
+        }
+
+        const size_t recent = min(game.recentActionCount(), static_cast<size_t>(obs::HISTORY_LENGTH));
+        for (size_t k = 0; k < recent; ++k) {
+            const ActionRecord &record = game.recentAction(k);
+            int8_t *slot = out + obs::HISTORY + k * obs::HISTORY_STRIDE;
+            slot[obs::HIST_ACTION] = static_cast<int8_t>(static_cast<int>(record.action) + 1);
+            slot[obs::HIST_ACTOR] = static_cast<int8_t>(offsetOf(record.actor) + 1);
+            slot[obs::HIST_TARGET] = record.target ? static_cast<int8_t>(offsetOf(record.target) + 1) : 0;
+            slot[obs::HIST_AGE] = static_cast<int8_t>(k + 1);
+        }
+    }
+
+    void encodeObservation(const Game &game, const Player *viewer, float *out, const bool revealCoins) {
+        alignas(32) int8_t raw[obs::SIZE];
+        encodeObservation(game, viewer, raw, revealCoins);
+        for (int i = 0; i < obs::SIZE; ++i) {
+            out[i] = raw[i] * SCALE[i];
+        }
+    }
+} // namespace coup
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @brief Fixed-length observation layout shared by bots, environments and opponent models.
+     *
+     * Every field is one int8 slot; the float encoding uses the same indices with
+     * per-slot scaling. SIZE is a multiple of 32 so a row fills whole SIMD
+     * registers. Opponents and history use seat offsets from the viewer in turn order
+     * (1 = next player); 0 in an offset slot means "none".
+     */
+    namespace obs {
+        // Viewer block
+        constexpr int COINS = 0;          ///< Viewer coins (clamped to 127)
+        constexpr int ROLE = 1;           ///< Viewer role one-hot, 6 slots
+        constexpr int CAN_GATHER = 7;
+        constexpr int CAN_TAX = 8;
+        constexpr int CAN_ARREST = 9;
+        constexpr int COUP_SHIELD = 10;
+        constexpr int CAN_BRIBE = 11;
+        constexpr int TURNS_LEFT = 12;    ///< Actions left this turn
+        constexpr int IS_MY_TURN = 13;
+        constexpr int TURN_COUNT = 14;    ///< Turns completed (clamped to 127)
+        constexpr int LAST_ARRESTED = 15; ///< Offset of the player the viewer last arrested (it may not arrest them again next)
+
+        // Opponent blocks: OPPONENT + k * OPPONENT_STRIDE for seat offset k + 1
+        constexpr int OPPONENT = 16;
+        constexpr int OPPONENT_STRIDE = 8;
+        constexpr int OPP_PRESENT = 0;    ///< 1 if the seat exists
+        constexpr int OPP_COINS = 1;      ///< Coins, or -1 when hidden from the viewer
+        constexpr int OPP_ROLE = 2;       ///< Role one-hot, 6 slots
+        constexpr int MAX_OPPONENTS = 5;
+
+        // History blocks: HISTORY + k * HISTORY_STRIDE for the k-th most recent action
+        constexpr int HISTORY = 64;
+        constexpr int HISTORY_STRIDE = 4;
+        constexpr int HIST_ACTION = 0;    ///< ActionType + 1, 0 if empty
+        constexpr int HIST_ACTOR = 1;     ///< Actor offset + 1 (1 = viewer), 0 if unknown
+        constexpr int HIST_TARGET = 2;    ///< Target offset + 1 (1 = viewer), 0 if none
+        constexpr int HIST_AGE = 3;       ///< 1 for the latest action, 2 for the one before, ...
+        constexpr int HISTORY_LENGTH = 8;
+
+        constexpr int SIZE = HISTORY + HISTORY_LENGTH * HISTORY_STRIDE; ///< 96 slots
+    }
+
+    /**
+     * @brief Encode a player's view of the game as int8 values.
+     *
+     * Opponent coins are only visible to a Spy (as in Spy::getCoinReport) unless
+     * revealCoins is set.
+     * @param game Game to encode
+     * @param viewer Player whose view is encoded (must be in the game)
+     * @param out Caller memory for obs::SIZE values
+     * @param revealCoins Show every opponent's coins regardless of role
+     * @throws std::invalid_argument if viewer is not in the game
+     */
+    void encodeObservation(const Game& game, const Player* viewer, int8_t* out, bool revealCoins = false);
+
+    /**
+     * @brief Encode a player's view as floats (same layout, scaled to roughly [0, 1]).
+     * @param game Game to encode
+     * @param viewer Player whose view is encoded (must be in the game)
+     * @param out Caller memory for obs::SIZE values
+     * @param revealCoins Show every opponent's coins regardless of role
+     * @throws std::invalid_argument if viewer is not in the game
+     */
+    void encodeObservation(const Game& game, const Player* viewer, float* out, bool revealCoins = false);
+} // namespace coup
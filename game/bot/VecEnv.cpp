@@ -0,0 +1,74 @@
+#include "VecEnv.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    VecEnv::VecEnv(const size_t numEnvs, const int seats, const bool randomRoles)
+        : episodeSteps(numEnvs, 0), randomRoles(randomRoles) {
+        if (seats < 2 || seats > 6) {
+            throw InitError("VecEnv supports 2 to 6 seats");
+        }
+        for (int i = 0; i < seats; ++i) {
+            names.push_back("P" + to_string(i));
+        }
+        games.reserve(numEnvs);
+        for (size_t i = 0; i < numEnvs; ++i) {
+            games.emplace_back(names, !randomRoles);
+        }
+    }
+
+    size_t VecEnv::size() const {
+        return games.size();
+    }
+
+    const Game &VecEnv::game(const size_t env) const {
+        return games.at(env);
+    }
+
+    void VecEnv::restart(const size_t env) {
+        games[env] = Game(names, !randomRoles);
+        episodeSteps[env] = 0;
+    }
+
+    void VecEnv::reset(float *obs, uint8_t *masks) {
+        for (size_t i = 0; i < games.size(); ++i) {
+            restart(i);
+            write(i, obs, masks);
+        }
+    }
+
+    void VecEnv::step(const int32_t *actionIdx, float *obs, uint8_t *masks, float *rewards, uint8_t *dones) {
+        // Check the whole batch first, so a bad action leaves every game as it was
+        for (size_t i = 0; i < games.size(); ++i) {
+            const int32_t action = actionIdx[i];
+            if (action < 0 || action >= actions::COUNT || !((legalActionMask(games[i]) >> action) & 1u)) {
+                throw ActionError("Illegal action index: " + to_string(action) + " in env " + to_string(i));
+            }
+        }
+        for (size_t i = 0; i < games.size(); ++i) {
+            Game &g = games[i];
+            applyAction(g, actionIdx[i]);
+            ++episodeSteps[i];
+
+            const bool won = g.getPlayers().size() == 1;
+            rewards[i] = won ? 1.0f : 0.0f;
+            dones[i] = won || episodeSteps[i] >= MAX_EPISODE_STEPS;
+            if (dones[i]) {
+                restart(i);
+            }
+            write(i, obs, masks);
+        }
+    }
+
+    void VecEnv::write(const size_t env, float *obs, uint8_t *masks) const {
+        const Game &g = games[env];
+        encodeObservation(g, g.getPlayers()[g.getTurn()], obs + env * OBS_SIZE);
+
+        const uint32_t legal = legalActionMask(g);
+        uint8_t *mask = masks + env * actions::COUNT;
+        for (int a = 0; a < actions::COUNT; ++a) {
+            mask[a] = (legal >> a) & 1u;
+        }
+    }
+} // namespace coup
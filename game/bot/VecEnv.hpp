@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ActionSpace.hpp"
+#include "Observation.hpp"
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @class VecEnv
+     * @brief Vectorized reset/step over many Game instances with auto-reset.
+     *
+     * Every call writes into caller-provided contiguous buffers laid out env-major:
+     * obs[numEnvs][OBS_SIZE], masks[numEnvs][actions::COUNT], rewards[numEnvs],
+     * dones[numEnvs]. Observations are encodeObservation() for the player whose turn it is.
+     * The reward goes to the player who acted: +1 for the winning move, 0 otherwise.
+     */
+    class VecEnv {
+    public:
+        static constexpr int OBS_SIZE = obs::SIZE;     ///< Floats per observation
+        static constexpr int MAX_EPISODE_STEPS = 500;  ///< Truncate endless games
+
+        /**
+         * @brief Create the environments.
+         * @param numEnvs Number of games
+         * @param seats Players per game (2..6)
+         * @param randomRoles Draw roles at random instead of the fixed Game(names) order
+         * @throws InitError on a bad seat count
+         */
+        VecEnv(size_t numEnvs, int seats, bool randomRoles = false);
+
+        /** @return Number of environments. */
+        size_t size() const;
+
+        /**
+         * @brief Restart every game and write initial observations.
+         * @param obs Output, numEnvs * OBS_SIZE floats
+         * @param masks Output, numEnvs * actions::COUNT bytes (1 = legal)
+         */
+        void reset(float* obs, uint8_t* masks);
+
+        /**
+         * @brief Play one action in every game; finished games restart automatically.
+         * @param actionIdx One flat action index per env
+         * @param obs Output observations (of the new game after a reset)
+         * @param masks Output legal-action masks
+         * @param rewards Output reward for the acting player
+         * @param dones Output 1 if the game ended or was truncated
+         * @throws ActionError if any action is illegal (no game is stepped and nothing is written)
+         */
+        void step(const int32_t* actionIdx, float* obs, uint8_t* masks, float* rewards, uint8_t* dones);
+
+        /** @return Game behind an environment. */
+        const Game& game(size_t env) const;
+
+    private:
+        std::vector<Game> games;
+        std::vector<int> episodeSteps;
+        std::vector<std::string> names;
+        bool randomRoles;
+
+        void restart(size_t env);
+        void write(size_t env, float* obs, uint8_t* masks) const;
+    };
+} // namespace coup
@@ -0,0 +1,66 @@
+#include "CoupEnv.h"
+#include <exception>
+#include <string>
+#include "../bot/VecEnv.hpp"
+
+struct CoupEnv {
+    coup::VecEnv env;
+    std::string lastError;
+
+    CoupEnv(const size_t numEnvs, const int seats, const bool randomRoles)
+        : env(numEnvs, seats, randomRoles) {
+    }
+};
+
+CoupEnv *coup_env_create(const size_t num_envs, const int seats, const int random_roles) {
+    try {
+        return new CoupEnv(num_envs, seats, random_roles != 0);
+    } catch (const std::exception &) {
+        return nullptr;
+    }
+}
+
+void coup_env_destroy(CoupEnv *env) {
+    delete env;
+}
+
+int coup_env_obs_size(void) {
+    return coup::VecEnv::OBS_SIZE;
+}
+
+int coup_env_action_count(void) {
+    return coup::actions::COUNT;
+}
+
+size_t coup_env_num_envs(const CoupEnv *env) {
+    return env ? env->env.size() : 0;
+}
+
+int coup_env_reset(CoupEnv *env, float *obs, uint8_t *masks) {
+    if (!env) return -1;
+    try {
+        env->env.reset(obs, masks);
+        env->lastError.clear();
+        return 0;
+    } catch (const std::exception &e) {
+        env->lastError = e.what();
+        return -1;
+    }
+}
+
+int coup_env_step(CoupEnv *env, const int32_t *actions, float *obs, uint8_t *masks,
+                  float *rewards, uint8_t *dones) {
+    if (!env) return -1;
+    try {
+        env->env.step(actions, obs, masks, rewards, dones);
+        env->lastError.clear();
+        return 0;
+    } catch (const std::exception &e) {
+        env->lastError = e.what();
+        return -1;
+    }
+}
+
+const char *coup_env_last_error(const CoupEnv *env) {
+    return env ? env->lastError.c_str() : "null environment";
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * @file CoupEnv.h
+ * @brief C API over coup::VecEnv for foreign-function callers (e.g. Python ctypes).
+ *
+ * All buffers are owned by the caller and written in place, env-major:
+ * obs[num_envs][coup_env_obs_size()], masks[num_envs][coup_env_action_count()],
+ * rewards[num_envs], dones[num_envs]. Functions returning int report 0 on
+ * success and -1 on failure; coup_env_last_error() then describes the failure.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CoupEnv CoupEnv;
+
+/** @brief Create num_envs games with the given seat count; NULL on failure. */
+CoupEnv* coup_env_create(size_t num_envs, int seats, int random_roles);
+
+/** @brief Free an environment created by coup_env_create. */
+void coup_env_destroy(CoupEnv* env);
+
+/** @return Floats per observation. */
+int coup_env_obs_size(void);
+
+/** @return Number of flat action indices. */
+int coup_env_action_count(void);
+
+/** @return Number of games in the environment. */
+size_t coup_env_num_envs(const CoupEnv* env);
+
+/** @brief Restart every game and write initial observations and masks. */
+int coup_env_reset(CoupEnv* env, float* obs, uint8_t* masks);
+
+/** @brief Step every game with one action each; finished games auto-reset. */
+int coup_env_step(CoupEnv* env, const int32_t* actions, float* obs, uint8_t* masks,
+                  float* rewards, uint8_t* dones);
+
+/** @return Message of the last failure on this environment, or "" if none. */
+const char* coup_env_last_error(const CoupEnv* env);
+
+#ifdef __cplusplus
+}
+#endif
@@ -68,7 +68,7 @@ Player& Player::operator=(const Player& other) {
 /**
  * @return The name of this player.
  */
-string Player::getName() const {
+const string& Player::getName() const {
     return playerName;
 }
 
@@ -329,7 +329,7 @@ void Player::removeCoins(const int amount) {
 /**
  * @return Remaining turns count.
  */
-int Player::getNumOfTurns() {
+int Player::getNumOfTurns() const {
     return numberOfTurns;
 }
 
@@ -142,7 +142,7 @@ public:
     //------------------------------------------------------------------------
 
     /** @return Player's name */
-    std::string getName() const;
+    const std::string& getName() const;
 
     /** @return Player's role */
     Role getRole() const;
@@ -151,7 +151,7 @@ public:
     int getCoins() const;
 
     /** @return Number of turns remaining */
-    int getNumOfTurns();
+    int getNumOfTurns() const;
 
     /** @return Pointer to the player who last arrested this one */
     const Player* getLastArrestedPlayer() const;
@@ -0,0 +1,201 @@
+#include "Leaderboard.hpp"
+#include <algorithm>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    Leaderboard::Leaderboard(const uint32_t seed) : random(seed ? seed : 1) {
+    }
+
+    //------------------------------------------------------------------------------
+    // Treap
+    //------------------------------------------------------------------------------
+
+    uint32_t Leaderboard::sizeOf(const uint32_t node) const {
+        return node == NONE ? 0 : nodes[node].size;
+    }
+
+    void Leaderboard::pull(const uint32_t node) {
+        nodes[node].size = 1 + sizeOf(nodes[node].left) + sizeOf(nodes[node].right);
+    }
+
+    bool Leaderboard::before(const Node &a, const double score, const uint32_t player) const {
+        return a.score > score || (a.score == score && a.player < player);
+    }
+
+    // left: nodes ranked before (score, player); right: the rest
+    void Leaderboard::split(const uint32_t node, const double score, const uint32_t player, uint32_t &left,
+                            uint32_t &right) {
+        if (node == NONE) {
+            left = right = NONE;
+            return;
+        }
+        if (before(nodes[node], score, player)) {
+            split(nodes[node].right, score, player, nodes[node].right, right);
+            left = node;
+        } else {
+            split(nodes[node].left, score, player, left, nodes[node].left);
+            right = node;
+        }
+        pull(node);
+    }
+
+    uint32_t Leaderboard::merge(const uint32_t left, const uint32_t right) {
+        if (left == NONE) return right;
+        if (right == NONE) return left;
+        if (nodes[left].priority > nodes[right].priority) {
+            nodes[left].right = merge(nodes[left].right, right);
+            pull(left);
+            return left;
+        }
+        nodes[right].left = merge(left, nodes[right].left);
+        pull(right);
+        return right;
+    }
+
+    uint32_t Leaderboard::erase(const uint32_t node, const double score, const uint32_t player) {
+        Node &n = nodes[node];
+        if (n.player == player) {
+            return merge(n.left, n.right);
+        }
+        if (before(n, score, player)) {
+            n.right = erase(n.right, score, player);
+        } else {
+            n.left = erase(n.left, score, player);
+        }
+        pull(node);
+        return node;
+    }
+
+    //------------------------------------------------------------------------------
+    // Updates
+    //------------------------------------------------------------------------------
+
+    void Leaderboard::update(const uint32_t player, const double score) {
+        if (player >= nodeOf.size()) nodeOf.resize(static_cast<size_t>(player) + 1, NONE);
+        uint32_t index = nodeOf[player];
+        if (index != NONE) {
+            root = erase(root, nodes[index].score, player);
+        } else if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        // xorshift32 priorities keep the treap balanced in expectation
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        nodes[index] = Node{score, player, random, NONE, NONE, 1};
+        nodeOf[player] = index;
+        uint32_t left, right;
+        split(root, score, player, left, right);
+        root = merge(merge(left, index), right);
+    }
+
+    bool Leaderboard::remove(const uint32_t player) {
+        if (!contains(player)) return false;
+        const uint32_t index = nodeOf[player];
+        root = erase(root, nodes[index].score, player);
+        nodeOf[player] = NONE;
+        freeList.push_back(index);
+        return true;
+    }
+
+    bool Leaderboard::contains(const uint32_t player) const {
+        return player < nodeOf.size() && nodeOf[player] != NONE;
+    }
+
+    size_t Leaderboard::size() const {
+        return sizeOf(root);
+    }
+
+    void Leaderboard::reserve(const size_t n) {
+        nodes.reserve(n);
+        if (nodeOf.size() < n) nodeOf.resize(n, NONE);
+    }
+
+    //------------------------------------------------------------------------------
+    // Queries
+    //------------------------------------------------------------------------------
+
+    size_t Leaderboard::rank(const uint32_t player) const {
+        if (!contains(player)) {
+            throw InitError("Player is not on the leaderboard");
+        }
+        const uint32_t target = nodeOf[player];
+        const double score = nodes[target].score;
+        size_t ahead = 0;
+        uint32_t node = root;
+        while (node != target) {
+            if (before(nodes[node], score, player)) {
+                ahead += sizeOf(nodes[node].left) + 1;
+                node = nodes[node].right;
+            } else {
+                node = nodes[node].left;
+            }
+        }
+        return ahead + sizeOf(nodes[node].left);
+    }
+
+    Standing Leaderboard::at(size_t rank) const {
+        if (rank >= size()) {
+            throw InitError("No player at that rank");
+        }
+        const size_t wanted = rank;
+        uint32_t node = root;
+        while (true) {
+            const size_t left = sizeOf(nodes[node].left);
+            if (rank < left) {
+                node = nodes[node].left;
+            } else if (rank == left) {
+                return Standing{nodes[node].player, nodes[node].score, wanted};
+            } else {
+                rank -= left + 1;
+                node = nodes[node].right;
+            }
+        }
+    }
+
+    vector<Standing> Leaderboard::range(const size_t firstRank, const size_t count) const {
+        vector<Standing> out;
+        if (firstRank >= size() || count == 0) return out;
+        out.reserve(min(count, size() - firstRank));
+        // Descend to firstRank keeping the ancestors still to visit, then walk in order
+        vector<uint32_t> stack;
+        size_t skip = firstRank;
+        uint32_t node = root;
+        while (node != NONE) {
+            const size_t left = sizeOf(nodes[node].left);
+            if (skip < left) {
+                stack.push_back(node);
+                node = nodes[node].left;
+            } else if (skip == left) {
+                stack.push_back(node);
+                break;
+            } else {
+                skip -= left + 1;
+                node = nodes[node].right;
+            }
+        }
+        while (!stack.empty() && out.size() < count) {
+            node = stack.back();
+            stack.pop_back();
+            out.push_back(Standing{nodes[node].player, nodes[node].score, firstRank + out.size()});
+            for (node = nodes[node].right; node != NONE; node = nodes[node].left) stack.push_back(node);
+        }
+        return out;
+    }
+
+    vector<Standing> Leaderboard::top(const size_t k) const {
+        return range(0, k);
+    }
+
+    vector<Standing> Leaderboard::around(const uint32_t player, const size_t radius) const {
+        const size_t r = rank(player);
+        const size_t first = r > radius ? r - radius : 0;
+        return range(first, r - first + radius + 1);
+    }
+} // namespace coup
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace coup {
+    /**
+     * @struct Standing
+     * @brief A player's place on a Leaderboard.
+     */
+    struct Standing {
+        uint32_t player = 0;
+        double score = 0.0;
+        size_t rank = 0;        ///< 0 for the best score
+    };
+
+    /**
+     * @class Leaderboard
+     * @brief Players ordered by score with O(log n) updates, rank queries and range scans.
+     *
+     * An order-statistic treap: every node knows the size of its subtree, so
+     * the rank of a node is counted on the way down and the node at a rank is
+     * found the same way. Nodes live in one arena and link by index, as the
+     * TimerWheel pool does, and a player's node is found through a dense table
+     * indexed by player id, so updates never allocate once the arena has grown.
+     * Higher scores rank first; equal scores rank by player id. Not thread-safe.
+     */
+    class Leaderboard {
+    public:
+        /**
+         * @param seed Seed for node priorities
+         */
+        explicit Leaderboard(uint32_t seed = 1);
+
+        /**
+         * @brief Add a player or move them to a new score.
+         */
+        void update(uint32_t player, double score);
+
+        /**
+         * @brief Take a player off the board.
+         * @return False if they were not on it
+         */
+        bool remove(uint32_t player);
+
+        bool contains(uint32_t player) const;
+
+        size_t size() const;
+
+        /**
+         * @return Rank of a player, 0 for the best
+         * @throws InitError if the player is not on the board
+         */
+        size_t rank(uint32_t player) const;
+
+        /**
+         * @return The player at a rank
+         * @throws InitError if the rank is not below size()
+         */
+        Standing at(size_t rank) const;
+
+        /**
+         * @return Up to count standings from a rank on, best first
+         */
+        std::vector<Standing> range(size_t firstRank, size_t count) const;
+
+        /** @return The best k standings. */
+        std::vector<Standing> top(size_t k) const;
+
+        /**
+         * @return A player with up to radius standings above and below
+         * @throws InitError if the player is not on the board
+         */
+        std::vector<Standing> around(uint32_t player, size_t radius) const;
+
+        /** @brief Make room for players ids below n without reallocating. */
+        void reserve(size_t n);
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Node {
+            double score = 0.0;
+            uint32_t player = 0;
+            uint32_t priority = 0;
+            uint32_t left = NONE;
+            uint32_t right = NONE;
+            uint32_t size = 1;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> freeList;
+        std::vector<uint32_t> nodeOf;   ///< Node by player id, NONE if off the board
+        uint32_t root = NONE;
+        uint32_t random;
+
+        uint32_t sizeOf(uint32_t node) const;
+        void pull(uint32_t node);
+        bool before(const Node& a, double score, uint32_t player) const;
+        void split(uint32_t node, double score, uint32_t player, uint32_t& left, uint32_t& right);
+        uint32_t merge(uint32_t left, uint32_t right);
+        uint32_t erase(uint32_t node, double score, uint32_t player);
+    };
+} // namespace coup
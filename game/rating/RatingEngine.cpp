@@ -0,0 +1,284 @@
+#include "RatingEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include "../GameExceptions.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr double SCALE = 173.7178;       ///< Glicko-2 scale factor
+        constexpr double BASE = 1500.0;
+        constexpr double PI = 3.14159265358979323846;
+        constexpr double EPSILON = 0.000001;     ///< Convergence of the volatility search
+        constexpr char STORE_MAGIC[4] = {'G', 'L', 'K', '2'};
+        constexpr uint64_t STORE_HEADER = sizeof(STORE_MAGIC) + 2 * sizeof(uint64_t);
+        constexpr uint64_t STORE_RECORD = 3 * sizeof(float) + sizeof(uint32_t); ///< Rating, deviation, volatility, games
+
+        double g(const double phi) {
+            return 1.0 / sqrt(1.0 + 3.0 * phi * phi / (PI * PI));
+        }
+
+        /**
+         * @brief New volatility by the Illinois method (step 5 of Glickman's paper).
+         */
+        double nextVolatility(const double sigma, const double phi, const double v, const double delta,
+                              const double tau) {
+            const double a = log(sigma * sigma);
+            const auto f = [&](const double x) {
+                const double ex = exp(x);
+                const double d = phi * phi + v + ex;
+                return ex * (delta * delta - phi * phi - v - ex) / (2.0 * d * d) - (x - a) / (tau * tau);
+            };
+            double A = a;
+            double B;
+            if (delta * delta > phi * phi + v) {
+                B = log(delta * delta - phi * phi - v);
+            } else {
+                int k = 1;
+                while (f(a - k * tau) < 0) ++k;
+                B = a - k * tau;
+            }
+            double fA = f(A);
+            double fB = f(B);
+            while (fabs(B - A) > EPSILON) {
+                const double C = A + (A - B) * fA / (fB - fA);
+                const double fC = f(C);
+                if (fC * fB <= 0) {
+                    A = B;
+                    fA = fB;
+                } else {
+                    fA /= 2.0;
+                }
+                B = C;
+                fB = fC;
+            }
+            return exp(A / 2.0);
+        }
+    }
+
+    RatingEngine::RatingEngine() : RatingEngine(Options()) {
+    }
+
+    RatingEngine::RatingEngine(const Options &options) : options(options) {
+    }
+
+    //------------------------------------------------------------------------------
+    // Recording
+    //------------------------------------------------------------------------------
+
+    void RatingEngine::record(const vector<uint32_t> &players, const vector<uint8_t> &ranks) {
+        if (players.size() < 2 || players.size() > MAX_SEATS || ranks.size() != players.size()) {
+            throw InitError("A rated game needs 2 to 6 players, each with a rank");
+        }
+        Result result{};
+        result.seats = static_cast<uint8_t>(players.size());
+        for (size_t s = 0; s < players.size(); ++s) {
+            if (find(players.begin(), players.begin() + s, players[s]) != players.begin() + s) {
+                throw InitError("A player cannot sit twice at one rated game");
+            }
+            result.players[s] = players[s];
+            result.ranks[s] = ranks[s];
+        }
+        const uint32_t highest = *max_element(players.begin(), players.end());
+        if (highest >= ratings.size()) set(highest, options.initial);
+        results.push_back(result);
+    }
+
+    void RatingEngine::recordFinish(const vector<uint32_t> &finishOrder) {
+        vector<uint8_t> ranks(finishOrder.size());
+        for (size_t i = 0; i < ranks.size(); ++i) ranks[i] = static_cast<uint8_t>(i);
+        record(finishOrder, ranks);
+    }
+
+    size_t RatingEngine::pending() const {
+        return results.size();
+    }
+
+    //------------------------------------------------------------------------------
+    // Rating periods
+    //------------------------------------------------------------------------------
+
+    void RatingEngine::closePeriod() {
+        // Group participations by player so every worker owns a range of players
+        offsets.assign(ratings.size() + 1, 0);
+        for (const Result &r: results) {
+            for (uint8_t s = 0; s < r.seats; ++s) ++offsets[r.players[s] + 1];
+        }
+        for (size_t i = 1; i < offsets.size(); ++i) offsets[i] += offsets[i - 1];
+        byPlayer.resize(offsets.back());
+        vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result &r = results[i];
+            for (uint8_t s = 0; s < r.seats; ++s) byPlayer[cursor[r.players[s]]++] = static_cast<uint32_t>(i);
+        }
+
+        const vector<Rating> before = ratings;
+        const size_t workers = static_cast<size_t>(max(1, options.threads));
+        const size_t share = (ratings.size() + workers - 1) / workers;
+        vector<thread> pool;
+        for (size_t w = 1; w < workers; ++w) {
+            const size_t begin = min(ratings.size(), w * share);
+            const size_t end = min(ratings.size(), begin + share);
+            if (begin < end) pool.emplace_back(&RatingEngine::ratePlayers, this, begin, end, cref(before));
+        }
+        ratePlayers(0, min(ratings.size(), share), before);
+        for (auto &t: pool) {
+            t.join();
+        }
+        results.clear();
+        ++closed;
+    }
+
+    void RatingEngine::ratePlayers(const size_t begin, const size_t end, const vector<Rating> &before) {
+        const double maxPhi = options.initial.deviation / SCALE;
+        for (size_t i = begin; i < end; ++i) {
+            const Rating &r = before[i];
+            const double mu = (r.rating - BASE) / SCALE;
+            const double phi = r.deviation / SCALE;
+            const uint32_t first = offsets[i];
+            const uint32_t last = offsets[i + 1];
+            if (first == last) {
+                // Sat out the period: only the uncertainty grows, never beyond a newcomer's
+                ratings[i].deviation = SCALE * min(maxPhi, sqrt(phi * phi + r.volatility * r.volatility));
+                continue;
+            }
+            double information = 0.0; // 1 / v
+            double improvement = 0.0; // delta / v
+            for (uint32_t k = first; k < last; ++k) {
+                const Result &game = results[byPlayer[k]];
+                uint8_t mine = 0;
+                while (game.players[mine] != i) ++mine;
+                const double weight = 1.0 / (game.seats - 1);
+                for (uint8_t o = 0; o < game.seats; ++o) {
+                    if (o == mine) continue;
+                    const Rating &opponent = before[game.players[o]];
+                    const double gj = g(opponent.deviation / SCALE);
+                    const double expected = 1.0 / (1.0 + exp(-gj * (mu - (opponent.rating - BASE) / SCALE)));
+                    const double score = game.ranks[mine] < game.ranks[o] ? 1.0
+                                         : game.ranks[mine] == game.ranks[o] ? 0.5 : 0.0;
+                    information += weight * gj * gj * expected * (1.0 - expected);
+                    improvement += weight * gj * (score - expected);
+                }
+            }
+            const double v = 1.0 / information;
+            const double sigma = nextVolatility(r.volatility, phi, v, v * improvement, options.tau);
+            const double phiStar = sqrt(phi * phi + sigma * sigma);
+            const double phiNext = 1.0 / sqrt(1.0 / (phiStar * phiStar) + information);
+            Rating &next = ratings[i];
+            next.rating = BASE + SCALE * (mu + phiNext * phiNext * improvement);
+            next.deviation = SCALE * phiNext;
+            next.volatility = sigma;
+            next.games = r.games + (last - first);
+        }
+    }
+
+    void RatingEngine::set(const uint32_t player, const Rating &rating) {
+        if (player >= ratings.size()) {
+            Rating fresh = options.initial;
+            fresh.games = 0;
+            ratings.resize(static_cast<size_t>(player) + 1, fresh);
+        }
+        ratings[player] = rating;
+    }
+
+    Rating RatingEngine::rating(const uint32_t player) const {
+        return player < ratings.size() ? ratings[player] : options.initial;
+    }
+
+    size_t RatingEngine::playerCount() const {
+        return ratings.size();
+    }
+
+    uint64_t RatingEngine::periods() const {
+        return closed;
+    }
+
+    //------------------------------------------------------------------------------
+    // Persistence
+    //------------------------------------------------------------------------------
+
+    void RatingEngine::save(const string &path) const {
+        const string tmp = path + ".tmp";
+        {
+            ofstream out(tmp, ios::binary | ios::trunc);
+            if (!out) {
+                throw runtime_error("Cannot write ratings: " + path);
+            }
+            const uint64_t count = ratings.size();
+            out.write(STORE_MAGIC, sizeof(STORE_MAGIC));
+            out.write(reinterpret_cast<const char *>(&closed), sizeof(closed));
+            out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            for (const Rating &r: ratings) {
+                const float fields[3] = {
+                    static_cast<float>(r.rating), static_cast<float>(r.deviation), static_cast<float>(r.volatility)
+                };
+                out.write(reinterpret_cast<const char *>(fields), sizeof(fields));
+                out.write(reinterpret_cast<const char *>(&r.games), sizeof(r.games));
+            }
+            if (!out) {
+                throw runtime_error("Failed writing ratings: " + path);
+            }
+        }
+#ifdef __linux__
+        // On disk before the rename, or a crash could leave the new name on an empty file
+        const int fd = ::open(tmp.c_str(), O_RDONLY | O_CLOEXEC);
+        const bool synced = fd >= 0 && fsync(fd) == 0;
+        if (fd >= 0) ::close(fd);
+        if (!synced) {
+            throw runtime_error("Cannot sync ratings: " + path);
+        }
+#endif
+        // Replace atomically so a crash leaves either the old store or the new one
+        if (rename(tmp.c_str(), path.c_str()) != 0) {
+            throw runtime_error("Cannot replace ratings: " + path);
+        }
+    }
+
+    void RatingEngine::load(const string &path) {
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open ratings: " + path);
+        }
+        char magic[sizeof(STORE_MAGIC)];
+        uint64_t savedPeriods = 0;
+        uint64_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char *>(&savedPeriods), sizeof(savedPeriods));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || memcmp(magic, STORE_MAGIC, sizeof(magic)) != 0 || count > UINT32_MAX) {
+            throw runtime_error("Not a rating store: " + path);
+        }
+        // Check the size before allocating, so a corrupt count cannot ask for gigabytes
+        in.seekg(0, ios::end);
+        const uint64_t size = static_cast<uint64_t>(in.tellg());
+        if (!in || size < STORE_HEADER || (size - STORE_HEADER) / STORE_RECORD < count) {
+            throw runtime_error("Truncated rating store: " + path);
+        }
+        in.seekg(static_cast<streamoff>(STORE_HEADER));
+        vector<Rating> loaded(count);
+        for (Rating &r: loaded) {
+            float fields[3];
+            in.read(reinterpret_cast<char *>(fields), sizeof(fields));
+            in.read(reinterpret_cast<char *>(&r.games), sizeof(r.games));
+            r.rating = fields[0];
+            r.deviation = fields[1];
+            r.volatility = fields[2];
+        }
+        if (!in) {
+            throw runtime_error("Truncated rating store: " + path);
+        }
+        ratings = move(loaded);
+        closed = savedPeriods;
+    }
+} // namespace coup
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+    /**
+     * @struct Rating
+     * @brief A player's Glicko-2 rating on the familiar 1500 scale.
+     */
+    struct Rating {
+        double rating = 1500.0;
+        double deviation = 350.0;   ///< RD: 95% of the time the skill is within 2 RD
+        double volatility = 0.06;
+        uint32_t games = 0;         ///< Games rated so far
+    };
+
+    /**
+     * @class RatingEngine
+     * @brief Multiplayer Glicko-2 over rating periods of many finished games.
+     *
+     * A table of n players counts as n(n-1)/2 pairwise results: a player beat
+     * everyone eliminated before them and tied anyone with the same rank. Each
+     * pair is weighted 1/(n-1) so one game weighs the same for a player at
+     * every table size. Games are only recorded until closePeriod(), which
+     * rates every player against the opponents' ratings at the start of the
+     * period, as Glicko-2 prescribes. Because of that the players are
+     * independent: the period's games are indexed by player once, then worker
+     * threads update disjoint ranges of players without sharing anything.
+     */
+    class RatingEngine {
+    public:
+        static constexpr size_t MAX_SEATS = 6;
+
+        struct Options {
+            double tau = 0.5;           ///< How fast volatility may change
+            Rating initial;             ///< Rating of a newcomer
+            int threads = 1;            ///< Workers used by closePeriod()
+        };
+
+        RatingEngine();
+        explicit RatingEngine(const Options& options);
+
+        /**
+         * @brief Record a finished game for the current period.
+         * @param players Player ids, one per seat; new ids start at Options::initial
+         * @param ranks Finishing rank per seat, 0 for the winner; equal ranks tie
+         * @throws InitError on fewer than 2 or more than MAX_SEATS players, mismatched
+         *         sizes or a player listed twice
+         */
+        void record(const std::vector<uint32_t>& players, const std::vector<uint8_t>& ranks);
+
+        /**
+         * @brief Record a game that ended with a winner (Game::winner()).
+         * @param finishOrder Winner first, then the players in reverse order of elimination
+         * @throws InitError as record()
+         */
+        void recordFinish(const std::vector<uint32_t>& finishOrder);
+
+        /** @return Games recorded since the last closePeriod(). */
+        size_t pending() const;
+
+        /**
+         * @brief Rate every recorded game as one period and start the next.
+         *
+         * Players without games only grow less certain (their RD widens).
+         */
+        void closePeriod();
+
+        /**
+         * @brief Seed a player's rating, e.g. from another system; takes effect in the current period.
+         */
+        void set(uint32_t player, const Rating& rating);
+
+        /** @return Rating of a player; Options::initial for an unknown id. */
+        Rating rating(uint32_t player) const;
+
+        /** @return One past the highest player id seen. */
+        size_t playerCount() const;
+
+        /** @return Periods closed so far. */
+        uint64_t periods() const;
+
+        /**
+         * @brief Write every rating to a compact binary file (16 bytes a player).
+         *
+         * Written to a temporary file, synced (on Linux) and renamed over the old one.
+         * @throws std::runtime_error if the file cannot be written or synced
+         */
+        void save(const std::string& path) const;
+
+        /**
+         * @brief Replace every rating with the ones in a file from save().
+         * @throws std::runtime_error if the file is missing, malformed or truncated
+         */
+        void load(const std::string& path);
+
+    private:
+        /** @brief One recorded game, packed to a fixed size. */
+        struct Result {
+            uint32_t players[MAX_SEATS];
+            uint8_t ranks[MAX_SEATS];
+            uint8_t seats;
+        };
+
+        Options options;
+        std::vector<Rating> ratings;
+        std::vector<Result> results;    ///< Games of the current period
+        std::vector<uint32_t> offsets;  ///< Scratch: first entry of each player in byPlayer
+        std::vector<uint32_t> byPlayer; ///< Scratch: result index per participation, grouped by player
+        uint64_t closed = 0;
+
+        void ratePlayers(size_t begin, size_t end, const std::vector<Rating>& before);
+    };
+} // namespace coup
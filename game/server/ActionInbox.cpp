@@ -0,0 +1,60 @@
+#include "ActionInbox.hpp"
+
+using namespace std;
+
+namespace coup {
+    ActionInbox::ActionInbox(TurnPipeline &pipeline, const size_t capacity)
+        : pipeline(&pipeline), queue(capacity) {
+    }
+
+    bool ActionInbox::submit(Submission submission) {
+        return queue.tryPush(submission);
+    }
+
+    size_t ActionInbox::drain(const function<void(const Submission &, bool)> &report, const size_t max) {
+        size_t applied = 0;
+        Submission submission;
+        for (size_t taken = 0; taken < max && queue.tryPop(submission); ++taken) {
+            const bool ok = apply(submission);
+            if (ok) {
+                ++applied;
+            } else {
+                ++stale;
+            }
+            if (report) report(submission, ok);
+        }
+        if (applied > 0 && mirror) mirror->publish(pipeline->game()); // once per batch
+        return applied;
+    }
+
+    bool ActionInbox::apply(const Submission &submission) {
+        if (submission.version != decisions.load(memory_order_relaxed) ||
+            submission.expected != pipeline->awaiting()) {
+            return false;
+        }
+        int answer = submission.answer;
+        if (submission.source == Submission::Source::Timer) {
+            answer = pipeline->fallback();
+            if (answer < 0) return false;
+        } else if (submission.player != pipeline->decider() || answer < 0 || answer >= 32 ||
+                   !(pipeline->legal() >> answer & 1u)) {
+            return false;
+        }
+        pipeline->resume(answer);
+        decisions.store(decisions.load(memory_order_relaxed) + 1, memory_order_release);
+        return true;
+    }
+
+    void ActionInbox::setMirror(GameMirror *mirror) {
+        this->mirror = mirror;
+        if (mirror) mirror->publish(pipeline->game());
+    }
+
+    uint32_t ActionInbox::version() const {
+        return decisions.load(memory_order_acquire);
+    }
+
+    size_t ActionInbox::rejected() const {
+        return stale;
+    }
+} // namespace coup
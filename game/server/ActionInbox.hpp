@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "MpscQueue.hpp"
+#include "../sim/GameMirror.hpp"
+#include "../sim/TurnPipeline.hpp"
+
+namespace coup {
+    /**
+     * @struct Submission
+     * @brief One answer offered to a game from some thread.
+     */
+    struct Submission {
+        enum class Source : uint8_t {
+            Player, ///< The current player's action or a role holder's block answer
+            Timer   ///< The decision's clock ran out: TurnPipeline::fallback() is applied
+        };
+
+        Source source = Source::Player;
+        const Player* player = nullptr; ///< Who answers (Player only)
+        Await expected = Await::Action; ///< Suspension point the answer is for
+        int answer = 0;                 ///< Player only
+        uint32_t version = 0;           ///< ActionInbox::version() the submitter decided on
+        uint64_t tag = 0;               ///< Caller's cookie, handed back by drain()
+    };
+
+    /**
+     * @class ActionInbox
+     * @brief Lock-free intake of answers for one game, applied by the thread that owns it.
+     *
+     * Players, blockers and clocks on any thread submit(); the owner calls
+     * drain() to apply everything waiting in one batch, so a busy block
+     * window costs a compare-and-swap per answer instead of a contended
+     * table mutex. Each decision bumps version(); an answer carrying an older
+     * version, the wrong suspension point or the wrong player lost a race and
+     * is rejected without touching the game.
+     */
+    class ActionInbox {
+    public:
+        /**
+         * @param pipeline Pipeline of the game; only the draining thread may touch it
+         * @param capacity Submissions that can wait at once
+         * @throws InitError if capacity is 0
+         */
+        explicit ActionInbox(TurnPipeline& pipeline, size_t capacity = 64);
+
+        /**
+         * @brief Offer an answer; safe from any thread.
+         * @return False if the inbox is full (the submitter retries or gives up)
+         */
+        bool submit(Submission submission);
+
+        /**
+         * @brief Owner thread: apply or reject the waiting submissions in arrival order.
+         * @param report Told about every submission taken and whether it was applied
+         * @param max Most submissions to take
+         * @return Submissions applied
+         */
+        size_t drain(const std::function<void(const Submission&, bool applied)>& report = {},
+                     size_t max = SIZE_MAX);
+
+        /**
+         * @brief Publish the game to a mirror after every drain that changed it.
+         * @param mirror Mirror to publish to, nullptr to stop; must outlive the inbox
+         */
+        void setMirror(GameMirror* mirror);
+
+        /** @return Decisions applied so far; safe from any thread. */
+        uint32_t version() const;
+
+        /** @return Submissions rejected so far (owner thread). */
+        size_t rejected() const;
+
+    private:
+        TurnPipeline* pipeline;
+        MpscQueue<Submission> queue;
+        std::atomic<uint32_t> decisions{0};
+        size_t stale = 0;
+        GameMirror* mirror = nullptr;
+
+        bool apply(const Submission& submission);
+    };
+} // namespace coup
@@ -0,0 +1,265 @@
+#include "ActionLog.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr size_t FRAMING = 8;              ///< u32 length + u32 checksum
+        constexpr uint32_t MAX_RECORD = 1u << 24;  ///< Anything longer is a corrupt length
+        constexpr char MAGIC[4] = {'C', 'W', 'A', 'L'};
+        constexpr size_t HEADER = 12;              ///< Magic + u64 LSN of the first record
+
+        uint32_t fnv1a(const uint8_t *data, const size_t length) {
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < length; ++i) {
+                hash = (hash ^ data[i]) * 16777619u;
+            }
+            return hash;
+        }
+
+        void putU32(vector<uint8_t> &out, const uint32_t value) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                out.push_back(static_cast<uint8_t>(value >> shift));
+            }
+        }
+
+        uint32_t getU32(const uint8_t *p) {
+            return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        vector<uint8_t> header(const uint64_t base) {
+            vector<uint8_t> out(MAGIC, MAGIC + sizeof(MAGIC));
+            putU32(out, static_cast<uint32_t>(base));
+            putU32(out, static_cast<uint32_t>(base >> 32));
+            return out;
+        }
+
+        bool writeAll(const int fd, const uint8_t *data, const size_t length) {
+            for (size_t done = 0; done < length;) {
+                const ssize_t wrote = write(fd, data + done, length - done);
+                if (wrote > 0) {
+                    done += static_cast<size_t>(wrote);
+                } else if (wrote < 0 && errno != EINTR) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /** @brief Make a rename in the directory holding path durable. */
+        void syncDirectory(const string &path) {
+            const size_t slash = path.rfind('/');
+            const string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+            const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) return;
+            fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    ActionLog::ActionLog(const string &path) : path(path) {
+        uint64_t base = 0;
+        const uint64_t intact = scan(path, [](const uint8_t *, size_t) {}, 0, false, base);
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw runtime_error("Cannot open log " + path + ": " + strerror(errno));
+        }
+        // (Re)write the header of a new file and drop a torn tail so new records do not land behind garbage
+        const vector<uint8_t> head = header(base);
+        const off_t size = static_cast<off_t>(HEADER + (intact - base));
+        if (pwrite(fd, head.data(), head.size(), 0) != static_cast<ssize_t>(head.size()) ||
+            ftruncate(fd, size) < 0 || lseek(fd, size, SEEK_SET) < 0) {
+            const string error = strerror(errno);
+            ::close(fd);
+            throw runtime_error("Cannot open log " + path + ": " + error);
+        }
+        appendedLsn = intact;
+        durableLsn = intact;
+        baseLsn = base;
+        cutRequest = base;
+        flusher = thread([this] { flushLoop(); });
+    }
+
+    ActionLog::~ActionLog() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wakeFlusher.notify_one();
+        flusher.join();
+        ::close(fd);
+    }
+
+    uint64_t ActionLog::append(const vector<uint8_t> &record) {
+        uint64_t lsn;
+        {
+            lock_guard<mutex> guard(lock);
+            putU32(pending, static_cast<uint32_t>(record.size()));
+            pending.insert(pending.end(), record.begin(), record.end());
+            putU32(pending, fnv1a(record.data(), record.size()));
+            lsn = appendedLsn.load(memory_order_relaxed) + record.size() + FRAMING;
+            appendedLsn.store(lsn, memory_order_release);
+        }
+        wakeFlusher.notify_one();
+        return lsn;
+    }
+
+    uint64_t ActionLog::appended() const {
+        return appendedLsn.load(memory_order_acquire);
+    }
+
+    uint64_t ActionLog::durable() const {
+        return durableLsn.load(memory_order_acquire);
+    }
+
+    void ActionLog::truncateBefore(const uint64_t lsn) {
+        {
+            lock_guard<mutex> guard(lock);
+            cutRequest = max(cutRequest, lsn);
+        }
+        wakeFlusher.notify_one();
+    }
+
+    uint64_t ActionLog::firstLsn() const {
+        return baseLsn.load(memory_order_acquire);
+    }
+
+    uint64_t ActionLog::commits() const {
+        return commitCount.load(memory_order_acquire);
+    }
+
+    bool ActionLog::failed() const {
+        return writeFailed.load(memory_order_acquire);
+    }
+
+    void ActionLog::setNotifyFd(const int fd) {
+        notifyFd.store(fd, memory_order_release);
+    }
+
+    void ActionLog::sync() {
+        unique_lock<mutex> guard(lock);
+        const uint64_t target = appendedLsn.load(memory_order_relaxed);
+        committed.wait(guard, [&] { return writeFailed.load() || durableLsn.load(memory_order_acquire) >= target; });
+        if (writeFailed.load()) {
+            throw runtime_error("Action log write failed");
+        }
+    }
+
+    void ActionLog::flushLoop() {
+        vector<uint8_t> batch;
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            wakeFlusher.wait(guard, [&] { return stopping || !pending.empty() || cutRequest > baseLsn; });
+            if (pending.empty() && cutRequest <= baseLsn) break; // stopping with nothing left
+            batch.swap(pending);
+            const uint64_t lsn = appendedLsn.load(memory_order_relaxed);
+            const uint64_t cut = cutRequest;
+            guard.unlock();
+
+            // Appends keep filling `pending` while this batch is written and synced
+            const bool wrote = !batch.empty();
+            bool ok = !wrote || (writeAll(fd, batch.data(), batch.size()) && fdatasync(fd) == 0);
+            batch.clear();
+            const bool cutDone = ok && cut > baseLsn && cutBefore(cut, lsn);
+
+            guard.lock();
+            if (cut > baseLsn && !cutDone && cutRequest == cut) {
+                cutRequest = baseLsn; // keep the longer log; the next checkpoint asks again
+            }
+            if (!wrote) continue;
+            if (ok) {
+                durableLsn.store(lsn, memory_order_release);
+                commitCount.fetch_add(1, memory_order_acq_rel);
+            } else {
+                writeFailed.store(true, memory_order_release);
+            }
+            committed.notify_all();
+            const int notify = notifyFd.load(memory_order_acquire);
+            if (notify >= 0) {
+                const uint64_t one = 1;
+                const ssize_t ignored = write(notify, &one, sizeof(one));
+                (void) ignored;
+            }
+            if (!ok) break;
+        }
+    }
+
+    bool ActionLog::cutBefore(const uint64_t cut, const uint64_t end) {
+        // Everything up to end is written, and only this thread writes the file
+        const uint64_t base = baseLsn.load(memory_order_relaxed);
+        vector<uint8_t> tail(static_cast<size_t>(end - cut));
+        for (size_t done = 0; done < tail.size();) {
+            const ssize_t got = pread(fd, tail.data() + done, tail.size() - done,
+                                      static_cast<off_t>(HEADER + (cut - base) + done));
+            if (got > 0) {
+                done += static_cast<size_t>(got);
+            } else if (got == 0 || errno != EINTR) {
+                return false;
+            }
+        }
+        const string temporary = path + ".tmp";
+        const int next = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (next < 0) return false;
+        const vector<uint8_t> head = header(cut);
+        if (!writeAll(next, head.data(), head.size()) || !writeAll(next, tail.data(), tail.size()) ||
+            fdatasync(next) != 0 || rename(temporary.c_str(), path.c_str()) != 0) {
+            ::close(next);
+            unlink(temporary.c_str());
+            return false;
+        }
+        syncDirectory(path);
+        ::close(fd);
+        fd = next; // positioned at its end
+        baseLsn.store(cut, memory_order_release);
+        return true;
+    }
+
+    uint64_t ActionLog::replay(const string &path, const function<void(const uint8_t *, size_t)> &visit,
+                               const uint64_t from) {
+        uint64_t base = 0;
+        return scan(path, visit, from, true, base);
+    }
+
+    uint64_t ActionLog::scan(const string &path, const function<void(const uint8_t *, size_t)> &visit,
+                             const uint64_t from, const bool exact, uint64_t &base) {
+        base = 0;
+        ifstream in(path, ios::binary);
+        if (!in) return 0;
+        uint8_t head[HEADER];
+        if (!in.read(reinterpret_cast<char *>(head), HEADER)) return 0; // created but never committed
+        if (memcmp(head, MAGIC, sizeof(MAGIC)) != 0) {
+            throw runtime_error("Not an action log: " + path);
+        }
+        base = getU32(head + 4) | static_cast<uint64_t>(getU32(head + 8)) << 32;
+        if (exact && from < base) {
+            throw InitError("Log " + path + " starts after the records it should replay");
+        }
+        // An LSN is a byte offset, so the first record to replay is found without reading the ones before it
+        const uint64_t start = max(from, base);
+        in.seekg(static_cast<streamoff>(HEADER + (start - base)));
+        const vector<uint8_t> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        size_t pos = 0;
+        while (bytes.size() - pos >= FRAMING) {
+            const uint32_t length = getU32(bytes.data() + pos);
+            if (length > MAX_RECORD || bytes.size() - pos - FRAMING < length) break;
+            const uint8_t *payload = bytes.data() + pos + 4;
+            if (getU32(payload + length) != fnv1a(payload, length)) break;
+            pos += FRAMING + length;
+            visit(payload, length);
+        }
+        return start + pos;
+    }
+} // namespace coup
+
+#endif // __linux__
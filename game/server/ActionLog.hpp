@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace coup {
+    /**
+     * @class ActionLog
+     * @brief Append-only write-ahead log with group commit (Linux).
+     *
+     * append() only copies the record into memory and returns its log sequence
+     * number (LSN: the bytes ever logged once it is written). A background thread writes
+     * everything gathered so far and makes it durable with one fdatasync, so
+     * while one batch is syncing the next one fills up: many records cost one
+     * sync. Callers hold back effects (replies) until durable() reaches the LSN.
+     *
+     * The file starts with "CWAL" and the u64 LSN of its first record, so byte
+     * offsets map straight to LSNs. Each record is u32 length, payload and a u32
+     * FNV-1a checksum of the payload; a torn or corrupt tail left by a crash is
+     * cut off on open. Once a checkpoint covers a prefix, truncateBefore() has the
+     * flusher copy the remaining tail into a fresh file that replaces the log, so
+     * disk use and replay stay bounded by the records since the last checkpoint.
+     */
+    class ActionLog {
+    public:
+        /**
+         * @brief Open (or create) a log for appending.
+         * @throws std::runtime_error if the file cannot be opened
+         */
+        explicit ActionLog(const std::string& path);
+
+        /** @brief Makes everything appended durable before closing. */
+        ~ActionLog();
+
+        ActionLog(const ActionLog&) = delete;
+        ActionLog& operator=(const ActionLog&) = delete;
+
+        /**
+         * @brief Queue one record.
+         * @return LSN that durable() must reach for the record to be safe
+         */
+        uint64_t append(const std::vector<uint8_t>& record);
+
+        /** @return LSN of the last appended record. */
+        uint64_t appended() const;
+
+        /** @return Everything up to this LSN is on stable storage. */
+        uint64_t durable() const;
+
+        /** @return Batches written so far; each cost one sync. */
+        uint64_t commits() const;
+
+        /**
+         * @return True once a write or sync has failed; durable() stops advancing for good
+         */
+        bool failed() const;
+
+        /**
+         * @brief Drop the records before lsn once they are durable; done by the flusher.
+         * @param lsn A record boundary at or below durable(), covered by a checkpoint on stable storage
+         */
+        void truncateBefore(uint64_t lsn);
+
+        /** @return LSN of the first record still in the file. */
+        uint64_t firstLsn() const;
+
+        /**
+         * @brief Have the flusher write 8 bytes to an eventfd after every commit.
+         */
+        void setNotifyFd(int fd);
+
+        /**
+         * @brief Block until everything appended so far is durable.
+         * @throws std::runtime_error if a write or sync failed
+         */
+        void sync();
+
+        /**
+         * @brief Read every intact record of a log, in order.
+         *
+         * Seeks straight to from, so records a checkpoint covers are never read.
+         * @param visit Called with each record's payload
+         * @param from Skip records before this LSN (already in a checkpoint); must be a record boundary
+         * @return LSN after the last intact record (0 for a missing file)
+         * @throws InitError if the log was cut past from, so records after it are gone
+         * @throws std::runtime_error if the file is not an action log
+         */
+        static uint64_t replay(const std::string& path,
+                               const std::function<void(const uint8_t*, size_t)>& visit,
+                               uint64_t from = 0);
+
+    private:
+        std::string path;
+        int fd = -1;
+        std::atomic<int> notifyFd{-1};
+        std::mutex lock;
+        std::condition_variable wakeFlusher;
+        std::condition_variable committed;
+        std::vector<uint8_t> pending;   ///< Bytes appended but not yet handed to the flusher
+        std::atomic<uint64_t> appendedLsn{0};
+        std::atomic<uint64_t> durableLsn{0};
+        std::atomic<uint64_t> commitCount{0};
+        std::atomic<uint64_t> baseLsn{0};  ///< LSN of the file's first record; changed by the flusher only
+        uint64_t cutRequest = 0;           ///< truncateBefore() target not yet done
+        bool stopping = false;
+        std::atomic<bool> writeFailed{false};
+        std::thread flusher;
+
+        void flushLoop();
+        bool cutBefore(uint64_t cut, uint64_t end);
+        /** @brief replay(); with exact unset it starts at the first record instead of rejecting an early from. */
+        static uint64_t scan(const std::string& path, const std::function<void(const uint8_t*, size_t)>& visit,
+                             uint64_t from, bool exact, uint64_t& base);
+    };
+} // namespace coup
@@ -0,0 +1,539 @@
+#include "Coordinator.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr int MAX_EVENTS = 256;
+        constexpr size_t READ_CHUNK = 64 * 1024;
+        constexpr size_t MAX_PENDING = 4 * 1024 * 1024; ///< Drop clients that stop reading
+        constexpr size_t MAX_IOV = 64;
+        constexpr int ENGINE_TIMEOUT_MS = 5000;        ///< Longest wait for an engine during a move
+
+        runtime_error systemError(const string &what) {
+            return runtime_error(what + ": " + strerror(errno));
+        }
+
+        /** @brief Re-frame a body received inside a Relay frame. */
+        vector<uint8_t> framed(const uint8_t *body, const size_t length) {
+            vector<uint8_t> frame{static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8)};
+            frame.insert(frame.end(), body, body + length);
+            return frame;
+        }
+    }
+
+    Coordinator::Coordinator() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            throw systemError("epoll_create1");
+        }
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) {
+            ::close(epollFd);
+            throw systemError("eventfd");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+    }
+
+    Coordinator::~Coordinator() {
+        for (auto &entry: peers) {
+            ::close(entry.first);
+        }
+        for (const int fd: listeners) {
+            ::close(fd);
+        }
+        for (const string &path: unixPaths) {
+            unlink(path.c_str());
+        }
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+
+    //------------------------------------------------------------------------------
+    // Listening
+    //------------------------------------------------------------------------------
+
+    void Coordinator::addListener(const int fd) {
+        if (listen(fd, SOMAXCONN) < 0) {
+            const runtime_error error = systemError("listen");
+            ::close(fd);
+            throw error;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        listeners.push_back(fd);
+    }
+
+    uint16_t Coordinator::listenTcp(const uint16_t port) {
+        const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw systemError("socket");
+        }
+        const int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            const runtime_error error = systemError("bind");
+            ::close(fd);
+            throw error;
+        }
+        socklen_t length = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &length);
+        addListener(fd);
+        return ntohs(addr.sin_port);
+    }
+
+    void Coordinator::listenUnix(const string &path) {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw runtime_error("Unix socket path too long: " + path);
+        }
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw systemError("socket");
+        }
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            const runtime_error error = systemError("bind " + path);
+            ::close(fd);
+            throw error;
+        }
+        addListener(fd);
+        unixPaths.push_back(path);
+    }
+
+    void Coordinator::acceptAll(const int listener) {
+        while (true) {
+            const int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            const int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly on Unix sockets
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            Peer &client = peers[fd];
+            client.fd = fd;
+            client.client = nextClient++;
+            clientFds[client.client] = fd;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Engines
+    //------------------------------------------------------------------------------
+
+    size_t Coordinator::addEngine(const string &path) {
+        if (engineFds.count(path)) return 0;
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw runtime_error("Unix socket path too long: " + path);
+        }
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw systemError("socket");
+        }
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            const runtime_error error = systemError("connect " + path);
+            ::close(fd);
+            throw error;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        Peer &engine = peers[fd];
+        engine.fd = fd;
+        engine.engine = path;
+        engineFds[path] = fd;
+        ring.add(path);
+        return rebalance();
+    }
+
+    size_t Coordinator::removeEngine(const string &path) {
+        const auto it = engineFds.find(path);
+        if (it == engineFds.end()) return 0;
+        ring.remove(path);
+        if (ring.size() == 0) {
+            for (const auto &entry: placed) {
+                if (entry.second.engine != path) continue;
+                ring.add(path);
+                throw runtime_error("Cannot remove the last engine while it holds tables");
+            }
+        }
+        const size_t moved = rebalance();
+        close(peers[it->second]);
+        return moved;
+    }
+
+    size_t Coordinator::engineCount() const {
+        return engineFds.size();
+    }
+
+    string Coordinator::ownerOf(const uint32_t table) const {
+        const auto it = placed.find(table);
+        return it == placed.end() ? string() : it->second.engine;
+    }
+
+    size_t Coordinator::tableCount() const {
+        return placed.size();
+    }
+
+    size_t Coordinator::rebalance() {
+        vector<uint32_t> moving;
+        for (const auto &entry: placed) {
+            if (ring.owner(entry.first) != entry.second.engine) moving.push_back(entry.first);
+        }
+        sort(moving.begin(), moving.end());
+        size_t moved = 0;
+        for (const uint32_t table: moving) {
+            if (migrate(table, placed[table], ring.owner(table))) ++moved;
+        }
+        flushDirty();
+        return moved;
+    }
+
+    bool Coordinator::migrate(const uint32_t table, Placement &placement, const string &to) {
+        Peer &source = peers[engineFds.at(placement.engine)];
+        Peer &target = peers[engineFds.at(to)];
+        const vector<uint8_t> image = exchange(source, wire::FrameWriter(wire::Op::Export).u32(table).finish());
+        if (static_cast<wire::Op>(image[0]) != wire::Op::Image) {
+            if (image.size() > 1 && image[1] == static_cast<uint8_t>(wire::ErrorCode::NoTable)) {
+                placed.erase(table); // the game finished and its engine already let it go
+                return false;
+            }
+            throw runtime_error("Engine " + placement.engine + " would not export table " + to_string(table));
+        }
+        const vector<uint8_t> import = wire::FrameWriter(wire::Op::Import).u32(table)
+                .raw(image.data() + 1, image.size() - 1).finish();
+        bool imported = false;
+        try {
+            imported = static_cast<wire::Op>(exchange(target, import)[0]) == wire::Op::Ok;
+        } catch (const runtime_error &) {
+        }
+        if (!imported) {
+            // The export already removed the table: hand the image back so the game is not lost
+            if (static_cast<wire::Op>(exchange(source, import)[0]) != wire::Op::Ok) {
+                placed.erase(table);
+                throw runtime_error("Table " + to_string(table) + " was lost moving to engine " + to);
+            }
+        } else {
+            placement.engine = to;
+        }
+        // Replay the joins: the engine now holding the table binds the same seats and sends each watcher a Snapshot
+        for (const auto &join: placement.joins) {
+            relay(join.first, placement.engine, wire::FrameWriter(wire::Op::Join).u32(table).u8(join.second).finish());
+        }
+        if (!imported) {
+            throw runtime_error("Engine " + to + " refused table " + to_string(table) + ", which stays on " +
+                                placement.engine);
+        }
+        return true;
+    }
+
+    vector<uint8_t> Coordinator::exchange(Peer &engine, vector<uint8_t> request) {
+        queue(engine, move(request));
+        const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(ENGINE_TIMEOUT_MS);
+        const auto await = [&](const short events) {
+            const auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            pollfd p{engine.fd, events, 0};
+            if (left.count() <= 0 || ::poll(&p, 1, static_cast<int>(left.count())) <= 0) {
+                throw runtime_error("Engine " + engine.engine + " did not answer");
+            }
+        };
+        while (!engine.out.empty()) {
+            flush(engine);
+            if (engine.closing) throw runtime_error("Engine " + engine.engine + " went away");
+            if (!engine.out.empty()) await(POLLOUT);
+        }
+        while (true) {
+            // Relayed frames queued before the reply still go to their clients, in order
+            size_t body;
+            while ((body = wire::completeFrame(engine.in.data(), engine.in.size())) > 0) {
+                const uint8_t *start = engine.in.data() + wire::HEADER;
+                vector<uint8_t> reply;
+                if (static_cast<wire::Op>(start[0]) == wire::Op::Relay) {
+                    fromEngine(start, body);
+                } else {
+                    reply.assign(start, start + body);
+                }
+                engine.in.erase(engine.in.begin(), engine.in.begin() + static_cast<ptrdiff_t>(wire::HEADER + body));
+                if (!reply.empty()) return reply;
+            }
+            await(POLLIN);
+            if (!receive(engine)) throw runtime_error("Engine " + engine.engine + " went away");
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Traffic
+    //------------------------------------------------------------------------------
+
+    bool Coordinator::receive(Peer &peer) {
+        uint8_t chunk[READ_CHUNK];
+        while (true) {
+            const ssize_t got = recv(peer.fd, chunk, sizeof(chunk), 0);
+            if (got > 0) {
+                peer.in.insert(peer.in.end(), chunk, chunk + got);
+                if (peer.engine.empty() && peer.in.size() > MAX_PENDING) return false;
+                continue;
+            }
+            if (got < 0 && errno == EINTR) continue;
+            return got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+
+    void Coordinator::takeFrames(Peer &peer) {
+        size_t used = 0;
+        try {
+            size_t body;
+            while ((body = wire::completeFrame(peer.in.data() + used, peer.in.size() - used)) > 0) {
+                const uint8_t *start = peer.in.data() + used + wire::HEADER;
+                if (peer.engine.empty()) {
+                    fromClient(peer, start, body);
+                } else if (static_cast<wire::Op>(start[0]) == wire::Op::Relay) {
+                    fromEngine(start, body);
+                }
+                used += wire::HEADER + body;
+            }
+        } catch (const ProtocolError &e) {
+            queue(peer, wire::errorFrame(wire::ErrorCode::Malformed, e.what()));
+            peer.closing = true;
+            used = peer.in.size();
+        }
+        peer.in.erase(peer.in.begin(), peer.in.begin() + static_cast<ptrdiff_t>(used));
+    }
+
+    void Coordinator::fromClient(Peer &client, const uint8_t *body, const size_t length) {
+        using wire::Op;
+        wire::FrameReader in(body, length);
+        const Op op = in.op();
+        if (op == Op::Create) {
+            const int seats = in.u8();
+            const uint8_t randomRoles = in.u8();
+            if (seats < 2 || seats > 6) {
+                queue(client, wire::errorFrame(wire::ErrorCode::Illegal, "Tables need 2 to 6 seats"));
+                return;
+            }
+            if (ring.size() == 0) {
+                queue(client, wire::errorFrame(wire::ErrorCode::Illegal, "No engines"));
+                return;
+            }
+            const uint32_t table = nextTable++;
+            Placement &placement = placed[table];
+            placement.engine = ring.owner(table);
+            relay(client.client, placement.engine,
+                  wire::FrameWriter(Op::Place).u32(table).u8(static_cast<uint8_t>(seats)).u8(randomRoles).finish());
+            return;
+        }
+        if (op != Op::Join && op != Op::Act && op != Op::Block && op != Op::State && op != Op::Leave &&
+            op != Op::Ack) {
+            throw ProtocolError("Not a client request");
+        }
+        const uint32_t table = in.u32();
+        const auto it = placed.find(table);
+        if (it == placed.end()) {
+            queue(client, wire::errorFrame(wire::ErrorCode::NoTable, "No table " + to_string(table)));
+            return;
+        }
+        auto &joins = it->second.joins;
+        if (op == Op::Join) {
+            const auto join = make_pair(client.client, in.u8());
+            if (find(joins.begin(), joins.end(), join) == joins.end()) joins.push_back(join);
+            if (find(client.tables.begin(), client.tables.end(), table) == client.tables.end()) {
+                client.tables.push_back(table);
+            }
+        } else if (op == Op::Leave) {
+            const uint32_t id = client.client;
+            joins.erase(remove_if(joins.begin(), joins.end(),
+                                  [id](const pair<uint32_t, uint8_t> &j) { return j.first == id; }), joins.end());
+        }
+        relay(client.client, it->second.engine, body, length);
+    }
+
+    void Coordinator::fromEngine(const uint8_t *body, const size_t length) {
+        wire::FrameReader in(body, length);
+        const auto it = clientFds.find(in.u32());
+        if (it == clientFds.end() || in.remaining() == 0) return; // the client left meanwhile
+        queue(peers[it->second], framed(body + 5, length - 5));
+    }
+
+    void Coordinator::relay(const uint32_t client, const string &engine, const uint8_t *body, const size_t length) {
+        const auto it = engineFds.find(engine);
+        if (it == engineFds.end()) return;
+        queue(peers[it->second], wire::FrameWriter(wire::Op::Relay).u32(client).raw(body, length).finish());
+    }
+
+    void Coordinator::relay(const uint32_t client, const string &engine, const vector<uint8_t> &request) {
+        relay(client, engine, request.data() + wire::HEADER, request.size() - wire::HEADER);
+    }
+
+    void Coordinator::queue(Peer &peer, vector<uint8_t> frame) {
+        if (peer.closing) return;
+        if (peer.engine.empty() && peer.out.bytes() + frame.size() > MAX_PENDING) {
+            peer.closing = true;
+            return;
+        }
+        if (peer.out.empty() && !peer.writeArmed) dirty.push_back(peer.fd);
+        peer.out.push(make_shared<const vector<uint8_t>>(move(frame)), 0);
+    }
+
+    void Coordinator::flush(Peer &peer) {
+        iovec iov[MAX_IOV];
+        while (!peer.out.empty()) {
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = peer.out.gather(iov, MAX_IOV);
+            const ssize_t sent = sendmsg(peer.fd, &message, MSG_NOSIGNAL);
+            if (sent > 0) {
+                peer.out.consume(static_cast<size_t>(sent));
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            peer.closing = true;
+            return;
+        }
+        const bool pending = !peer.out.empty();
+        if (pending != peer.writeArmed) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP | (pending ? EPOLLOUT : 0u);
+            ev.data.fd = peer.fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, peer.fd, &ev);
+            peer.writeArmed = pending;
+        }
+    }
+
+    void Coordinator::flushDirty() {
+        for (const int fd: dirty) {
+            const auto it = peers.find(fd);
+            if (it != peers.end() && !it->second.writeArmed) flush(it->second);
+        }
+        dirty.clear();
+    }
+
+    void Coordinator::close(Peer &peer) {
+        const int fd = peer.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        if (peer.engine.empty()) {
+            const uint32_t id = peer.client;
+            for (const uint32_t table: peer.tables) {
+                const auto it = placed.find(table);
+                if (it == placed.end()) continue;
+                auto &joins = it->second.joins;
+                joins.erase(remove_if(joins.begin(), joins.end(),
+                                      [id](const pair<uint32_t, uint8_t> &j) { return j.first == id; }), joins.end());
+            }
+            for (const auto &engine: engineFds) {
+                queue(peers[engine.second], wire::FrameWriter(wire::Op::Gone).u32(id).finish());
+            }
+            clientFds.erase(id);
+        } else {
+            // Tables still placed here were lost with the engine (a removed engine has none left)
+            const string engine = peer.engine;
+            for (auto it = placed.begin(); it != placed.end();) {
+                it = it->second.engine == engine ? placed.erase(it) : next(it);
+            }
+            ring.remove(engine);
+            engineFds.erase(engine);
+        }
+        peers.erase(fd);
+    }
+
+    //------------------------------------------------------------------------------
+    // Loop
+    //------------------------------------------------------------------------------
+
+    int Coordinator::poll(const int timeoutMs) {
+        epoll_event events[MAX_EVENTS];
+        const int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        if (count < 0) {
+            return 0; // EINTR
+        }
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                uint64_t drained;
+                while (read(wakeFd, &drained, sizeof(drained)) > 0) {
+                }
+                continue;
+            }
+            if (find(listeners.begin(), listeners.end(), fd) != listeners.end()) {
+                acceptAll(fd);
+                continue;
+            }
+            const auto it = peers.find(fd);
+            if (it == peers.end() || it->second.closing) continue;
+            Peer &peer = it->second;
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                if (!receive(peer)) peer.closing = true;
+                takeFrames(peer);
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush(peer);
+            }
+        }
+        flushDirty();
+
+        // Close at the end so no handler ever sees a peer vanish under it
+        vector<int> closing;
+        for (const auto &entry: peers) {
+            if (entry.second.closing) closing.push_back(entry.first);
+        }
+        for (const int fd: closing) {
+            close(peers[fd]);
+        }
+        if (!closing.empty()) flushDirty(); // Gone notices for the engines
+        return count;
+    }
+
+    void Coordinator::run() {
+        while (!stopping.load(memory_order_acquire)) {
+            poll(-1);
+        }
+        stopping.store(false, memory_order_release);
+    }
+
+    void Coordinator::stop() {
+        stopping.store(true, memory_order_release);
+        const uint64_t one = 1;
+        const ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void) ignored;
+    }
+} // namespace coup
+
+#endif // __linux__
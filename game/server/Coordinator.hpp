@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "HashRing.hpp"
+#include "OutQueue.hpp"
+#include "Protocol.hpp"
+
+namespace coup {
+    /**
+     * @class Coordinator
+     * @brief Front end of a local cluster: clients connect here, tables live in engine processes (Linux).
+     *
+     * Engines are GameServers listening on Unix control sockets. Table ids are handed
+     * out here and placed on engines by a HashRing, so adding or removing an
+     * engine only moves the tables on the arcs that change hands. Each client
+     * request travels to the owning engine over one connection per engine,
+     * wrapped in a Relay frame naming the client; replies come back the same way.
+     *
+     * A table moves by snapshot and replay: the old engine exports it (which
+     * also removes it there), the new one imports the image, and the seats and
+     * watches forwarded so far are joined again for their clients, who receive
+     * a fresh Snapshot. If the new engine refuses the image or does not
+     * answer, the old one imports it back and keeps the table. Since
+     * everything for one engine shares one stream, an export is handled after
+     * every request forwarded before it. Moves run on the loop thread; an
+     * engine that dies only takes its own tables with it. One loop runs on
+     * one thread; stop() may be called from any thread.
+     */
+    class Coordinator {
+    public:
+        /**
+         * @throws std::runtime_error if epoll or the wake-up eventfd cannot be created
+         */
+        Coordinator();
+        ~Coordinator();
+
+        Coordinator(const Coordinator&) = delete;
+        Coordinator& operator=(const Coordinator&) = delete;
+
+        /**
+         * @brief Listen for clients on 127.0.0.1.
+         * @param port Port to bind, 0 for any free port
+         * @return The bound port
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        uint16_t listenTcp(uint16_t port);
+
+        /**
+         * @brief Listen for clients on a Unix stream socket.
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        void listenUnix(const std::string& path);
+
+        /**
+         * @brief Connect an engine and move in the tables the ring now gives it.
+         *
+         * Call while the loop is stopped or from the loop thread.
+         * @param path Unix socket the engine's GameServer listens on (GameServer::listenControl)
+         * @return Tables moved
+         * @throws std::runtime_error if the engine cannot be reached or a move fails
+         */
+        size_t addEngine(const std::string& path);
+
+        /**
+         * @brief Move an engine's tables to the others, then disconnect it.
+         *
+         * Call while the loop is stopped or from the loop thread.
+         * @return Tables moved
+         * @throws std::runtime_error if it is the last engine and still holds tables
+         */
+        size_t removeEngine(const std::string& path);
+
+        size_t engineCount() const;
+
+        /** @return Engine holding a table, empty if the table is unknown. */
+        std::string ownerOf(uint32_t table) const;
+
+        size_t tableCount() const;
+
+        /**
+         * @brief Wait up to timeoutMs for events and handle everything that is ready.
+         * @return Number of events handled
+         */
+        int poll(int timeoutMs);
+
+        /**
+         * @brief Run the loop until stop() is called.
+         */
+        void run();
+
+        /**
+         * @brief Ask run() to return; safe from any thread.
+         */
+        void stop();
+
+    private:
+        struct Peer {
+            int fd = -1;
+            uint32_t client = 0;            ///< Client id, 0 for an engine
+            std::string engine;             ///< Engine socket path, empty for a client
+            std::vector<uint8_t> in;        ///< Bytes received but not yet framed
+            OutQueue out;
+            std::vector<uint32_t> tables;   ///< Tables a client joined
+            bool writeArmed = false;
+            bool closing = false;
+        };
+
+        struct Placement {
+            std::string engine;
+            std::vector<std::pair<uint32_t, uint8_t>> joins; ///< (client, seat) to join again after a move
+        };
+
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::vector<int> listeners;
+        std::vector<std::string> unixPaths;
+        std::unordered_map<int, Peer> peers;               ///< Clients and engines by fd
+        std::unordered_map<uint32_t, int> clientFds;
+        std::unordered_map<std::string, int> engineFds;
+        std::unordered_map<uint32_t, Placement> placed;    ///< Every table handed out, by id
+        std::vector<int> dirty;                            ///< Fds with frames queued since the last flush
+        HashRing ring;
+        uint32_t nextTable = 1;
+        uint32_t nextClient = 1;
+        std::atomic<bool> stopping{false};
+
+        void addListener(int fd);
+        void acceptAll(int listener);
+        bool receive(Peer& peer);
+        void takeFrames(Peer& peer);
+        void fromClient(Peer& client, const uint8_t* body, size_t length);
+        void fromEngine(const uint8_t* body, size_t length);
+        void relay(uint32_t client, const std::string& engine, const uint8_t* body, size_t length);
+        void relay(uint32_t client, const std::string& engine, const std::vector<uint8_t>& request);
+        void queue(Peer& peer, std::vector<uint8_t> frame);
+        void flush(Peer& peer);
+        void flushDirty();
+        void close(Peer& peer);
+
+        size_t rebalance();
+        bool migrate(uint32_t table, Placement& placement, const std::string& to);
+        std::vector<uint8_t> exchange(Peer& engine, std::vector<uint8_t> request);
+    };
+} // namespace coup
@@ -0,0 +1,646 @@
+#include "GameServer.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr int MAX_EVENTS = 256;
+        constexpr size_t READ_CHUNK = 64 * 1024;
+        constexpr size_t MAX_PENDING = 4 * 1024 * 1024; ///< Drop clients that stop reading
+        constexpr size_t MAX_IOV = 64;                  ///< Frames per writev
+
+        runtime_error systemError(const string &what) {
+            return runtime_error(what + ": " + strerror(errno));
+        }
+
+        void syncDirectory(const string &path) {
+            const size_t slash = path.rfind('/');
+            const string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+            const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) return;
+            fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    GameServer::GameServer() : GameServer(nullptr, 0) {
+    }
+
+    GameServer::GameServer(ShardMesh *mesh, const size_t shardIndex)
+        : tables(static_cast<uint32_t>(shardIndex + 1), mesh ? static_cast<uint32_t>(mesh->size()) : 1),
+          mesh(mesh), shardIndex(shardIndex), started(std::chrono::steady_clock::now()) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            throw systemError("epoll_create1");
+        }
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) {
+            ::close(epollFd);
+            throw systemError("eventfd");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+        if (mesh) {
+            mesh->setWakeFd(shardIndex, wakeFd);
+            backlog.resize(mesh->size());
+        }
+    }
+
+    GameServer::~GameServer() {
+        if (checkpointChild > 0 || checkpointWritten) {
+            // Finish the image in progress rather than leave a child or a stray temporary behind
+            try {
+                log->sync();
+            } catch (const exception &) {
+            }
+            reapCheckpoint(true);
+        }
+        log.reset(); // its flusher writes to wakeFd
+        for (auto &entry: connections) {
+            ::close(entry.first);
+        }
+        for (const int fd: listeners) {
+            ::close(fd);
+        }
+        for (const string &path: unixPaths) {
+            unlink(path.c_str());
+        }
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+
+    //------------------------------------------------------------------------------
+    // Listening
+    //------------------------------------------------------------------------------
+
+    void GameServer::addListener(const int fd) {
+        if (listen(fd, SOMAXCONN) < 0) {
+            const runtime_error error = systemError("listen");
+            ::close(fd);
+            throw error;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        listeners.push_back(fd);
+    }
+
+    uint16_t GameServer::listenTcp(const uint16_t port) {
+        const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw systemError("socket");
+        }
+        const int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (mesh) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)); // every shard binds the same port
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            const runtime_error error = systemError("bind");
+            ::close(fd);
+            throw error;
+        }
+        socklen_t length = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &length);
+        addListener(fd);
+        return ntohs(addr.sin_port);
+    }
+
+    void GameServer::listenUnix(const string &path) {
+        addListener(bindUnix(path));
+        unixPaths.push_back(path);
+    }
+
+    void GameServer::listenControl(const string &path) {
+        const int fd = bindUnix(path);
+        addListener(fd);
+        unixPaths.push_back(path);
+        controlListeners.push_back(fd);
+    }
+
+    int GameServer::bindUnix(const string &path) {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw runtime_error("Unix socket path too long: " + path);
+        }
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw systemError("socket");
+        }
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            const runtime_error error = systemError("bind " + path);
+            ::close(fd);
+            throw error;
+        }
+        return fd;
+    }
+
+    void GameServer::acceptAll(const int listener) {
+        while (true) {
+            const int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return; // EAGAIN, or a client that vanished before we got to it
+            const int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly on Unix sockets
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            Connection &conn = connections[fd];
+            conn.fd = fd;
+            conn.control = find(controlListeners.begin(), controlListeners.end(), listener) != controlListeners.end();
+            conn.id = nextConnection++ * (mesh ? mesh->size() : 1) + shardIndex;
+            connectionFds[conn.id] = fd;
+        }
+    }
+
+    size_t GameServer::openLog(const string &path) {
+        checkpointPath = path + ".ckpt";
+        ifstream image(checkpointPath, ios::binary);
+        if (image) {
+            const vector<uint8_t> bytes((istreambuf_iterator<char>(image)), istreambuf_iterator<char>());
+            savedLsn = tables.restore(bytes.data(), bytes.size());
+        }
+        size_t records = 0;
+        const uint64_t end = ActionLog::replay(path, [&](const uint8_t *record, const size_t length) {
+            tables.replay(record, length);
+            ++records;
+        }, savedLsn);
+        if (end < savedLsn) {
+            throw InitError("Log " + path + " ends before its checkpoint");
+        }
+        log = make_unique<ActionLog>(path);
+        log->truncateBefore(savedLsn); // in case the last run stopped between the image and the cut
+        log->setNotifyFd(wakeFd);
+        ActionLog *journal = log.get();
+        tables.setJournal([journal](const vector<uint8_t> &record) { journal->append(record); });
+        lastCheckpoint = chrono::steady_clock::now();
+        return records;
+    }
+
+    //------------------------------------------------------------------------------
+    // Checkpoints
+    //------------------------------------------------------------------------------
+
+    bool GameServer::checkpoint() {
+        if (!log || checkpointPending()) return false;
+        const uint64_t lsn = log->appended();
+        const pid_t child = fork();
+        if (child < 0) {
+            throw systemError("fork");
+        }
+        if (child == 0) {
+            // Only this thread exists in the child: serialize, write and leave without running destructors
+            int status = 1;
+            try {
+                const vector<uint8_t> bytes = tables.checkpoint(lsn);
+                const string temporary = checkpointPath + ".tmp";
+                const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd >= 0) {
+                    size_t done = 0;
+                    while (done < bytes.size()) {
+                        const ssize_t wrote = write(fd, bytes.data() + done, bytes.size() - done);
+                        if (wrote > 0) {
+                            done += static_cast<size_t>(wrote);
+                        } else if (wrote < 0 && errno != EINTR) {
+                            break;
+                        }
+                    }
+                    if (done == bytes.size() && fsync(fd) == 0) status = 0;
+                    ::close(fd);
+                }
+            } catch (const exception &) {
+            }
+            _exit(status);
+        }
+        checkpointChild = child;
+        checkpointLsn = lsn;
+        lastCheckpoint = chrono::steady_clock::now();
+        return true;
+    }
+
+    void GameServer::reapCheckpoint(const bool wait) {
+        if (checkpointChild > 0) {
+            int status = 0;
+            pid_t done;
+            while ((done = waitpid(checkpointChild, &status, wait ? 0 : WNOHANG)) < 0 && errno == EINTR) {
+            }
+            if (done == 0) return; // still writing
+            checkpointChild = -1;
+            checkpointWritten = done > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+        // The image may hold changes whose records are still in flight; putting it in place
+        // first would let recovery start past the end of the log
+        if (checkpointWritten && log->durable() >= checkpointLsn) {
+            const string temporary = checkpointPath + ".tmp";
+            if (rename(temporary.c_str(), checkpointPath.c_str()) == 0) {
+                syncDirectory(checkpointPath); // the image must survive a crash before the log loses its records
+                savedLsn = checkpointLsn;
+                log->truncateBefore(savedLsn);
+            }
+            checkpointWritten = false;
+        }
+    }
+
+    int GameServer::pollCheckpoint(int timeoutMs) {
+        if (checkpointPending()) {
+            reapCheckpoint(false);
+        } else if (checkpointIntervalMs > 0 && log->appended() > savedLsn) {
+            const auto due = lastCheckpoint + chrono::milliseconds(checkpointIntervalMs);
+            const auto now = chrono::steady_clock::now();
+            if (now >= due) {
+                checkpoint();
+            } else {
+                const int wait = static_cast<int>(chrono::duration_cast<chrono::milliseconds>(due - now).count()) + 1;
+                timeoutMs = timeoutMs < 0 ? wait : min(timeoutMs, wait);
+            }
+        }
+        if (checkpointPending()) {
+            const int tick = static_cast<int>(TableHost::CLOCK_TICK_MS);
+            timeoutMs = timeoutMs < 0 ? tick : min(timeoutMs, tick); // look for the child to finish
+        }
+        return timeoutMs;
+    }
+
+    void GameServer::setCheckpointInterval(const int intervalMs) {
+        checkpointIntervalMs = max(0, intervalMs);
+    }
+
+    bool GameServer::checkpointPending() const {
+        return checkpointChild > 0 || checkpointWritten;
+    }
+
+    uint64_t GameServer::checkpointedLsn() const {
+        return savedLsn;
+    }
+
+    //------------------------------------------------------------------------------
+    // Connections
+    //------------------------------------------------------------------------------
+
+    void GameServer::readFrom(Connection &conn) {
+        uint8_t chunk[READ_CHUNK];
+        while (true) {
+            const ssize_t got = recv(conn.fd, chunk, sizeof(chunk), 0);
+            if (got > 0) {
+                conn.in.insert(conn.in.end(), chunk, chunk + got);
+                if (conn.in.size() > MAX_PENDING) {
+                    conn.closing = true;
+                    break;
+                }
+                continue;
+            }
+            if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                conn.closing = true;
+            }
+            if (got < 0 && errno == EINTR) continue;
+            break;
+        }
+
+        size_t used = 0;
+        try {
+            size_t body;
+            while ((body = wire::completeFrame(conn.in.data() + used, conn.in.size() - used)) > 0) {
+                route(conn.id, conn.in.data() + used + wire::HEADER, body);
+                used += wire::HEADER + body;
+            }
+        } catch (const ProtocolError &e) {
+            send(conn.id, wire::errorFrame(wire::ErrorCode::Malformed, e.what()));
+            conn.closing = true;
+            used = conn.in.size();
+        }
+        conn.in.erase(conn.in.begin(), conn.in.begin() + static_cast<ptrdiff_t>(used));
+    }
+
+    void GameServer::push(const ConnectionId connection, Frame frame, const uint32_t stream) {
+        if (log && (!held.empty() || log->durable() < log->appended())) {
+            held.push_back(HeldFrame{log->appended(), connection, move(frame), stream});
+            return;
+        }
+        deliver(connection, move(frame), stream);
+    }
+
+    void GameServer::releaseDurable() {
+        const uint64_t durable = log->durable();
+        while (!held.empty() && held.front().lsn <= durable) {
+            HeldFrame &next = held.front();
+            deliver(next.connection, move(next.frame), next.stream);
+            held.pop_front();
+        }
+    }
+
+    void GameServer::deliver(const ConnectionId connection, Frame frame, const uint32_t stream) {
+        if (mesh && mesh->connectionOwner(connection) != shardIndex) {
+            post(mesh->connectionOwner(connection),
+                 ShardMessage{ShardMessage::Kind::Reply, connection, {}, move(frame), stream});
+            return;
+        }
+        const auto relay = relayed.find(connection);
+        if (relay != relayed.end()) {
+            // One coordinator connection carries many clients, so relayed frames never coalesce
+            const vector<uint8_t> &inner = *frame;
+            vector<uint8_t> wrapped = wire::FrameWriter(wire::Op::Relay).u32(relay->second.client)
+                    .raw(inner.data() + wire::HEADER, inner.size() - wire::HEADER).finish();
+            deliver(relay->second.via, make_shared<const vector<uint8_t>>(move(wrapped)), 0);
+            return;
+        }
+        const auto it = connectionFds.find(connection);
+        if (it == connectionFds.end()) return;
+        Connection &conn = connections[it->second];
+        if (conn.closing) return;
+        if (conn.out.bytes() + frame->size() > MAX_PENDING) {
+            conn.closing = true;
+            return;
+        }
+        if (conn.out.empty() && !conn.writeArmed) {
+            dirty.push_back(conn.fd); // written once this poll's handlers are done
+        }
+        conn.out.push(move(frame), stream);
+    }
+
+    void GameServer::flush(Connection &conn) {
+        iovec iov[MAX_IOV];
+        while (!conn.out.empty()) {
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = conn.out.gather(iov, MAX_IOV);
+            const ssize_t sent = sendmsg(conn.fd, &message, MSG_NOSIGNAL);
+            if (sent > 0) {
+                conn.out.consume(static_cast<size_t>(sent));
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            conn.closing = true;
+            return;
+        }
+
+        const bool pending = !conn.out.empty();
+        if (pending != conn.writeArmed) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP | (pending ? EPOLLOUT : 0u);
+            ev.data.fd = conn.fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+            conn.writeArmed = pending;
+        }
+    }
+
+    void GameServer::close(Connection &conn) {
+        const int fd = conn.fd;
+        const ConnectionId id = conn.id;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connectionFds.erase(id);
+        connections.erase(fd);
+        disconnect(id);
+        // A coordinator going away takes every client it relayed with it
+        auto it = relayIds.lower_bound(make_pair(id, uint32_t{0}));
+        while (it != relayIds.end() && it->first.first == id) {
+            relayed.erase(it->second);
+            disconnect(it->second);
+            it = relayIds.erase(it);
+        }
+    }
+
+    void GameServer::disconnect(const ConnectionId id) {
+        tables.disconnect(id);
+        if (mesh) {
+            for (size_t shard = 0; shard < mesh->size(); ++shard) {
+                if (shard != shardIndex) post(shard, ShardMessage{ShardMessage::Kind::Disconnect, id, {}, Frame(), 0});
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Shard routing
+    //------------------------------------------------------------------------------
+
+    bool GameServer::fromControl(const ConnectionId id) const {
+        const auto relay = relayed.find(id);
+        if (relay != relayed.end()) return fromControl(relay->second.via);
+        const auto fd = connectionFds.find(id);
+        return fd != connectionFds.end() && connections.at(fd->second).control;
+    }
+
+    void GameServer::route(const ConnectionId from, const uint8_t *body, const size_t length) {
+        const auto op = static_cast<wire::Op>(body[0]);
+        const bool cluster = op == wire::Op::Relay || op == wire::Op::Gone || op == wire::Op::Place ||
+                             op == wire::Op::Export || op == wire::Op::Import;
+        if (cluster && !fromControl(from)) {
+            throw ProtocolError("Cluster requests only come from a coordinator");
+        }
+        if (op == wire::Op::Relay || op == wire::Op::Gone) {
+            relay(from, body, length);
+            return;
+        }
+        // Every request but Create starts with the table id; Create stays on the caller's shard
+        if (mesh && length >= 5 && static_cast<wire::Op>(body[0]) != wire::Op::Create) {
+            const uint32_t table = body[1] | body[2] << 8 | body[3] << 16 | static_cast<uint32_t>(body[4]) << 24;
+            const size_t owner = mesh->tableOwner(table);
+            if (owner != shardIndex) {
+                post(owner, ShardMessage{ShardMessage::Kind::Request, from, vector<uint8_t>(body, body + length),
+                                         Frame(), 0});
+                return;
+            }
+        }
+        tables.handle(from, body, length, *this);
+    }
+
+    void GameServer::relay(const ConnectionId from, const uint8_t *body, const size_t length) {
+        wire::FrameReader in(body, length);
+        const uint32_t client = in.u32();
+        const auto key = make_pair(from, client);
+        const auto it = relayIds.find(key);
+        if (in.op() == wire::Op::Gone) {
+            if (it == relayIds.end()) return;
+            relayed.erase(it->second);
+            disconnect(it->second);
+            relayIds.erase(it);
+            return;
+        }
+        if (in.remaining() == 0) {
+            throw ProtocolError("Empty relayed request");
+        }
+        const auto inner = static_cast<wire::Op>(body[5]);
+        if (inner == wire::Op::Relay || inner == wire::Op::Gone) {
+            throw ProtocolError("Nested relay");
+        }
+        ConnectionId id;
+        if (it != relayIds.end()) {
+            id = it->second;
+        } else {
+            // Relayed clients get ids from the same sequence as sockets, so shard routing holds
+            id = nextConnection++ * (mesh ? mesh->size() : 1) + shardIndex;
+            relayIds.emplace(key, id);
+            relayed.emplace(id, Relayed{from, client});
+        }
+        route(id, body + 5, length - 5);
+    }
+
+    void GameServer::post(const size_t shard, ShardMessage &&message) {
+        deque<ShardMessage> &waiting = backlog[shard];
+        if (waiting.empty() && mesh->queue(shardIndex, shard).tryPush(message)) {
+            mesh->wake(shard);
+            return;
+        }
+        // Never block on a full queue: two shards waiting on each other would deadlock
+        waiting.push_back(move(message));
+    }
+
+    bool GameServer::flushBacklog() {
+        bool remaining = false;
+        for (size_t shard = 0; shard < backlog.size(); ++shard) {
+            deque<ShardMessage> &waiting = backlog[shard];
+            bool moved = false;
+            while (!waiting.empty() && mesh->queue(shardIndex, shard).tryPush(waiting.front())) {
+                waiting.pop_front();
+                moved = true;
+            }
+            if (moved) mesh->wake(shard);
+            remaining |= !waiting.empty();
+        }
+        return remaining;
+    }
+
+    void GameServer::drainMesh() {
+        ShardMessage message;
+        for (size_t from = 0; from < mesh->size(); ++from) {
+            SpscQueue<ShardMessage> &inbox = mesh->queue(from, shardIndex);
+            while (inbox.tryPop(message)) {
+                switch (message.kind) {
+                    case ShardMessage::Kind::Request:
+                        tables.handle(message.connection, message.bytes.data(), message.bytes.size(), *this);
+                        break;
+                    case ShardMessage::Kind::Reply: // already held back by the sending shard
+                        deliver(message.connection, move(message.frame), message.stream);
+                        break;
+                    case ShardMessage::Kind::Disconnect:
+                        tables.disconnect(message.connection);
+                        break;
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Loop
+    //------------------------------------------------------------------------------
+
+    int GameServer::poll(int timeoutMs) {
+        if (mesh && flushBacklog()) {
+            timeoutMs = timeoutMs < 0 ? 1 : min(timeoutMs, 1); // retry full queues soon
+        }
+        if (log) {
+            // Held replies would wait forever for a commit that cannot come
+            if (log->failed()) {
+                throw runtime_error("Action log write failed: cannot make changes durable");
+            }
+            releaseDurable();
+            timeoutMs = pollCheckpoint(timeoutMs);
+        }
+        const auto elapsed = chrono::steady_clock::now() - started;
+        tables.expire(static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(elapsed).count()), *this);
+        if (tables.pendingDeadlines() > 0) {
+            const int tick = static_cast<int>(TableHost::CLOCK_TICK_MS);
+            timeoutMs = timeoutMs < 0 ? tick : min(timeoutMs, tick); // wake for the next clock tick
+        }
+        epoll_event events[MAX_EVENTS];
+        const int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        if (count < 0) {
+            return 0; // EINTR
+        }
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                uint64_t drained;
+                while (read(wakeFd, &drained, sizeof(drained)) > 0) {
+                }
+                if (mesh) drainMesh();
+                if (log) releaseDurable(); // the log flusher signals commits here too
+                continue;
+            }
+            if (find(listeners.begin(), listeners.end(), fd) != listeners.end()) {
+                acceptAll(fd);
+                continue;
+            }
+            const auto it = connections.find(fd);
+            if (it == connections.end() || it->second.closing) continue;
+            Connection &conn = it->second;
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                readFrom(conn);
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush(conn);
+            }
+        }
+
+        // One writev per connection for everything this round queued (a closing connection
+        // still gets its last error frame); busy sockets wait for EPOLLOUT
+        for (const int fd: dirty) {
+            const auto it = connections.find(fd);
+            if (it != connections.end() && !it->second.writeArmed) flush(it->second);
+        }
+        dirty.clear();
+
+        // Close at the end so no handler ever sees a connection vanish under it
+        for (auto it = connections.begin(); it != connections.end();) {
+            Connection &conn = (it++)->second;
+            if (conn.closing) close(conn);
+        }
+        return count;
+    }
+
+    void GameServer::run() {
+        while (!stopping.load(memory_order_acquire)) {
+            poll(-1);
+        }
+        stopping.store(false, memory_order_release);
+    }
+
+    void GameServer::stop() {
+        stopping.store(true, memory_order_release);
+        const uint64_t one = 1;
+        const ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void) ignored;
+    }
+
+    TableHost &GameServer::host() {
+        return tables;
+    }
+
+    size_t GameServer::connectionCount() const {
+        return connections.size();
+    }
+} // namespace coup
+
+#endif // __linux__
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ActionLog.hpp"
+#include "OutQueue.hpp"
+#include "ShardMesh.hpp"
+#include "TableHost.hpp"
+
+namespace coup {
+    /**
+     * @class GameServer
+     * @brief Headless host for many tables behind a non-blocking epoll loop (Linux).
+     *
+     * Listens on loopback TCP and/or a Unix socket, reads length-prefixed frames
+     * (Protocol.hpp) from every connection and hands them to a TableHost. Replies
+     * and pushes are queued per connection as shared frames and written with
+     * writev as soon as the socket accepts them; pushes to a connection that
+     * falls behind collapse to the latest one per table. The loop also drives the
+     * turn and block clocks of its tables (TableHost::setClocks). With a log open
+     * every change is journaled first and its replies wait for the group commit
+     * that makes it durable, and checkpoints fork a child that writes every
+     * table from its copy-on-write view of memory while the loop keeps serving,
+     * so recovery only replays the log past the last checkpoint. Behind a cluster
+     * Coordinator (on its listenControl() socket) it serves each relayed client as a
+     * connection of its own. One loop runs on one thread; stop() may be called from
+     * any thread. The implementation is only compiled on Linux.
+     */
+    class GameServer : private FrameSink {
+    public:
+        /**
+         * @throws std::runtime_error if epoll or the wake-up eventfd cannot be created
+         */
+        GameServer();
+        ~GameServer() override;
+
+        GameServer(const GameServer&) = delete;
+        GameServer& operator=(const GameServer&) = delete;
+
+        /**
+         * @brief Listen on 127.0.0.1.
+         * @param port Port to bind, 0 for any free port
+         * @return The bound port
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        uint16_t listenTcp(uint16_t port);
+
+        /**
+         * @brief Listen on a Unix stream socket (an existing file at path is replaced).
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        void listenUnix(const std::string& path);
+
+        /**
+         * @brief Listen on a Unix socket for a cluster Coordinator.
+         *
+         * Only connections accepted here may relay clients (Relay, Gone) or move
+         * tables (Place, Export, Import); other connections that try are dropped
+         * with Malformed.
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        void listenControl(const std::string& path);
+
+        /**
+         * @brief Rebuild the tables recorded in a write-ahead log, then keep logging to it.
+         *
+         * Call before serving. A checkpoint next to the log (path + ".ckpt") is
+         * loaded first and only the records after it are replayed. Replies to a change are only sent once the change is
+         * durable, so a client never sees a state that a crash could take back.
+         * @return Records replayed
+         * @throws std::runtime_error if the log cannot be opened
+         * @throws InitError if the checkpoint or the log does not replay cleanly
+         */
+        size_t openLog(const std::string& path);
+
+        /**
+         * @brief Start writing every table to the log path + ".ckpt" in a forked child.
+         *
+         * The child serializes from the memory it shares copy-on-write with this
+         * process, so the loop never waits for it. The image replaces the previous
+         * one once the child exits and the log records it covers are durable; the
+         * log then drops those records (ActionLog::truncateBefore).
+         * @return False without an open log or while a checkpoint is in progress
+         * @throws std::runtime_error if fork fails
+         */
+        bool checkpoint();
+
+        /**
+         * @brief Checkpoint from poll() every intervalMs while tables keep changing; 0 turns it off.
+         */
+        void setCheckpointInterval(int intervalMs);
+
+        /** @return True while a checkpoint is being written or waits to be put in place. */
+        bool checkpointPending() const;
+
+        /** @return Log position covered by the checkpoint on disk (0 if none). */
+        uint64_t checkpointedLsn() const;
+
+        /**
+         * @brief Wait up to timeoutMs for events and handle everything that is ready.
+         * @return Number of events handled
+         * @throws std::runtime_error once the log can no longer make changes durable
+         */
+        int poll(int timeoutMs);
+
+        /**
+         * @brief Run the loop until stop() is called.
+         * @throws std::runtime_error once the log can no longer make changes durable
+         */
+        void run();
+
+        /**
+         * @brief Ask run() to return; safe from any thread.
+         */
+        void stop();
+
+        TableHost& host();
+        size_t connectionCount() const;
+
+    private:
+        friend class ShardedServer;
+
+        struct HeldFrame {
+            uint64_t lsn;               ///< Log position that must be durable first
+            ConnectionId connection;
+            Frame frame;
+            uint32_t stream;
+        };
+
+        struct Relayed {
+            ConnectionId via;           ///< Coordinator connection carrying the client
+            uint32_t client;            ///< Client id on the coordinator
+        };
+
+        struct Connection {
+            int fd = -1;
+            ConnectionId id = 0;
+            std::vector<uint8_t> in;    ///< Bytes received but not yet framed
+            OutQueue out;               ///< Frames waiting for the socket
+            bool writeArmed = false;    ///< EPOLLOUT registered
+            bool closing = false;       ///< Close once handled events finish
+            bool control = false;       ///< Accepted on a listenControl() socket
+        };
+
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::vector<int> listeners;
+        std::vector<int> controlListeners;                      ///< Subset of listeners
+        std::vector<std::string> unixPaths;
+        std::unordered_map<int, Connection> connections;        ///< By file descriptor
+        std::unordered_map<ConnectionId, int> connectionFds;    ///< Connection id to fd
+        std::vector<int> dirty;                                 ///< Fds with frames queued this poll
+        std::unordered_map<ConnectionId, Relayed> relayed;      ///< Relayed clients by their id here
+        std::map<std::pair<ConnectionId, uint32_t>, ConnectionId> relayIds;
+        ConnectionId nextConnection = 1;
+        TableHost tables;
+        std::atomic<bool> stopping{false};
+        ShardMesh* mesh = nullptr;                       ///< Set when running as one shard of many
+        size_t shardIndex = 0;
+        std::vector<std::deque<ShardMessage>> backlog;   ///< Messages waiting for room in a full queue
+        std::chrono::steady_clock::time_point started;   ///< Zero of the table clocks
+        std::unique_ptr<ActionLog> log;
+        std::deque<HeldFrame> held;                      ///< Frames waiting for a log commit, in order
+        std::string checkpointPath;
+        int checkpointChild = -1;                        ///< Pid of the child writing an image
+        bool checkpointWritten = false;                  ///< Image complete, waiting for its log records
+        uint64_t checkpointLsn = 0;                      ///< Log position of the image in progress
+        uint64_t savedLsn = 0;                           ///< Log position of the image on disk
+        int checkpointIntervalMs = 0;
+        std::chrono::steady_clock::time_point lastCheckpoint;
+
+        /**
+         * @brief Run as one shard of a ShardedServer.
+         */
+        GameServer(ShardMesh* mesh, size_t shardIndex);
+
+        void push(ConnectionId connection, Frame frame, uint32_t stream) override;
+        void deliver(ConnectionId connection, Frame frame, uint32_t stream);
+        void releaseDurable();
+        void reapCheckpoint(bool wait);
+        int pollCheckpoint(int timeoutMs);
+
+        void route(ConnectionId from, const uint8_t* body, size_t length);
+        void relay(ConnectionId from, const uint8_t* body, size_t length);
+        void disconnect(ConnectionId id);
+        void post(size_t shard, ShardMessage&& message);
+        bool flushBacklog();
+        void drainMesh();
+
+        void addListener(int fd);
+        int bindUnix(const std::string& path);
+        void acceptAll(int listener);
+        bool fromControl(ConnectionId id) const;
+        void readFrom(Connection& conn);
+        void flush(Connection& conn);
+        void close(Connection& conn);
+    };
+} // namespace coup
@@ -0,0 +1,68 @@
+#include "HashRing.hpp"
+#include <algorithm>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        /** @brief splitmix64 finalizer; spreads sequential ids over the whole ring. */
+        uint64_t mix(uint64_t x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        uint64_t pointHash(const string &node, const size_t replica) {
+            uint64_t hash = 14695981039346656037ull; // FNV-1a of the name, then the replica mixed in
+            for (const char c: node) {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+            }
+            return mix(hash ^ replica);
+        }
+    }
+
+    HashRing::HashRing(const size_t replicas) : replicas(replicas == 0 ? 1 : replicas) {
+    }
+
+    void HashRing::add(const string &node) {
+        if (contains(node)) return;
+        nodes.push_back(node);
+        for (size_t r = 0; r < replicas; ++r) {
+            points.emplace_back(pointHash(node, r), nodes.size() - 1);
+        }
+        sort(points.begin(), points.end());
+    }
+
+    void HashRing::remove(const string &node) {
+        const auto it = find(nodes.begin(), nodes.end(), node);
+        if (it == nodes.end()) return;
+        const size_t index = static_cast<size_t>(it - nodes.begin());
+        nodes.erase(it);
+        points.erase(remove_if(points.begin(), points.end(),
+                               [index](const pair<uint64_t, size_t> &p) { return p.second == index; }),
+                     points.end());
+        for (auto &point: points) {
+            if (point.second > index) --point.second;
+        }
+    }
+
+    bool HashRing::contains(const string &node) const {
+        return find(nodes.begin(), nodes.end(), node) != nodes.end();
+    }
+
+    const string &HashRing::owner(const uint32_t key) const {
+        if (points.empty()) {
+            throw InitError("Hash ring has no nodes");
+        }
+        const uint64_t hash = mix(key);
+        auto it = lower_bound(points.begin(), points.end(), make_pair(hash, size_t{0}));
+        if (it == points.end()) it = points.begin(); // wrap around
+        return nodes[it->second];
+    }
+
+    size_t HashRing::size() const {
+        return nodes.size();
+    }
+} // namespace coup
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace coup {
+    /**
+     * @class HashRing
+     * @brief Consistent hashing of table ids onto named nodes.
+     *
+     * Every node owns many points on a 64-bit ring and a key belongs to the
+     * first point at or after its hash. Adding a node only takes keys from the
+     * arcs it lands on; removing one only hands its own keys to the next points,
+     * so a change of the node set moves about 1/N of the keys.
+     */
+    class HashRing {
+    public:
+        /**
+         * @param replicas Points per node; more points even out the shares
+         */
+        explicit HashRing(size_t replicas = 64);
+
+        /** @brief Add a node (no-op if present). */
+        void add(const std::string& node);
+
+        /** @brief Remove a node (no-op if absent). */
+        void remove(const std::string& node);
+
+        bool contains(const std::string& node) const;
+
+        /**
+         * @return Node owning a key
+         * @throws InitError if the ring is empty
+         */
+        const std::string& owner(uint32_t key) const;
+
+        /** @return Nodes on the ring. */
+        size_t size() const;
+
+    private:
+        size_t replicas;
+        std::vector<std::string> nodes;
+        std::vector<std::pair<uint64_t, size_t>> points; ///< (hash, index in nodes), sorted by hash
+    };
+} // namespace coup
@@ -0,0 +1,182 @@
+#include "Matchmaker.hpp"
+#include <algorithm>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    Matchmaker::Matchmaker() : Matchmaker(Options()) {
+    }
+
+    Matchmaker::Matchmaker(const Options &options) : options(options) {
+        if (options.bucketWidth <= 0 || options.maxRating <= 0) {
+            throw InitError("Matchmaker needs a positive bucket width and rating range");
+        }
+        if (options.minSeats < 2 || options.maxSeats > 6 || options.minSeats > options.maxSeats) {
+            throw InitError("Matchmaker tables seat 2 to 6 players");
+        }
+        buckets.resize(static_cast<size_t>(options.maxRating / options.bucketWidth) + 1);
+    }
+
+    //------------------------------------------------------------------------------
+    // Queue
+    //------------------------------------------------------------------------------
+
+    size_t Matchmaker::bucketOf(const int rating) const {
+        return static_cast<size_t>(clamp(rating, 0, options.maxRating) / options.bucketWidth);
+    }
+
+    int Matchmaker::spreadFor(const uint64_t waitedMs) const {
+        const uint64_t grown = options.baseSpread + waitedMs * static_cast<uint64_t>(options.spreadPerSecond) / 1000;
+        return static_cast<int>(min<uint64_t>(grown, static_cast<uint64_t>(max(options.maxSpread, options.baseSpread))));
+    }
+
+    void Matchmaker::link(const size_t bucket, const uint32_t index) {
+        Bucket &b = buckets[bucket];
+        pool[index].prev = b.tail;
+        pool[index].next = NONE;
+        if (b.tail != NONE) {
+            pool[b.tail].next = index;
+        } else {
+            b.head = index;
+        }
+        b.tail = index;
+        ++b.count;
+    }
+
+    void Matchmaker::unlink(const size_t bucket, const uint32_t index) {
+        Bucket &b = buckets[bucket];
+        const Ticket &t = pool[index];
+        if (t.prev != NONE) {
+            pool[t.prev].next = t.next;
+        } else {
+            b.head = t.next;
+        }
+        if (t.next != NONE) {
+            pool[t.next].prev = t.prev;
+        } else {
+            b.tail = t.prev;
+        }
+        --b.count;
+    }
+
+    bool Matchmaker::enqueue(const uint64_t player, const int rating, const uint64_t nowMs) {
+        if (tickets.count(player)) return false;
+        uint32_t index;
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = static_cast<uint32_t>(pool.size());
+            pool.emplace_back();
+        }
+        Ticket &t = pool[index];
+        t.player = player;
+        t.since = nowMs;
+        t.rating = rating;
+        link(bucketOf(rating), index);
+        tickets.emplace(player, index);
+        return true;
+    }
+
+    bool Matchmaker::cancel(const uint64_t player) {
+        const auto it = tickets.find(player);
+        if (it == tickets.end()) return false;
+        unlink(bucketOf(pool[it->second].rating), it->second);
+        freeList.push_back(it->second);
+        tickets.erase(it);
+        return true;
+    }
+
+    bool Matchmaker::waiting(const uint64_t player) const {
+        return tickets.count(player) != 0;
+    }
+
+    size_t Matchmaker::size() const {
+        return tickets.size();
+    }
+
+    //------------------------------------------------------------------------------
+    // Forming tables
+    //------------------------------------------------------------------------------
+
+    void Matchmaker::take(const size_t bucket, const uint32_t index, Match &match) {
+        const Ticket &t = pool[index];
+        match.players.push_back(t.player);
+        match.ratings.push_back(t.rating);
+        unlink(bucket, index);
+        tickets.erase(t.player);
+        freeList.push_back(index);
+    }
+
+    bool Matchmaker::formFrom(const size_t anchorBucket, const uint64_t nowMs, Match &match) {
+        const uint32_t anchor = buckets[anchorBucket].head;
+        const uint64_t waited = nowMs > pool[anchor].since ? nowMs - pool[anchor].since : 0;
+        const int spread = spreadFor(waited);
+        const size_t reach = static_cast<size_t>(spread / options.bucketWidth);
+        const size_t low = anchorBucket > reach ? anchorBucket - reach : 0;
+        const size_t high = min(anchorBucket + reach, buckets.size() - 1);
+        size_t available = 0;
+        for (size_t b = low; b <= high; ++b) available += buckets[b].count;
+
+        const size_t full = static_cast<size_t>(options.maxSeats);
+        size_t seats = 0;
+        if (available >= full) {
+            seats = full;
+        } else if (available >= static_cast<size_t>(options.minSeats) && waited >= options.fillAfterMs) {
+            seats = available;
+        } else {
+            return false;
+        }
+
+        match.spread = spread;
+        match.longestWaitMs = waited;
+        take(anchorBucket, anchor, match);
+        // Closest buckets first, the oldest players of each bucket first
+        for (size_t d = 0; d <= reach && match.players.size() < seats; ++d) {
+            for (int side = 0; side < 2 && match.players.size() < seats; ++side) {
+                if (d == 0 && side == 1) break;
+                if (side == 0 ? anchorBucket + d > high : anchorBucket < low + d) continue;
+                const size_t b = side == 0 ? anchorBucket + d : anchorBucket - d;
+                while (buckets[b].head != NONE && match.players.size() < seats) {
+                    take(b, buckets[b].head, match);
+                }
+            }
+        }
+        return true;
+    }
+
+    vector<Match> Matchmaker::match(const uint64_t nowMs, const size_t maxTables) {
+        vector<Match> formed;
+        order.clear();
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            if (buckets[b].count) order.push_back(b);
+        }
+        sort(order.begin(), order.end(), [this](const size_t a, const size_t b) {
+            return pool[buckets[a].head].since < pool[buckets[b].head].since;
+        });
+        // Taking players only ever shrinks what other anchors can reach, so one pass is enough
+        for (const size_t b: order) {
+            while (formed.size() < maxTables && buckets[b].count) {
+                Match next;
+                if (!formFrom(b, nowMs, next)) break;
+                formed.push_back(move(next));
+            }
+            if (formed.size() >= maxTables) break;
+        }
+        return formed;
+    }
+
+    vector<Game> Matchmaker::games(const vector<Match> &matches, const function<string(uint64_t)> &nameOf,
+                                   const bool randomRoles) {
+        vector<Game> built;
+        built.reserve(matches.size());
+        for (const Match &m: matches) {
+            vector<string> names;
+            names.reserve(m.players.size());
+            for (const uint64_t player: m.players) names.push_back(nameOf(player));
+            built.emplace_back(names, !randomRoles);
+        }
+        return built;
+    }
+} // namespace coup
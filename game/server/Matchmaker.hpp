@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @struct Match
+     * @brief Players chosen to sit at one new table, in seat order.
+     */
+    struct Match {
+        std::vector<uint64_t> players;
+        std::vector<int> ratings;
+        int spread = 0;              ///< Rating distance the anchor accepted
+        uint64_t longestWaitMs = 0;  ///< How long the anchor (seat 0) waited
+    };
+
+    /**
+     * @class Matchmaker
+     * @brief Queue of waiting players bucketed by rating that forms 2-6 seat tables.
+     *
+     * Every bucket covers bucketWidth rating points and keeps its players in
+     * arrival order; tickets live in one pool linked by index, as TimerWheel
+     * does, so enqueue and cancel are O(1) and never allocate once the pool has
+     * grown. Forming tables only walks the buckets, never the players: the
+     * oldest player of a bucket anchors a table and accepts anyone within a
+     * spread that widens the longer it waits. A full table (maxSeats) is formed
+     * as soon as one fits; a smaller one only after the anchor has waited
+     * fillAfterMs. Not thread-safe.
+     */
+    class Matchmaker {
+    public:
+        struct Options {
+            int bucketWidth = 50;
+            int maxRating = 4000;          ///< Ratings are clamped to [0, maxRating]
+            int baseSpread = 100;          ///< Accepted distance on arrival
+            int spreadPerSecond = 50;      ///< Added for every second of waiting
+            int maxSpread = 800;
+            int minSeats = 2;
+            int maxSeats = 6;
+            uint64_t fillAfterMs = 10000;  ///< Wait after which a short table is accepted
+        };
+
+        Matchmaker();
+
+        /**
+         * @throws InitError on a non-positive width or rating range, or seats outside 2..6
+         */
+        explicit Matchmaker(const Options& options);
+
+        /**
+         * @brief Put a player in the queue.
+         * @param nowMs Monotonic time of arrival
+         * @return False if the player is already waiting
+         */
+        bool enqueue(uint64_t player, int rating, uint64_t nowMs);
+
+        /**
+         * @brief Take a player out of the queue.
+         * @return False if the player was not waiting
+         */
+        bool cancel(uint64_t player);
+
+        /** @return True while a player waits. */
+        bool waiting(uint64_t player) const;
+
+        /** @return Players waiting. */
+        size_t size() const;
+
+        /**
+         * @brief Form as many tables as the queue allows, oldest anchors first.
+         * @param nowMs Monotonic time, not earlier than any arrival
+         * @param maxTables Most tables to form in this batch
+         * @return The tables formed; their players have left the queue
+         */
+        std::vector<Match> match(uint64_t nowMs, size_t maxTables = SIZE_MAX);
+
+        /**
+         * @brief Build the games for a batch of matches.
+         * @param nameOf Name to seat a player under
+         * @param randomRoles Deal random roles instead of the fixed seat order
+         */
+        static std::vector<Game> games(const std::vector<Match>& matches,
+                                       const std::function<std::string(uint64_t)>& nameOf, bool randomRoles);
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Ticket {
+            uint64_t player = 0;
+            uint64_t since = 0;
+            int rating = 0;
+            uint32_t prev = NONE;
+            uint32_t next = NONE;
+        };
+
+        struct Bucket {
+            uint32_t head = NONE;   ///< Oldest ticket
+            uint32_t tail = NONE;
+            size_t count = 0;
+        };
+
+        Options options;
+        std::vector<Bucket> buckets;
+        std::vector<Ticket> pool;
+        std::vector<uint32_t> freeList;
+        std::unordered_map<uint64_t, uint32_t> tickets; ///< Pool index by player
+        std::vector<size_t> order;                      ///< Scratch: buckets by age of their oldest ticket
+
+        size_t bucketOf(int rating) const;
+        int spreadFor(uint64_t waitedMs) const;
+        void link(size_t bucket, uint32_t index);
+        void unlink(size_t bucket, uint32_t index);
+        void take(size_t bucket, uint32_t index, Match& match);
+        bool formFrom(size_t anchorBucket, uint64_t nowMs, Match& match);
+    };
+} // namespace coup
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "../GameExceptions.hpp"
+
+namespace coup {
+    /**
+     * @class MpscQueue
+     * @brief Bounded lock-free queue for any number of producer threads and one consumer thread.
+     *
+     * Every slot carries a sequence number telling whose turn it is: producers
+     * claim a slot by advancing the shared tail with a compare-and-swap and
+     * publish it by bumping the slot's sequence, so a producer never waits on
+     * another one and the consumer never takes a lock. Values from one producer
+     * come out in the order it pushed them.
+     */
+    template<typename T>
+    class MpscQueue {
+    public:
+        /**
+         * @param capacity Slot count, rounded up to a power of two
+         * @throws InitError if capacity is 0
+         */
+        explicit MpscQueue(size_t capacity) {
+            if (capacity == 0) {
+                throw InitError("MpscQueue needs a positive capacity");
+            }
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            slots.reset(new Slot[size]);
+            for (size_t i = 0; i < size; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+            mask = size - 1;
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        /**
+         * @brief Producer side, any thread: move a value in.
+         * @return False (value untouched) if the queue is full
+         */
+        bool tryPush(T& value) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = slots[t & mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                if (sequence == t) {
+                    if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(t + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (sequence < t) {
+                    return false; // the consumer has not freed this slot yet
+                } else {
+                    t = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Consumer side: move the oldest published value out.
+         * @return False if the queue is empty or the next slot is still being written
+         */
+        bool tryPop(T& out) {
+            Slot& slot = slots[head & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+            out = std::move(slot.value);
+            slot.sequence.store(head + mask + 1, std::memory_order_release);
+            ++head;
+            return true;
+        }
+
+        size_t capacity() const {
+            return mask + 1;
+        }
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<size_t> sequence{0}; ///< i: free for push i, i + 1: holds push i
+            T value{};
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        size_t mask = 0;
+        alignas(64) std::atomic<size_t> tail{0}; ///< Next slot to claim (producers)
+        alignas(64) size_t head = 0;             ///< Next slot to pop (consumer only)
+    };
+} // namespace coup
@@ -0,0 +1,65 @@
+#include "OutQueue.hpp"
+
+#ifdef __linux__
+
+#include <sys/uio.h>
+
+using namespace std;
+
+namespace coup {
+    void OutQueue::push(Frame frame, const uint32_t stream) {
+        if (stream != 0) {
+            // A partly sent front frame must finish as is; anything behind it can be replaced
+            for (size_t i = entries.size(); i-- > (offset > 0 ? 1u : 0u);) {
+                Entry &entry = entries[i];
+                if (entry.stream != stream) continue;
+                pending += frame->size();
+                pending -= entry.frame->size();
+                entry.frame = move(frame);
+                return;
+            }
+        }
+        pending += frame->size();
+        entries.push_back(Entry{move(frame), stream});
+    }
+
+    size_t OutQueue::gather(iovec *iov, const size_t max) const {
+        size_t filled = 0;
+        for (size_t i = 0; i < entries.size() && filled < max; ++i) {
+            const vector<uint8_t> &bytes = *entries[i].frame;
+            const size_t skip = i == 0 ? offset : 0;
+            iov[filled].iov_base = const_cast<uint8_t *>(bytes.data() + skip);
+            iov[filled].iov_len = bytes.size() - skip;
+            ++filled;
+        }
+        return filled;
+    }
+
+    void OutQueue::consume(size_t bytes) {
+        pending -= bytes;
+        while (bytes > 0) {
+            const size_t left = entries.front().frame->size() - offset;
+            if (bytes < left) {
+                offset += bytes;
+                return;
+            }
+            bytes -= left;
+            offset = 0;
+            entries.pop_front();
+        }
+    }
+
+    size_t OutQueue::bytes() const {
+        return pending;
+    }
+
+    size_t OutQueue::frames() const {
+        return entries.size();
+    }
+
+    bool OutQueue::empty() const {
+        return entries.empty();
+    }
+} // namespace coup
+
+#endif // __linux__
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include "TableHost.hpp"
+
+struct iovec;
+
+namespace coup {
+    /**
+     * @class OutQueue
+     * @brief Frames waiting for one connection's socket, written with scatter-gather I/O.
+     *
+     * Entries hold shared Frame buffers, so a push to thousands of connections
+     * never copies the bytes. A frame tagged with a stream replaces the unsent
+     * frame of the same stream instead of queueing behind it: a consumer that
+     * cannot keep up only ever gets the latest state. Only compiled on Linux.
+     */
+    class OutQueue {
+    public:
+        /**
+         * @brief Queue a frame.
+         * @param stream Non-zero to coalesce with an unsent frame of the same stream
+         */
+        void push(Frame frame, uint32_t stream);
+
+        /**
+         * @brief Describe the unsent bytes for writev.
+         * @param iov Output array
+         * @param max Capacity of iov
+         * @return Entries filled
+         */
+        size_t gather(iovec* iov, size_t max) const;
+
+        /**
+         * @brief Drop bytes the socket accepted.
+         */
+        void consume(size_t bytes);
+
+        /** @return Unsent bytes. */
+        size_t bytes() const;
+
+        /** @return Queued frames, the partly sent one included. */
+        size_t frames() const;
+
+        bool empty() const;
+
+    private:
+        struct Entry {
+            Frame frame;
+            uint32_t stream;
+        };
+
+        std::deque<Entry> entries;
+        size_t offset = 0;  ///< Bytes of the front frame already sent
+        size_t pending = 0; ///< Unsent bytes across all entries
+    };
+} // namespace coup
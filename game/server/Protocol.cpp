@@ -0,0 +1,140 @@
+#include "Protocol.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace wire {
+        //--------------------------------------------------------------------------
+        // FrameWriter
+        //--------------------------------------------------------------------------
+
+        FrameWriter::FrameWriter(const Op op) {
+            bytes.reserve(32);
+            bytes.resize(HEADER);
+            bytes.push_back(static_cast<uint8_t>(op));
+        }
+
+        FrameWriter &FrameWriter::u8(const uint8_t value) {
+            bytes.push_back(value);
+            return *this;
+        }
+
+        FrameWriter &FrameWriter::u16(const uint16_t value) {
+            bytes.push_back(static_cast<uint8_t>(value));
+            bytes.push_back(static_cast<uint8_t>(value >> 8));
+            return *this;
+        }
+
+        FrameWriter &FrameWriter::i16(const int16_t value) {
+            return u16(static_cast<uint16_t>(value));
+        }
+
+        FrameWriter &FrameWriter::u32(const uint32_t value) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                bytes.push_back(static_cast<uint8_t>(value >> shift));
+            }
+            return *this;
+        }
+
+        FrameWriter &FrameWriter::str(const string &value) {
+            if (value.size() > MAX_FRAME) {
+                throw ProtocolError("String too long for a frame");
+            }
+            u16(static_cast<uint16_t>(value.size()));
+            bytes.insert(bytes.end(), value.begin(), value.end());
+            return *this;
+        }
+
+        FrameWriter &FrameWriter::raw(const uint8_t *data, const size_t length) {
+            bytes.insert(bytes.end(), data, data + length);
+            return *this;
+        }
+
+        vector<uint8_t> FrameWriter::finish() {
+            const size_t body = bytes.size() - HEADER;
+            if (body > MAX_FRAME) {
+                throw ProtocolError("Frame too large");
+            }
+            bytes[0] = static_cast<uint8_t>(body);
+            bytes[1] = static_cast<uint8_t>(body >> 8);
+            return move(bytes);
+        }
+
+        //--------------------------------------------------------------------------
+        // FrameReader
+        //--------------------------------------------------------------------------
+
+        FrameReader::FrameReader(const uint8_t *body, const size_t length) : data(body), size(length) {
+            if (length == 0) {
+                throw ProtocolError("Empty frame");
+            }
+        }
+
+        Op FrameReader::op() const {
+            return static_cast<Op>(data[0]);
+        }
+
+        uint8_t FrameReader::u8() {
+            if (remaining() < 1) throw ProtocolError("Truncated frame");
+            return data[pos++];
+        }
+
+        uint16_t FrameReader::u16() {
+            if (remaining() < 2) throw ProtocolError("Truncated frame");
+            const uint16_t value = static_cast<uint16_t>(data[pos] | data[pos + 1] << 8);
+            pos += 2;
+            return value;
+        }
+
+        int16_t FrameReader::i16() {
+            return static_cast<int16_t>(u16());
+        }
+
+        uint32_t FrameReader::u32() {
+            if (remaining() < 4) throw ProtocolError("Truncated frame");
+            uint32_t value = 0;
+            for (int i = 3; i >= 0; --i) {
+                value = value << 8 | data[pos + i];
+            }
+            pos += 4;
+            return value;
+        }
+
+        string FrameReader::str() {
+            const uint16_t length = u16();
+            if (remaining() < length) throw ProtocolError("Truncated frame");
+            string value(reinterpret_cast<const char *>(data + pos), length);
+            pos += length;
+            return value;
+        }
+
+        const uint8_t *FrameReader::raw(const size_t length) {
+            if (remaining() < length) throw ProtocolError("Truncated frame");
+            const uint8_t *start = data + pos;
+            pos += length;
+            return start;
+        }
+
+        size_t FrameReader::remaining() const {
+            return size - pos;
+        }
+
+        //--------------------------------------------------------------------------
+        // Helpers
+        //--------------------------------------------------------------------------
+
+        size_t completeFrame(const uint8_t *buffer, const size_t length) {
+            if (length < HEADER) return 0;
+            const size_t body = buffer[0] | static_cast<size_t>(buffer[1]) << 8;
+            if (body == 0) {
+                throw ProtocolError("Zero-length frame");
+            }
+            return length - HEADER >= body ? body : 0;
+        }
+
+        vector<uint8_t> errorFrame(const ErrorCode code, const string &message) {
+            return FrameWriter(Op::Error).u8(static_cast<uint8_t>(code)).str(message).finish();
+        }
+    }
+} // namespace coup
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+    /**
+     * @brief Binary request/response protocol between game clients and the server.
+     *
+     * Every frame is a little-endian uint16 length followed by that many bytes:
+     * one opcode byte and its payload. Multi-byte fields are little-endian,
+     * strings are a uint16 length plus bytes.
+     *
+     * Requests (client -> server):
+     * - Create: u8 seats, u8 randomRoles               -> Created
+     * - Join:   u32 table, u8 seat (SPECTATOR to watch) -> Ok, then Snapshot
+     * - Act:    u32 table, u8 action (ActionSpace.hpp)  -> Ok
+     * - Block:  u32 table, u8 answer (0 allow, 1 block)-> Ok
+     * - State:  u32 table                               -> Snapshot
+     * - Leave:  u32 table                               -> Ok
+     * - Ack:    u32 table, u32 version                  -> (no reply)
+     *
+     * Cluster requests (coordinator -> engine, see Coordinator.hpp):
+     * - Place:  u32 table, u8 seats, u8 randomRoles    -> Created (Create with a chosen id)
+     * - Export: u32 table                               -> Image; the table leaves this engine
+     * - Import: u32 table, image (TableHost::checkpoint) -> Ok; the table moves in
+     * - Relay:  u32 client, request body                -> replies and pushes wrapped in Relay
+     * - Gone:   u32 client                              -> (no reply) a relayed client closed
+     *
+     * Replies and pushes (server -> client):
+     * - Ok:       u32 table, u32 version
+     * - Error:    u8 ErrorCode, string message
+     * - Created:  u32 table
+     * - Snapshot: see TableView::snapshot; the requester's view of a table
+     * - Delta:    see TableView::delta; pushed to every watcher after a change,
+     *             relative to the last version that watcher acknowledged
+     * - Image:    TableHost::checkpoint image of one exported table
+     * - Relay:    u32 client, frame body for that client of the coordinator
+     *
+     * Every view is filtered for its viewer: opponent coins read -1 unless the
+     * viewer plays a Spy.
+     */
+    namespace wire {
+        enum class Op : uint8_t {
+            Create = 0x01,
+            Join = 0x02,
+            Act = 0x03,
+            Block = 0x04,
+            State = 0x05,
+            Leave = 0x06,
+            Ack = 0x07,
+            Place = 0x08,
+            Export = 0x09,
+            Import = 0x0A,
+            Relay = 0x0B,
+            Gone = 0x0C,
+            Ok = 0x80,
+            Error = 0x81,
+            Created = 0x82,
+            Snapshot = 0x83,
+            Delta = 0x84,
+            Image = 0x85
+        };
+
+        enum class ErrorCode : uint8_t {
+            Malformed = 1,  ///< Frame could not be parsed
+            NoTable = 2,    ///< Unknown table id
+            SeatTaken = 3,  ///< Seat already bound to another connection
+            NotYourTurn = 4,///< Connection does not own the deciding seat
+            Illegal = 5     ///< The game rejected the action
+        };
+
+        constexpr uint8_t SPECTATOR = 0xFF;          ///< Join as a watcher without a seat
+        constexpr size_t HEADER = 2;                 ///< Length prefix size
+        constexpr size_t MAX_FRAME = 0xFFFF;         ///< Largest opcode + payload
+
+        /**
+         * @class FrameWriter
+         * @brief Builds one frame in place; finish() fills in the length prefix.
+         */
+        class FrameWriter {
+        public:
+            explicit FrameWriter(Op op);
+
+            FrameWriter& u8(uint8_t value);
+            FrameWriter& u16(uint16_t value);
+            FrameWriter& i16(int16_t value);
+            FrameWriter& u32(uint32_t value);
+            FrameWriter& str(const std::string& value);
+            FrameWriter& raw(const uint8_t* data, size_t length);
+
+            /**
+             * @return The finished frame including its length prefix
+             * @throws ProtocolError if the frame exceeds MAX_FRAME
+             */
+            std::vector<uint8_t> finish();
+
+        private:
+            std::vector<uint8_t> bytes;
+        };
+
+        /**
+         * @class FrameReader
+         * @brief Reads fields from one frame body (opcode first).
+         *
+         * Every accessor throws ProtocolError when the body is too short.
+         */
+        class FrameReader {
+        public:
+            FrameReader(const uint8_t* body, size_t length);
+
+            Op op() const;
+            uint8_t u8();
+            uint16_t u16();
+            int16_t i16();
+            uint32_t u32();
+            std::string str();
+            /** @return The next length bytes, in place */
+            const uint8_t* raw(size_t length);
+            size_t remaining() const;
+
+        private:
+            const uint8_t* data;
+            size_t size;
+            size_t pos = 1; ///< Byte 0 is the opcode
+        };
+
+        /**
+         * @brief Length of the first complete frame body in a stream buffer.
+         * @param buffer Received bytes
+         * @param length Number of bytes in buffer
+         * @return Body length, or 0 if the frame is not complete yet
+         * @throws ProtocolError on a zero-length frame
+         */
+        size_t completeFrame(const uint8_t* buffer, size_t length);
+
+        /** @return An Error frame. */
+        std::vector<uint8_t> errorFrame(ErrorCode code, const std::string& message);
+    }
+} // namespace coup
@@ -0,0 +1,50 @@
+#include "ShardMesh.hpp"
+#include "../GameExceptions.hpp"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace coup {
+    ShardMesh::ShardMesh(const size_t shards, const size_t capacity) : shards(shards), wakeFds(shards, -1) {
+        if (shards == 0) {
+            throw InitError("A shard mesh needs at least one shard");
+        }
+        queues.reserve(shards * shards);
+        for (size_t i = 0; i < shards * shards; ++i) {
+            queues.push_back(make_unique<SpscQueue<ShardMessage>>(capacity));
+        }
+    }
+
+    size_t ShardMesh::size() const {
+        return shards;
+    }
+
+    SpscQueue<ShardMessage> &ShardMesh::queue(const size_t from, const size_t to) {
+        return *queues[from * shards + to];
+    }
+
+    void ShardMesh::setWakeFd(const size_t shard, const int fd) {
+        wakeFds.at(shard) = fd;
+    }
+
+    void ShardMesh::wake(const size_t shard) const {
+#ifdef __linux__
+        const uint64_t one = 1;
+        const ssize_t ignored = write(wakeFds[shard], &one, sizeof(one));
+        (void) ignored;
+#else
+        (void) shard;
+#endif
+    }
+
+    size_t ShardMesh::tableOwner(const uint32_t table) const {
+        return (table - 1) % shards;
+    }
+
+    size_t ShardMesh::connectionOwner(const ConnectionId connection) const {
+        return connection % shards;
+    }
+} // namespace coup
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "SpscQueue.hpp"
+#include "TableHost.hpp"
+
+namespace coup {
+    /**
+     * @struct ShardMessage
+     * @brief Work handed from one shard to another.
+     */
+    struct ShardMessage {
+        enum class Kind : uint8_t {
+            Request,   ///< Frame body for a table the receiver owns
+            Reply,     ///< Frame for a connection the receiver owns
+            Disconnect ///< A connection closed; drop its seats and watches
+        };
+
+        Kind kind = Kind::Request;
+        ConnectionId connection = 0;
+        std::vector<uint8_t> bytes; ///< Request body
+        Frame frame;                ///< Reply, shared rather than copied
+        uint32_t stream = 0;        ///< Reply stream (FrameSink::push)
+    };
+
+    /**
+     * @class ShardMesh
+     * @brief One SPSC queue per ordered pair of shards plus a wake-up fd per shard.
+     *
+     * Tables and connections belong to shard (id - 1) % size() and
+     * id % size(); everything else is routed through the mesh.
+     */
+    class ShardMesh {
+    public:
+        ShardMesh(size_t shards, size_t capacity);
+
+        size_t size() const;
+
+        /** @return Queue carrying messages from one shard to another. */
+        SpscQueue<ShardMessage>& queue(size_t from, size_t to);
+
+        /** @brief Register the eventfd that wakes a shard. */
+        void setWakeFd(size_t shard, int fd);
+
+        /** @brief Wake a shard after pushing to one of its queues. */
+        void wake(size_t shard) const;
+
+        size_t tableOwner(uint32_t table) const;
+        size_t connectionOwner(ConnectionId connection) const;
+
+    private:
+        size_t shards;
+        std::vector<std::unique_ptr<SpscQueue<ShardMessage>>> queues;
+        std::vector<int> wakeFds;
+    };
+
+} // namespace coup
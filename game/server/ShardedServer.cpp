@@ -0,0 +1,89 @@
+#include "ShardedServer.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    ShardedServer::ShardedServer(const size_t shards) : mesh(shards == 0 ? 1 : shards, QUEUE_CAPACITY) {
+        if (shards == 0) {
+            throw InitError("ShardedServer needs at least one shard");
+        }
+        for (size_t i = 0; i < shards; ++i) {
+            this->shards.push_back(unique_ptr<GameServer>(new GameServer(&mesh, i)));
+        }
+    }
+
+    ShardedServer::~ShardedServer() {
+        stop();
+    }
+
+    uint16_t ShardedServer::listenTcp(const uint16_t port) {
+        const uint16_t bound = shards[0]->listenTcp(port);
+        for (size_t i = 1; i < shards.size(); ++i) {
+            shards[i]->listenTcp(bound);
+        }
+        return bound;
+    }
+
+    void ShardedServer::listenUnix(const string &path) {
+        shards[0]->listenUnix(path);
+    }
+
+    void ShardedServer::setClocks(const uint32_t turnMs, const uint32_t blockMs) {
+        for (auto &shard: shards) {
+            shard->host().setClocks(turnMs, blockMs);
+        }
+    }
+
+    void ShardedServer::setMemoryBudget(const size_t bytes) {
+        for (auto &shard: shards) {
+            shard->host().setMemoryBudget(bytes == 0 ? 0 : max<size_t>(1, bytes / shards.size()));
+        }
+    }
+
+    size_t ShardedServer::openLogs(const string &prefix) {
+        size_t records = 0;
+        for (size_t i = 0; i < shards.size(); ++i) {
+            records += shards[i]->openLog(prefix + "." + to_string(i) + ".wal");
+        }
+        return records;
+    }
+
+    void ShardedServer::setCheckpointInterval(const int intervalMs) {
+        for (auto &shard: shards) {
+            shard->setCheckpointInterval(intervalMs);
+        }
+    }
+
+    void ShardedServer::start() {
+        if (!workers.empty()) return;
+        for (auto &shard: shards) {
+            GameServer *server = shard.get();
+            workers.emplace_back([server] { server->run(); });
+        }
+    }
+
+    void ShardedServer::stop() {
+        for (auto &shard: shards) {
+            shard->stop();
+        }
+        for (thread &worker: workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    size_t ShardedServer::shardCount() const {
+        return shards.size();
+    }
+
+    GameServer &ShardedServer::shard(const size_t index) {
+        return *shards.at(index);
+    }
+} // namespace coup
+
+#endif // __linux__
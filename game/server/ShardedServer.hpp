@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GameServer.hpp"
+#include "ShardMesh.hpp"
+
+namespace coup {
+    /**
+     * @class ShardedServer
+     * @brief Shared-nothing multi-core host: one GameServer loop per worker thread.
+     *
+     * Every shard owns its connections, its tables (ids step by the shard count)
+     * and its event loop. TCP connections are spread by the kernel through
+     * SO_REUSEPORT; a request for a table on another shard, and the replies it
+     * produces, travel through the ShardMesh instead of any shared lock.
+     * Linux only.
+     */
+    class ShardedServer {
+    public:
+        static constexpr size_t QUEUE_CAPACITY = 1 << 14; ///< Messages per shard pair
+
+        /**
+         * @param shards Worker threads (at least 1)
+         * @throws InitError if shards is 0
+         */
+        explicit ShardedServer(size_t shards);
+        ~ShardedServer();
+
+        ShardedServer(const ShardedServer&) = delete;
+        ShardedServer& operator=(const ShardedServer&) = delete;
+
+        /**
+         * @brief Listen on 127.0.0.1 from every shard.
+         * @param port Port to bind, 0 for any free port
+         * @return The bound port
+         */
+        uint16_t listenTcp(uint16_t port);
+
+        /**
+         * @brief Listen on a Unix socket; its connections live on shard 0.
+         */
+        void listenUnix(const std::string& path);
+
+        /**
+         * @brief Set the turn and block clocks of every shard (see TableHost::setClocks).
+         * Call before start().
+         */
+        void setClocks(uint32_t turnMs, uint32_t blockMs);
+
+        /**
+         * @brief Split a resident-game memory budget evenly across the shards
+         * (see TableHost::setMemoryBudget). Call before start().
+         */
+        void setMemoryBudget(size_t bytes);
+
+        /**
+         * @brief Give every shard its own write-ahead log, prefix + ".<shard>.wal".
+         *
+         * Call before start(); recovery needs the same shard count as the run
+         * that wrote the logs, since table ids are spread by it.
+         * @return Records replayed across all shards
+         */
+        size_t openLogs(const std::string& prefix);
+
+        /**
+         * @brief Have every shard checkpoint next to its log every intervalMs
+         * (see GameServer::setCheckpointInterval). Each shard forks on its own
+         * thread and its child only writes that shard's tables.
+         */
+        void setCheckpointInterval(int intervalMs);
+
+        /** @brief Start one thread per shard. */
+        void start();
+
+        /** @brief Stop and join every shard thread. */
+        void stop();
+
+        size_t shardCount() const;
+
+        /** @return A shard's server; only touch it while the shards are stopped. */
+        GameServer& shard(size_t index);
+
+    private:
+        ShardMesh mesh;
+        std::vector<std::unique_ptr<GameServer>> shards;
+        std::vector<std::thread> workers;
+    };
+} // namespace coup
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "../GameExceptions.hpp"
+
+namespace coup {
+    /**
+     * @class SpscQueue
+     * @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+     *
+     * Head and tail live on separate cache lines; each side keeps a cached copy
+     * of the other's index so the shared line is only read when the cached
+     * value says the queue looks full (or empty).
+     */
+    template<typename T>
+    class SpscQueue {
+    public:
+        /**
+         * @param capacity Slot count, rounded up to a power of two
+         * @throws InitError if capacity is 0
+         */
+        explicit SpscQueue(size_t capacity) {
+            if (capacity == 0) {
+                throw InitError("SpscQueue needs a positive capacity");
+            }
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            slots.resize(size);
+            mask = size - 1;
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /**
+         * @brief Producer side: move a value in.
+         * @return False (value untouched) if the queue is full
+         */
+        bool tryPush(T& value) {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if (t - headCache == slots.size()) {
+                headCache = head.load(std::memory_order_acquire);
+                if (t - headCache == slots.size()) return false;
+            }
+            slots[t & mask] = std::move(value);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Consumer side: move the oldest value out.
+         * @return False if the queue is empty
+         */
+        bool tryPop(T& out) {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if (h == tailCache) {
+                tailCache = tail.load(std::memory_order_acquire);
+                if (h == tailCache) return false;
+            }
+            out = std::move(slots[h & mask]);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t capacity() const {
+            return slots.size();
+        }
+
+    private:
+        std::vector<T> slots;
+        size_t mask = 0;
+        alignas(64) std::atomic<size_t> head{0}; ///< Next slot to pop (consumer)
+        size_t tailCache = 0;                    ///< Consumer's view of tail
+        alignas(64) std::atomic<size_t> tail{0}; ///< Next slot to fill (producer)
+        size_t headCache = 0;                    ///< Producer's view of head
+    };
+} // namespace coup
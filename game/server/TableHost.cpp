@@ -0,0 +1,662 @@
+#include "TableHost.hpp"
+#include <algorithm>
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        /**
+         * @brief Request failure carrying the error code sent back to the client.
+         */
+        struct RequestError {
+            wire::ErrorCode code;
+            string message;
+        };
+
+        uint8_t playerFlags(const Player *p) {
+            return static_cast<uint8_t>(p->isGatherAllow() | p->isTaxAllow() << 1 | p->isArrestAllow() << 2 |
+                                        p->isBribeAllow() << 3 | p->isCoupShieldActive() << 4);
+        }
+
+        /** @brief Rough heap held by a resident game: its Player objects and their names. */
+        size_t gameBytes(const Game &game) {
+            size_t bytes = 0;
+            for (const Player *p: game.getPlayers()) {
+                bytes += sizeof(Player) + p->getName().capacity();
+            }
+            return bytes;
+        }
+
+        void putLittle(vector<uint8_t> &out, const uint64_t value, const int bytes) {
+            for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        /** @brief Checkpoint image header: magic, u64 lsn, u32 next id, u32 table count. */
+        vector<uint8_t> imageHeader(const uint64_t lsn, const uint32_t nextId, const size_t count) {
+            vector<uint8_t> out{'C', 'K', 'P', '1'};
+            putLittle(out, lsn, 8);
+            putLittle(out, nextId, 4);
+            putLittle(out, count, 4);
+            return out;
+        }
+
+        /** @brief One table of an image: id, version, seats, packed game and pipeline. */
+        void putTable(vector<uint8_t> &out, const HostedTable &table) {
+            const vector<uint8_t> game = table.hibernating() ? table.packed : table.game.pack();
+            // A hibernating table is never mid block window; waking rebuilds its pipeline anyway
+            const vector<uint8_t> pipeline = table.hibernating() ? vector<uint8_t>{} : table.pipeline.pack();
+            putLittle(out, table.id, 4);
+            putLittle(out, table.version, 4);
+            putLittle(out, table.seatOwner.size(), 1);
+            putLittle(out, game.size(), 2);
+            out.insert(out.end(), game.begin(), game.end());
+            putLittle(out, pipeline.size(), 1);
+            out.insert(out.end(), pipeline.begin(), pipeline.end());
+        }
+
+        /**
+         * @brief A restored game must fit its seats: the players still in are P<seat>
+         *        in seat order, every seat until someone is eliminated.
+         * @throws InitError if it does not
+         */
+        void checkSeats(const Game &game, const size_t seats) {
+            const vector<Player *> &players = game.getPlayers();
+            if (players.empty() || players.size() > seats) {
+                throw InitError("Checkpoint table has " + to_string(players.size()) + " players for " +
+                                to_string(seats) + " seats");
+            }
+            int last = -1;
+            for (const Player *p: players) {
+                const string &name = p->getName();
+                const int seat = name.size() == 2 && name[0] == 'P' ? name[1] - '0' : -1;
+                if (seat <= last || seat >= static_cast<int>(seats)) {
+                    throw InitError("Checkpoint table has a player that fits no seat: " + name);
+                }
+                last = seat;
+            }
+        }
+
+        void eraseWatcher(vector<Watcher> &watchers, const ConnectionId connection) {
+            watchers.erase(remove_if(watchers.begin(), watchers.end(),
+                                     [connection](const Watcher &w) { return w.connection == connection; }),
+                           watchers.end());
+        }
+    }
+
+    void FrameSink::send(const ConnectionId connection, vector<uint8_t> frame) {
+        push(connection, make_shared<const vector<uint8_t>>(move(frame)), 0);
+    }
+
+    //------------------------------------------------------------------------------
+    // HostedTable
+    //------------------------------------------------------------------------------
+
+    HostedTable::HostedTable(const uint32_t id, const vector<string> &names, const bool randomRoles)
+        : id(id), game(names, !randomRoles), pipeline(game), seatOwner(names.size(), 0), views(names.size() + 1) {
+    }
+
+    Player *HostedTable::seatPlayer(const size_t seat) const {
+        const string name = "P" + to_string(seat);
+        for (Player *p: game.getPlayers()) {
+            if (p->getName() == name) return p;
+        }
+        return nullptr;
+    }
+
+    size_t HostedTable::seatOf(const Player *player) const {
+        return stoul(player->getName().substr(1));
+    }
+
+    uint8_t HostedTable::seatOwnedBy(const ConnectionId connection) const {
+        for (size_t seat = 0; seat < seatOwner.size(); ++seat) {
+            if (seatOwner[seat] == connection) return static_cast<uint8_t>(seat);
+        }
+        return wire::SPECTATOR;
+    }
+
+    Watcher *HostedTable::watcher(const ConnectionId connection) {
+        for (Watcher &w: watchers) {
+            if (w.connection == connection) return &w;
+        }
+        return nullptr;
+    }
+
+    bool HostedTable::hibernating() const {
+        return !packed.empty();
+    }
+
+    shared_ptr<const TableView> HostedTable::currentView(const uint8_t viewerSeat) {
+        shared_ptr<const TableView> &cached = views[viewerSeat == wire::SPECTATOR ? views.size() - 1 : viewerSeat];
+        if (!cached || cached->version != version) {
+            cached = make_shared<const TableView>(TableHost::view(*this, viewerSeat));
+        }
+        return cached;
+    }
+
+    //------------------------------------------------------------------------------
+    // TableHost
+    //------------------------------------------------------------------------------
+
+    TableHost::TableHost(const uint32_t firstId, const uint32_t idStride)
+        : nextId(firstId), idStride(idStride == 0 ? 1 : idStride) {
+    }
+
+    HostedTable &TableHost::create(const int seats, const bool randomRoles) {
+        HostedTable &table = place(nextId, seats, randomRoles);
+        nextId += idStride;
+        return table;
+    }
+
+    HostedTable &TableHost::place(const uint32_t id, const int seats, const bool randomRoles) {
+        if (seats < 2 || seats > 6) {
+            throw InitError("Tables need 2 to 6 seats");
+        }
+        if (find(id)) {
+            throw InitError("Table " + to_string(id) + " already exists");
+        }
+        vector<string> names;
+        for (int i = 0; i < seats; ++i) {
+            names.push_back("P" + to_string(i));
+        }
+        HostedTable &table = admit(make_unique<HostedTable>(id, names, randomRoles));
+        if (journal) record(Journal::Created, id, table.game.pack()); // roles may be random
+        trim();
+        return table;
+    }
+
+    HostedTable &TableHost::admit(unique_ptr<HostedTable> table) {
+        HostedTable &ref = *table;
+        tables[ref.id] = move(table);
+        ref.residentBytes = gameBytes(ref.game);
+        resident += ref.residentBytes;
+        ref.recent = lru.insert(lru.begin(), ref.id);
+        rearm(ref);
+        return ref;
+    }
+
+    HostedTable *TableHost::find(const uint32_t id) {
+        const auto it = tables.find(id);
+        return it == tables.end() ? nullptr : it->second.get();
+    }
+
+    size_t TableHost::tableCount() const {
+        return tables.size();
+    }
+
+    HostedTable &TableHost::require(const uint32_t id) {
+        HostedTable *table = find(id);
+        if (!table) {
+            throw RequestError{wire::ErrorCode::NoTable, "No table " + to_string(id)};
+        }
+        touch(*table);
+        return *table;
+    }
+
+    void TableHost::handle(const ConnectionId from, const uint8_t *body, const size_t length, FrameSink &out) {
+        try {
+            wire::FrameReader in(body, length);
+            dispatch(from, in, out);
+        } catch (const RequestError &e) {
+            out.send(from, wire::errorFrame(e.code, e.message));
+        } catch (const ProtocolError &e) {
+            out.send(from, wire::errorFrame(wire::ErrorCode::Malformed, e.what()));
+        } catch (const exception &e) {
+            out.send(from, wire::errorFrame(wire::ErrorCode::Illegal, e.what()));
+        }
+        trim();
+    }
+
+    void TableHost::dispatch(const ConnectionId from, wire::FrameReader &in, FrameSink &out) {
+        using wire::Op;
+        switch (in.op()) {
+            case Op::Create: {
+                const int seats = in.u8();
+                const bool randomRoles = in.u8() != 0;
+                const HostedTable &table = create(seats, randomRoles);
+                out.send(from, wire::FrameWriter(Op::Created).u32(table.id).finish());
+                break;
+            }
+            case Op::Join: {
+                HostedTable &table = require(in.u32());
+                const uint8_t seat = in.u8();
+                if (seat != wire::SPECTATOR) {
+                    if (seat >= table.seatOwner.size()) {
+                        throw RequestError{wire::ErrorCode::Malformed, "No such seat"};
+                    }
+                    if (table.seatOwner[seat] != 0 && table.seatOwner[seat] != from) {
+                        throw RequestError{wire::ErrorCode::SeatTaken, "Seat is taken"};
+                    }
+                    table.seatOwner[seat] = from;
+                }
+                Watcher *w = table.watcher(from);
+                if (!w) {
+                    table.watchers.push_back(Watcher{from, {}, {}});
+                    w = &table.watchers.back();
+                    joined[from].push_back(table.id);
+                }
+                // The snapshot becomes the base of this watcher's deltas
+                w->acked = table.currentView(table.seatOwnedBy(from));
+                w->sent.clear();
+                out.send(from, wire::FrameWriter(Op::Ok).u32(table.id).u32(table.version).finish());
+                out.send(from, w->acked->snapshot());
+                break;
+            }
+            case Op::Act: {
+                HostedTable &table = require(in.u32());
+                answer(from, table, Await::Action, in.u8(), out);
+                break;
+            }
+            case Op::Block: {
+                HostedTable &table = require(in.u32());
+                answer(from, table, Await::Block, in.u8(), out);
+                break;
+            }
+            case Op::State: {
+                const HostedTable &table = require(in.u32());
+                out.send(from, snapshot(table, table.seatOwnedBy(from)));
+                break;
+            }
+            case Op::Ack: {
+                HostedTable &table = require(in.u32());
+                const uint32_t version = in.u32();
+                Watcher *w = table.watcher(from);
+                if (!w) break;
+                // Acks for views already dropped from the window are harmless and ignored
+                for (size_t i = 0; i < w->sent.size(); ++i) {
+                    if (w->sent[i]->version != version) continue;
+                    w->acked = move(w->sent[i]);
+                    w->sent.erase(w->sent.begin(), w->sent.begin() + static_cast<ptrdiff_t>(i) + 1);
+                    break;
+                }
+                break;
+            }
+            case Op::Leave: {
+                HostedTable &table = require(in.u32());
+                const uint32_t id = table.id;
+                out.send(from, wire::FrameWriter(Op::Ok).u32(id).u32(table.version).finish());
+                for (ConnectionId &owner: table.seatOwner) {
+                    if (owner == from) owner = 0;
+                }
+                eraseWatcher(table.watchers, from);
+                auto &mine = joined[from];
+                mine.erase(remove(mine.begin(), mine.end(), id), mine.end());
+                if (table.watchers.empty() && table.pipeline.awaiting() == Await::Done) {
+                    drop(table);
+                }
+                break;
+            }
+            case Op::Place: {
+                const uint32_t id = in.u32();
+                const int seats = in.u8();
+                const bool randomRoles = in.u8() != 0;
+                place(id, seats, randomRoles);
+                out.send(from, wire::FrameWriter(Op::Created).u32(id).finish());
+                break;
+            }
+            case Op::Export: {
+                const uint32_t id = in.u32();
+                const vector<uint8_t> image = extract(id);
+                if (image.empty()) {
+                    throw RequestError{wire::ErrorCode::NoTable, "No table " + to_string(id)};
+                }
+                out.send(from, wire::FrameWriter(Op::Image).raw(image.data(), image.size()).finish());
+                break;
+            }
+            case Op::Import: {
+                const uint32_t id = in.u32();
+                const size_t length = in.remaining();
+                import(in.raw(length), length);
+                const HostedTable *table = find(id);
+                if (!table) {
+                    throw RequestError{wire::ErrorCode::Malformed, "Image does not hold table " + to_string(id)};
+                }
+                out.send(from, wire::FrameWriter(Op::Ok).u32(id).u32(table->version).finish());
+                break;
+            }
+            default:
+                throw RequestError{wire::ErrorCode::Malformed, "Unknown opcode"};
+        }
+    }
+
+    void TableHost::answer(const ConnectionId from, HostedTable &table, const Await expected, const int value,
+                           FrameSink &out) {
+        const Player *decider = table.pipeline.decider();
+        if (table.pipeline.awaiting() != expected || !decider || table.seatOwner[table.seatOf(decider)] != from) {
+            throw RequestError{wire::ErrorCode::NotYourTurn, "Not waiting on you"};
+        }
+        try {
+            table.pipeline.resume(value);
+        } catch (const exception &e) {
+            throw RequestError{wire::ErrorCode::Illegal, e.what()};
+        }
+        if (journal) record(Journal::Answer, table.id, {static_cast<uint8_t>(expected), static_cast<uint8_t>(value)});
+        ++table.version;
+        rearm(table);
+        out.send(from, wire::FrameWriter(wire::Op::Ok).u32(table.id).u32(table.version).finish());
+        publish(table, out);
+    }
+
+    //------------------------------------------------------------------------------
+    // Clocks
+    //------------------------------------------------------------------------------
+
+    void TableHost::setClocks(const uint32_t turnMs, const uint32_t blockMs) {
+        this->turnMs = turnMs;
+        this->blockMs = blockMs;
+    }
+
+    void TableHost::rearm(HostedTable &table) {
+        if (table.deadline != 0) {
+            clocks.cancel(table.deadline);
+            table.deadline = 0;
+        }
+        const Await state = table.pipeline.awaiting();
+        const uint32_t limit = state == Await::Action ? turnMs : state == Await::Block ? blockMs : 0;
+        if (limit == 0) return;
+        const uint64_t ticks = (limit + CLOCK_TICK_MS - 1) / CLOCK_TICK_MS;
+        table.deadline = clocks.arm(clocks.now() + ticks, table.id);
+    }
+
+    size_t TableHost::expire(const uint64_t nowMs, FrameSink &out) {
+        expired.clear();
+        clocks.advance(nowMs / CLOCK_TICK_MS, expired);
+        size_t decided = 0;
+        for (const uint64_t id: expired) {
+            HostedTable *table = find(static_cast<uint32_t>(id));
+            if (!table) continue;
+            table->deadline = 0;
+            touch(*table);
+            const Await state = table->pipeline.awaiting();
+            const int answer = table->pipeline.fallback();
+            if (answer < 0) continue;
+            table->pipeline.resume(answer);
+            if (journal) record(Journal::Answer, table->id, {static_cast<uint8_t>(state), static_cast<uint8_t>(answer)});
+            ++table->version;
+            ++decided;
+            rearm(*table);
+            publish(*table, out);
+        }
+        trim();
+        return decided;
+    }
+
+    size_t TableHost::pendingDeadlines() const {
+        return clocks.size();
+    }
+
+    //------------------------------------------------------------------------------
+    // Hibernation
+    //------------------------------------------------------------------------------
+
+    void TableHost::setMemoryBudget(const size_t bytes) {
+        budget = bytes;
+        trim();
+    }
+
+    bool TableHost::hibernate(const uint32_t id) {
+        HostedTable *table = find(id);
+        // A block window lives in the pipeline, not the game, so it cannot be packed
+        if (!table || table->hibernating() || table->pipeline.awaiting() == Await::Block) return false;
+        table->packed = table->game.pack();
+        table->game = Game(vector<string>{}); // frees every Player
+        for (auto &view: table->views) view.reset();
+        lru.erase(table->recent);
+        resident -= table->residentBytes;
+        ++sleeping;
+        return true;
+    }
+
+    void TableHost::wake(HostedTable &table) {
+        if (!table.hibernating()) return;
+        table.game = Game::unpack(table.packed.data(), table.packed.size());
+        table.pipeline = TurnPipeline(table.game);
+        table.packed.clear();
+        table.packed.shrink_to_fit();
+        table.residentBytes = gameBytes(table.game);
+        resident += table.residentBytes;
+        table.recent = lru.insert(lru.begin(), table.id);
+        --sleeping;
+    }
+
+    void TableHost::touch(HostedTable &table) {
+        if (table.hibernating()) {
+            wake(table);
+        } else {
+            lru.splice(lru.begin(), lru, table.recent);
+        }
+    }
+
+    void TableHost::trim() {
+        if (budget == 0) return;
+        // Walk from the least recently used end; hibernate() unlinks the entry it evicts
+        auto it = lru.end();
+        while (resident > budget && it != lru.begin()) {
+            const auto candidate = prev(it);
+            if (!hibernate(*candidate)) it = candidate;
+        }
+    }
+
+    void TableHost::drop(HostedTable &table) {
+        if (journal) record(Journal::Dropped, table.id);
+        clocks.cancel(table.deadline);
+        if (table.hibernating()) {
+            --sleeping;
+        } else {
+            lru.erase(table.recent);
+            resident -= table.residentBytes;
+        }
+        tables.erase(table.id);
+    }
+
+    size_t TableHost::residentBytes() const {
+        return resident;
+    }
+
+    size_t TableHost::hibernatingCount() const {
+        return sleeping;
+    }
+
+    //------------------------------------------------------------------------------
+    // Journal
+    //------------------------------------------------------------------------------
+
+    void TableHost::setJournal(function<void(const vector<uint8_t> &)> sink) {
+        journal = move(sink);
+    }
+
+    void TableHost::record(const Journal kind, const uint32_t id, const vector<uint8_t> &extra) {
+        vector<uint8_t> bytes;
+        bytes.reserve(5 + extra.size());
+        bytes.push_back(static_cast<uint8_t>(kind));
+        for (int shift = 0; shift < 32; shift += 8) {
+            bytes.push_back(static_cast<uint8_t>(id >> shift));
+        }
+        bytes.insert(bytes.end(), extra.begin(), extra.end());
+        journal(bytes);
+    }
+
+    vector<uint8_t> TableHost::checkpoint(const uint64_t lsn) const {
+        vector<uint8_t> out = imageHeader(lsn, nextId, tables.size());
+        for (const auto &entry: tables) {
+            putTable(out, *entry.second);
+        }
+        return out;
+    }
+
+    vector<uint8_t> TableHost::extract(const uint32_t id) {
+        HostedTable *table = find(id);
+        if (!table) return {};
+        vector<uint8_t> out = imageHeader(0, 0, 1);
+        putTable(out, *table);
+        drop(*table);
+        return out;
+    }
+
+    void TableHost::import(const uint8_t *image, const size_t length) {
+        restore(image, length);
+        if (journal && length >= 24) {
+            // The first table id sits right after the 20-byte header
+            const uint32_t id = image[20] | image[21] << 8 | image[22] << 16 | static_cast<uint32_t>(image[23]) << 24;
+            record(Journal::Imported, id, vector<uint8_t>(image, image + length));
+        }
+    }
+
+    uint64_t TableHost::restore(const uint8_t *data, const size_t length) {
+        size_t pos = 0;
+        auto take = [&](const int bytes) {
+            if (length - pos < static_cast<size_t>(bytes)) throw InitError("Checkpoint is truncated");
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(data[pos++]) << (8 * i);
+            return value;
+        };
+        if (length < 4 || data[0] != 'C' || data[1] != 'K' || data[2] != 'P' || data[3] != '1') {
+            throw InitError("Not a table checkpoint");
+        }
+        pos = 4;
+        const uint64_t lsn = take(8);
+        const uint32_t savedNext = static_cast<uint32_t>(take(4));
+        for (uint64_t count = take(4); count > 0; --count) {
+            const uint32_t id = static_cast<uint32_t>(take(4));
+            const uint32_t version = static_cast<uint32_t>(take(4));
+            vector<string> names(take(1));
+            if (names.size() < 2 || names.size() > 6) {
+                throw InitError("Checkpoint table has " + to_string(names.size()) + " seats");
+            }
+            for (size_t i = 0; i < names.size(); ++i) names[i] = "P" + to_string(i);
+            const size_t gameLength = take(2);
+            if (length - pos < gameLength) throw InitError("Checkpoint is truncated");
+            auto table = make_unique<HostedTable>(id, names, false);
+            table->game = Game::unpack(data + pos, gameLength);
+            checkSeats(table->game, names.size()); // seat lookups index by player name
+            pos += gameLength;
+            const size_t pipelineLength = take(1);
+            if (length - pos < pipelineLength) throw InitError("Checkpoint is truncated");
+            table->pipeline = TurnPipeline(table->game);
+            if (pipelineLength > 0) table->pipeline.unpack(data + pos, pipelineLength);
+            pos += pipelineLength;
+            table->version = version;
+            if (HostedTable *old = find(id)) drop(*old);
+            admit(move(table));
+        }
+        if (savedNext > nextId) nextId = savedNext;
+        trim();
+        return lsn;
+    }
+
+    void TableHost::replay(const uint8_t *record, const size_t length) {
+        if (length < 5) {
+            throw InitError("Journal record too short");
+        }
+        const uint32_t id = record[1] | record[2] << 8 | record[3] << 16 | static_cast<uint32_t>(record[4]) << 24;
+        switch (static_cast<Journal>(record[0])) {
+            case Journal::Created: {
+                Game game = Game::unpack(record + 5, length - 5);
+                vector<string> names;
+                for (size_t i = 0; i < game.getPlayers().size(); ++i) {
+                    names.push_back("P" + to_string(i));
+                }
+                auto table = make_unique<HostedTable>(id, names, false);
+                table->game = game;
+                table->pipeline = TurnPipeline(table->game);
+                if (HostedTable *old = find(id)) drop(*old);
+                admit(move(table));
+                // Keep handing out ids in this host's sequence, past everything recovered
+                if (id >= nextId) nextId = id + idStride;
+                break;
+            }
+            case Journal::Answer: {
+                HostedTable *table = find(id);
+                if (!table || length < 7) {
+                    throw InitError("Journal answer for an unknown table");
+                }
+                touch(*table);
+                if (static_cast<Await>(record[5]) != table->pipeline.awaiting()) {
+                    throw InitError("Journal answer does not match the table state");
+                }
+                table->pipeline.resume(record[6]);
+                ++table->version;
+                rearm(*table);
+                break;
+            }
+            case Journal::Dropped: {
+                if (HostedTable *table = find(id)) drop(*table);
+                break;
+            }
+            case Journal::Imported:
+                restore(record + 5, length - 5);
+                break;
+            default:
+                throw InitError("Unknown journal record");
+        }
+        trim();
+    }
+
+    void TableHost::publish(HostedTable &table, FrameSink &out) {
+        // Views are shared per seat and version. Watchers that acknowledged the same view
+        // share one serialized delta, so a crowd of spectators keeping up costs one encode
+        // and one buffer in total.
+        vector<unordered_map<const TableView *, Frame>> frames(table.views.size());
+        for (Watcher &w: table.watchers) {
+            const uint8_t seat = table.seatOwnedBy(w.connection);
+            const shared_ptr<const TableView> now = table.currentView(seat);
+            Frame &frame = frames[seat == wire::SPECTATOR ? frames.size() - 1 : seat][w.acked.get()];
+            if (!frame) {
+                frame = make_shared<const vector<uint8_t>>(now->delta(*w.acked));
+            }
+            out.push(w.connection, frame, table.id);
+            w.sent.push_back(now);
+            if (w.sent.size() > MAX_UNACKED) w.sent.pop_front();
+        }
+    }
+
+    void TableHost::disconnect(const ConnectionId connection) {
+        const auto it = joined.find(connection);
+        if (it == joined.end()) return;
+        for (const uint32_t id: it->second) {
+            HostedTable *table = find(id);
+            if (!table) continue;
+            for (ConnectionId &owner: table->seatOwner) {
+                if (owner == connection) owner = 0;
+            }
+            eraseWatcher(table->watchers, connection);
+            if (table->watchers.empty() && table->pipeline.awaiting() == Await::Done) {
+                drop(*table);
+            }
+        }
+        joined.erase(it);
+    }
+
+    TableView TableHost::view(const HostedTable &table, const uint8_t viewerSeat) {
+        const Game &g = table.game;
+        const Player *decider = table.pipeline.decider();
+        TableView v;
+        v.table = table.id;
+        v.version = table.version;
+        v.awaiting = static_cast<uint8_t>(table.pipeline.awaiting());
+        v.decider = decider ? static_cast<uint8_t>(table.seatOf(decider)) : wire::SPECTATOR;
+        v.challenged = static_cast<uint8_t>(table.pipeline.challenged());
+        v.turn = g.getPlayers().empty() ? 0 : static_cast<uint8_t>(table.seatOf(g.getPlayers()[g.getTurn()]));
+        const Player *viewer = viewerSeat == wire::SPECTATOR ? nullptr : table.seatPlayer(viewerSeat);
+        const bool seesAll = viewer && viewer->getRole() == Role::Spy;
+        v.seats.resize(table.seatOwner.size());
+        for (size_t seat = 0; seat < v.seats.size(); ++seat) {
+            const Player *p = table.seatPlayer(seat);
+            SeatView &s = v.seats[seat];
+            if (!p) {
+                s.role = static_cast<uint8_t>(Role::Unknown);
+                s.coins = 0;
+                continue;
+            }
+            s.alive = 1;
+            s.role = static_cast<uint8_t>(p->getRole());
+            s.coins = seesAll || seat == viewerSeat ? static_cast<int16_t>(p->getCoins()) : -1;
+            s.flags = playerFlags(p);
+        }
+        return v;
+    }
+
+    vector<uint8_t> TableHost::snapshot(const HostedTable &table, const uint8_t viewerSeat) {
+        return view(table, viewerSeat).snapshot();
+    }
+} // namespace coup
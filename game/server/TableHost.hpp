@@ -0,0 +1,280 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Protocol.hpp"
+#include "TableView.hpp"
+#include "TimerWheel.hpp"
+#include "../Game.hpp"
+#include "../sim/TurnPipeline.hpp"
+
+namespace coup {
+    using ConnectionId = uint64_t;
+
+    /** @brief A complete frame (length prefix included), immutable and shared by every receiver. */
+    using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    /**
+     * @class FrameSink
+     * @brief Where a TableHost delivers reply and push frames.
+     */
+    class FrameSink {
+    public:
+        virtual ~FrameSink() = default;
+
+        /**
+         * @brief Queue a frame for a connection without copying it.
+         * @param stream Non-zero if only the latest frame of this stream matters:
+         *               a frame of the same stream still waiting unsent may be replaced
+         */
+        virtual void push(ConnectionId connection, Frame frame, uint32_t stream) = 0;
+
+        /**
+         * @brief Queue a reply that must be delivered as is.
+         */
+        void send(ConnectionId connection, std::vector<uint8_t> frame);
+    };
+
+    /**
+     * @struct Watcher
+     * @brief A connection following a table and what it has acknowledged.
+     */
+    struct Watcher {
+        ConnectionId connection = 0;
+        std::shared_ptr<const TableView> acked;             ///< Base of the next delta
+        std::deque<std::shared_ptr<const TableView>> sent;  ///< Views pushed since, oldest first
+    };
+
+    /**
+     * @struct HostedTable
+     * @brief One server-side game with its turn pipeline and seat bindings.
+     *
+     * Seats keep the creation order; seat i plays as "P<i>" so a seat can be
+     * found after coups reshuffle Game::getPlayers().
+     */
+    struct HostedTable {
+        uint32_t id;
+        Game game;
+        TurnPipeline pipeline;
+        uint32_t version = 0;                 ///< Bumped after every accepted answer
+        TimerId deadline = 0;                 ///< Armed turn or block clock, 0 if none
+        std::vector<ConnectionId> seatOwner;  ///< Connection bound to each seat, 0 if none
+        std::vector<Watcher> watchers;        ///< Everyone who joined, seated or not
+        std::vector<std::shared_ptr<const TableView>> views; ///< Latest view per seat, spectators' last
+        std::vector<uint8_t> packed;          ///< Game::pack() while hibernating, empty while resident
+        size_t residentBytes = 0;             ///< Estimated heap held by the game while resident
+        std::list<uint32_t>::iterator recent; ///< Place in the host's LRU list while resident
+
+        HostedTable(uint32_t id, const std::vector<std::string>& names, bool randomRoles);
+
+        /** @return Player sitting in a seat, nullptr once eliminated. */
+        Player* seatPlayer(size_t seat) const;
+
+        /** @return Seat of a player in this game. */
+        size_t seatOf(const Player* player) const;
+
+        /** @return First seat bound to a connection, or wire::SPECTATOR. */
+        uint8_t seatOwnedBy(ConnectionId connection) const;
+
+        /** @return The watcher entry of a connection, nullptr if it is not watching. */
+        Watcher* watcher(ConnectionId connection);
+
+        /**
+         * @brief Current view for a seat (or wire::SPECTATOR), shared by everyone asking at this version.
+         */
+        std::shared_ptr<const TableView> currentView(uint8_t viewerSeat);
+
+        /** @return True while the game is packed away and its players are freed. */
+        bool hibernating() const;
+    };
+
+    /**
+     * @class TableHost
+     * @brief Protocol handler owning many tables; not thread-safe.
+     *
+     * Takes one decoded request frame at a time and answers through a FrameSink,
+     * so the same host can sit behind any transport or event loop.
+     */
+    class TableHost {
+    public:
+        static constexpr size_t MAX_UNACKED = 32; ///< Pushed views kept per watcher awaiting an Ack
+        static constexpr uint64_t CLOCK_TICK_MS = 10; ///< Resolution of turn and block clocks
+
+        /**
+         * @param firstId First table id handed out
+         * @param idStride Step between ids (lets several hosts share one id space)
+         */
+        explicit TableHost(uint32_t firstId = 1, uint32_t idStride = 1);
+
+        /**
+         * @brief Handle one request frame body (opcode first).
+         *
+         * Errors are reported to the sender as Error frames, never thrown.
+         */
+        void handle(ConnectionId from, const uint8_t* body, size_t length, FrameSink& out);
+
+        /**
+         * @brief Release every seat and watch held by a closed connection.
+         */
+        void disconnect(ConnectionId connection);
+
+        /**
+         * @brief Create a table directly (as a Create request would).
+         * @throws InitError on a bad seat count
+         */
+        HostedTable& create(int seats, bool randomRoles);
+
+        /**
+         * @brief Create a table under an id chosen by the caller (a cluster coordinator).
+         * @throws InitError on a bad seat count or an id already in use
+         */
+        HostedTable& place(uint32_t id, int seats, bool randomRoles);
+
+        /**
+         * @brief Take a table out of this host for another one to import.
+         * @return Checkpoint image holding just that table, empty if it is unknown
+         */
+        std::vector<uint8_t> extract(uint32_t id);
+
+        /**
+         * @brief Adopt the tables of an image from extract() or checkpoint(), journaling them.
+         * @throws InitError on a malformed image
+         */
+        void import(const uint8_t* image, size_t length);
+
+        /** @return Table by id, nullptr if unknown; it may be hibernating (see wake()). */
+        HostedTable* find(uint32_t id);
+
+        /**
+         * @brief Cap the estimated memory held by resident games.
+         *
+         * After every request the least recently used tables beyond the budget
+         * are hibernated; a table in the middle of a block window is never evicted.
+         * @param bytes Budget, 0 for no limit
+         */
+        void setMemoryBudget(size_t bytes);
+
+        /**
+         * @brief Pack a table's game away and free its players.
+         * @return False if the table is unknown, already asleep or waiting on a block answer
+         */
+        bool hibernate(uint32_t id);
+
+        /**
+         * @brief Rebuild a hibernating table's game; requests do this on their own.
+         */
+        void wake(HostedTable& table);
+
+        /** @return Estimated bytes held by resident games. */
+        size_t residentBytes() const;
+
+        /** @return Tables currently hibernating. */
+        size_t hibernatingCount() const;
+
+        /** @brief Kinds of journal records; byte 0 of every record. */
+        enum class Journal : uint8_t {
+            Created = 1,  ///< u32 table, Game::pack() of the new game
+            Answer = 2,   ///< u32 table, u8 Await, u8 answer (from a player or a clock)
+            Dropped = 3,  ///< u32 table
+            Imported = 4  ///< u32 table, checkpoint image holding it
+        };
+
+        /**
+         * @brief Report every change to the tables as a compact record.
+         *
+         * Records are emitted in order before the change's replies are sent;
+         * feeding them to replay() on an empty host rebuilds every table.
+         * @param sink Receives each record, or an empty function to stop
+         */
+        void setJournal(std::function<void(const std::vector<uint8_t>&)> sink);
+
+        /**
+         * @brief Re-apply one journal record (crash recovery).
+         *
+         * Seats and watchers are not part of the journal: clients join again.
+         * @throws InitError on a malformed record
+         */
+        void replay(const uint8_t* record, size_t length);
+
+        /**
+         * @brief Serialize every table (game, suspension point, version) into one image.
+         * @param lsn Journal position the image is consistent with
+         */
+        std::vector<uint8_t> checkpoint(uint64_t lsn) const;
+
+        /**
+         * @brief Load an image written by checkpoint(), replacing tables with the same ids.
+         * @return Journal position to resume replay from
+         * @throws InitError on a malformed image
+         */
+        uint64_t restore(const uint8_t* data, size_t length);
+
+        size_t tableCount() const;
+
+        /**
+         * @brief Give every decision a deadline; takes effect from the next decision.
+         *
+         * When a turn clock runs out the player skips (Game::skipTurn through the
+         * pipeline, or the first legal coup when one is forced); when a block
+         * window runs out the block is declined.
+         * @param turnMs Time to choose an action, 0 for no limit
+         * @param blockMs Time to answer a block window, 0 for no limit
+         */
+        void setClocks(uint32_t turnMs, uint32_t blockMs);
+
+        /**
+         * @brief Advance the clocks and play out every expired deadline.
+         * @param nowMs Monotonic time in milliseconds
+         * @return Decisions made by the clock
+         */
+        size_t expire(uint64_t nowMs, FrameSink& out);
+
+        /** @return Armed turn and block clocks. */
+        size_t pendingDeadlines() const;
+
+        /**
+         * @brief What a seat (or a spectator) may see of a table.
+         *
+         * Coins of other seats are hidden unless the viewer plays a Spy, who
+         * sees every purse as Spy::getCoinReport does.
+         * @param viewerSeat Seat of the viewer, wire::SPECTATOR for none
+         */
+        static TableView view(const HostedTable& table, uint8_t viewerSeat);
+
+        /** @return A Snapshot frame of view(table, viewerSeat). */
+        static std::vector<uint8_t> snapshot(const HostedTable& table, uint8_t viewerSeat = wire::SPECTATOR);
+
+    private:
+        std::unordered_map<uint32_t, std::unique_ptr<HostedTable>> tables;
+        std::unordered_map<ConnectionId, std::vector<uint32_t>> joined; ///< Tables per connection
+        uint32_t nextId;
+        uint32_t idStride;
+        TimerWheel clocks;
+        uint32_t turnMs = 0;
+        uint32_t blockMs = 0;
+        std::vector<uint64_t> expired; ///< Scratch for expire()
+        std::list<uint32_t> lru;       ///< Resident tables, most recently used first
+        size_t resident = 0;           ///< Sum of residentBytes over resident tables
+        size_t budget = 0;
+        size_t sleeping = 0;
+        std::function<void(const std::vector<uint8_t>&)> journal;
+
+        void dispatch(ConnectionId from, wire::FrameReader& in, FrameSink& out);
+        HostedTable& require(uint32_t id);
+        void answer(ConnectionId from, HostedTable& table, Await expected, int value, FrameSink& out);
+        void publish(HostedTable& table, FrameSink& out);
+        void rearm(HostedTable& table);
+        void touch(HostedTable& table);
+        void trim();
+        void drop(HostedTable& table);
+        HostedTable& admit(std::unique_ptr<HostedTable> table);
+        void record(Journal kind, uint32_t id, const std::vector<uint8_t>& extra = {});
+    };
+} // namespace coup
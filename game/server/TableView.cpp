@@ -0,0 +1,103 @@
+#include "TableView.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    bool SeatView::operator==(const SeatView &other) const {
+        return alive == other.alive && role == other.role && coins == other.coins && flags == other.flags;
+    }
+
+    bool SeatView::operator!=(const SeatView &other) const {
+        return !(*this == other);
+    }
+
+    vector<uint8_t> TableView::snapshot() const {
+        wire::FrameWriter frame(wire::Op::Snapshot);
+        frame.u32(table).u32(version).u8(awaiting).u8(decider).u8(challenged).u8(turn)
+                .u8(static_cast<uint8_t>(seats.size()));
+        for (const SeatView &seat: seats) {
+            frame.u8(seat.alive).u8(seat.role).i16(seat.coins).u8(seat.flags);
+        }
+        return frame.finish();
+    }
+
+    vector<uint8_t> TableView::delta(const TableView &base) const {
+        if (base.seats.size() != seats.size()) {
+            throw ProtocolError("Delta base has a different seat count");
+        }
+        uint8_t changed = 0;
+        for (size_t i = 0; i < seats.size(); ++i) {
+            changed += seats[i] != base.seats[i];
+        }
+        wire::FrameWriter frame(wire::Op::Delta);
+        frame.u32(table).u32(base.version).u32(version).u8(awaiting).u8(decider).u8(challenged).u8(turn)
+                .u8(changed);
+        for (size_t i = 0; i < seats.size(); ++i) {
+            const SeatView &now = seats[i];
+            const SeatView &was = base.seats[i];
+            if (now == was) continue;
+            const uint8_t mask = static_cast<uint8_t>((now.alive != was.alive ? ALIVE : 0) |
+                                                      (now.role != was.role ? ROLE : 0) |
+                                                      (now.coins != was.coins ? COINS : 0) |
+                                                      (now.flags != was.flags ? FLAGS : 0));
+            frame.u8(static_cast<uint8_t>(i)).u8(mask);
+            if (mask & ALIVE) frame.u8(now.alive);
+            if (mask & ROLE) frame.u8(now.role);
+            if (mask & COINS) frame.i16(now.coins);
+            if (mask & FLAGS) frame.u8(now.flags);
+        }
+        return frame.finish();
+    }
+
+    TableView TableView::fromSnapshot(const uint8_t *body, const size_t length) {
+        wire::FrameReader in(body, length);
+        if (in.op() != wire::Op::Snapshot) {
+            throw ProtocolError("Not a snapshot");
+        }
+        TableView view;
+        view.table = in.u32();
+        view.version = in.u32();
+        view.awaiting = in.u8();
+        view.decider = in.u8();
+        view.challenged = in.u8();
+        view.turn = in.u8();
+        view.seats.resize(in.u8());
+        for (SeatView &seat: view.seats) {
+            seat.alive = in.u8();
+            seat.role = in.u8();
+            seat.coins = in.i16();
+            seat.flags = in.u8();
+        }
+        return view;
+    }
+
+    TableView TableView::applyDelta(const TableView &base, const uint8_t *body, const size_t length) {
+        wire::FrameReader in(body, length);
+        if (in.op() != wire::Op::Delta) {
+            throw ProtocolError("Not a delta");
+        }
+        TableView view = base;
+        if (in.u32() != base.table || in.u32() != base.version) {
+            throw ProtocolError("Delta does not apply to this view");
+        }
+        view.version = in.u32();
+        view.awaiting = in.u8();
+        view.decider = in.u8();
+        view.challenged = in.u8();
+        view.turn = in.u8();
+        for (uint8_t n = in.u8(); n > 0; --n) {
+            const uint8_t index = in.u8();
+            if (index >= view.seats.size()) {
+                throw ProtocolError("Delta names a missing seat");
+            }
+            SeatView &seat = view.seats[index];
+            const uint8_t mask = in.u8();
+            if (mask & ALIVE) seat.alive = in.u8();
+            if (mask & ROLE) seat.role = in.u8();
+            if (mask & COINS) seat.coins = in.i16();
+            if (mask & FLAGS) seat.flags = in.u8();
+        }
+        return view;
+    }
+} // namespace coup
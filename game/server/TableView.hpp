@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Protocol.hpp"
+
+namespace coup {
+    /**
+     * @struct SeatView
+     * @brief What one viewer can see of one seat.
+     */
+    struct SeatView {
+        uint8_t alive = 0;
+        uint8_t role = 0;
+        int16_t coins = -1;  ///< -1 when hidden from the viewer
+        uint8_t flags = 0;   ///< Bit 0 gather, 1 tax, 2 arrest, 3 bribe, 4 coup shield
+
+        bool operator==(const SeatView& other) const;
+        bool operator!=(const SeatView& other) const;
+    };
+
+    /**
+     * @struct TableView
+     * @brief One viewer's picture of a table at one version.
+     *
+     * The server encodes it as a full Snapshot or as a Delta against an older
+     * view; clients decode both back into a TableView.
+     */
+    struct TableView {
+        /** @brief Bits of a seat entry in a Delta, fields follow in this order. */
+        enum Change : uint8_t {
+            ALIVE = 1 << 0,  ///< u8
+            ROLE = 1 << 1,   ///< u8
+            COINS = 1 << 2,  ///< i16
+            FLAGS = 1 << 3   ///< u8
+        };
+
+        uint32_t table = 0;
+        uint32_t version = 0;
+        uint8_t awaiting = 0;             ///< Await value
+        uint8_t decider = wire::SPECTATOR;///< Deciding seat, SPECTATOR if none
+        uint8_t challenged = 0;           ///< ActionType under a block prompt
+        uint8_t turn = 0;                 ///< Seat whose turn it is
+        std::vector<SeatView> seats;
+
+        /**
+         * @brief Full view.
+         *
+         * Payload: u32 table, u32 version, u8 awaiting, u8 decider, u8 challenged,
+         * u8 turn, u8 seats, then per seat: u8 alive, u8 role, i16 coins, u8 flags.
+         */
+        std::vector<uint8_t> snapshot() const;
+
+        /**
+         * @brief Only what changed since base.
+         *
+         * Payload: u32 table, u32 base version, u32 version, u8 awaiting, u8 decider,
+         * u8 challenged, u8 turn, u8 changed seats, then per changed seat: u8 seat,
+         * u8 Change mask and the new value of each field in the mask.
+         * @throws ProtocolError if base has a different seat count
+         */
+        std::vector<uint8_t> delta(const TableView& base) const;
+
+        /**
+         * @brief Decode a Snapshot body (opcode first).
+         * @throws ProtocolError on a malformed body
+         */
+        static TableView fromSnapshot(const uint8_t* body, size_t length);
+
+        /**
+         * @brief Apply a Delta body (opcode first) to the view it was built against.
+         * @throws ProtocolError if the body is malformed or base is not its base version
+         */
+        static TableView applyDelta(const TableView& base, const uint8_t* body, size_t length);
+    };
+} // namespace coup
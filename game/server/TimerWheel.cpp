@@ -0,0 +1,121 @@
+#include "TimerWheel.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr uint64_t SLOT_MASK = TimerWheel::SLOTS - 1;
+        constexpr uint64_t RANGE = uint64_t{1} << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS);
+    }
+
+    TimerWheel::TimerWheel(const uint64_t start) : heads(LEVELS * SLOTS, NONE), current(start) {
+    }
+
+    TimerId TimerWheel::arm(const uint64_t deadline, const uint64_t payload) {
+        uint32_t index;
+        if (!freeNodes.empty()) {
+            index = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        Node &node = nodes[index];
+        node.deadline = deadline > current ? deadline : current + 1;
+        node.payload = payload;
+        node.armed = true;
+        place(index);
+        ++armedCount;
+        return static_cast<TimerId>(node.generation) << 32 | index;
+    }
+
+    bool TimerWheel::cancel(const TimerId timer) {
+        const uint32_t index = static_cast<uint32_t>(timer);
+        if (index >= nodes.size()) return false;
+        Node &node = nodes[index];
+        if (!node.armed || node.generation != static_cast<uint32_t>(timer >> 32)) return false;
+        unlink(index);
+        retire(index);
+        return true;
+    }
+
+    size_t TimerWheel::advance(const uint64_t now, vector<uint64_t> &expired) {
+        size_t fired = 0;
+        while (current < now) {
+            if (armedCount == 0) {
+                current = now; // nothing can fire, skip the idle ticks
+                break;
+            }
+            ++current;
+            // Refill lower levels from the level above whenever a level wraps
+            for (int level = 1; level < LEVELS && (current >> (SLOT_BITS * (level - 1)) & SLOT_MASK) == 0; ++level) {
+                cascade(level);
+            }
+            uint32_t &head = heads[current & SLOT_MASK];
+            while (head != NONE) {
+                const uint32_t index = head;
+                Node &node = nodes[index];
+                unlink(index);
+                expired.push_back(node.payload);
+                retire(index);
+                ++fired;
+            }
+        }
+        return fired;
+    }
+
+    uint64_t TimerWheel::now() const {
+        return current;
+    }
+
+    size_t TimerWheel::size() const {
+        return armedCount;
+    }
+
+    void TimerWheel::place(const uint32_t index) {
+        Node &node = nodes[index];
+        const uint64_t delta = node.deadline - current;
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= uint64_t{1} << (SLOT_BITS * (level + 1))) {
+            ++level;
+        }
+        // Beyond the top level's reach the timer parks in its furthest slot and is re-filed later
+        const uint64_t due = delta < RANGE ? node.deadline : current + RANGE - 1;
+        const size_t slot = static_cast<size_t>(due >> (SLOT_BITS * level) & SLOT_MASK);
+        node.bucket = static_cast<uint16_t>(level * SLOTS + slot);
+        node.prev = NONE;
+        node.next = heads[node.bucket];
+        if (node.next != NONE) nodes[node.next].prev = index;
+        heads[node.bucket] = index;
+    }
+
+    void TimerWheel::unlink(const uint32_t index) {
+        Node &node = nodes[index];
+        if (node.prev != NONE) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.bucket] = node.next;
+        }
+        if (node.next != NONE) nodes[node.next].prev = node.prev;
+        node.prev = node.next = NONE;
+    }
+
+    void TimerWheel::retire(const uint32_t index) {
+        Node &node = nodes[index];
+        node.armed = false;
+        if (++node.generation == 0) node.generation = 1;
+        freeNodes.push_back(index);
+        --armedCount;
+    }
+
+    void TimerWheel::cascade(const int level) {
+        const size_t slot = static_cast<size_t>(current >> (SLOT_BITS * level) & SLOT_MASK);
+        uint32_t index = heads[level * SLOTS + slot];
+        heads[level * SLOTS + slot] = NONE;
+        while (index != NONE) {
+            const uint32_t next = nodes[index].next;
+            place(index);
+            index = next;
+        }
+    }
+} // namespace coup
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace coup {
+    /** @brief Handle of an armed timer, never 0; stale handles are safe to cancel. */
+    using TimerId = uint64_t;
+
+    /**
+     * @class TimerWheel
+     * @brief Hierarchical timing wheel: O(1) arm and cancel for very many deadlines.
+     *
+     * Four levels of 64 slots cover 2^24 ticks; later deadlines wait in the top
+     * level and are re-filed as time approaches. Timers live in one pool and are
+     * linked by index, so arming and cancelling never allocate once the pool has
+     * grown. Time is counted in abstract ticks and only moves forward.
+     */
+    class TimerWheel {
+    public:
+        static constexpr int LEVELS = 4;
+        static constexpr int SLOT_BITS = 6;
+        static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+
+        /**
+         * @param start Tick the wheel starts at
+         */
+        explicit TimerWheel(uint64_t start = 0);
+
+        /**
+         * @brief Arm a timer.
+         * @param deadline Tick at which it fires; past deadlines fire on the next advance
+         * @param payload Value handed back when it fires
+         * @return Handle for cancel()
+         */
+        TimerId arm(uint64_t deadline, uint64_t payload);
+
+        /**
+         * @brief Disarm a timer.
+         * @return False if it already fired or was cancelled
+         */
+        bool cancel(TimerId timer);
+
+        /**
+         * @brief Move time forward and collect what expired, earliest tick first.
+         * @param now New current tick (ignored if not ahead)
+         * @param expired Receives the payloads of fired timers
+         * @return Number of timers fired
+         */
+        size_t advance(uint64_t now, std::vector<uint64_t>& expired);
+
+        uint64_t now() const;
+
+        /** @return Armed timers. */
+        size_t size() const;
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Node {
+            uint64_t deadline = 0;
+            uint64_t payload = 0;
+            uint32_t prev = NONE;
+            uint32_t next = NONE;
+            uint32_t generation = 1;  ///< Bumped on every fire or cancel; never 0
+            uint16_t bucket = 0;
+            bool armed = false;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> freeNodes;
+        std::vector<uint32_t> heads;   ///< LEVELS * SLOTS list heads
+        uint64_t current;
+        size_t armedCount = 0;
+
+        void place(uint32_t index);
+        void unlink(uint32_t index);
+        void retire(uint32_t index);
+        void cascade(int level);
+    };
+} // namespace coup
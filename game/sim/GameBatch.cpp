@@ -0,0 +1,98 @@
+#include "GameBatch.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    GameBatch::GameBatch(const size_t games, const int seats, const uint32_t seed)
+        : episodes(games, 0), recorded(games, 0), games(games), seats(seats) {
+        if (seats < 2 || seats > LaneBatch::MAX_SEATS) {
+            throw InitError("GameBatch supports 2 to 6 seats");
+        }
+        const size_t blockCount = (games + LaneBatch::LANES - 1) / LaneBatch::LANES;
+        blocks.reserve(blockCount);
+        for (size_t b = 0; b < blockCount; ++b) {
+            blocks.emplace_back(seats, seed + static_cast<uint32_t>(b) * 977u);
+        }
+        // Padding lanes of the last block start finished so they are never stepped
+        for (size_t g = games; g < blockCount * LaneBatch::LANES; ++g) {
+            LaneBatch &block = blocks[g / LaneBatch::LANES];
+            block.reset(static_cast<int>(g % LaneBatch::LANES), seats);
+            block.retire(static_cast<int>(g % LaneBatch::LANES));
+        }
+    }
+
+    size_t GameBatch::size() const {
+        return games;
+    }
+
+    size_t GameBatch::stepAll(const LanePolicy policy) {
+        size_t running = 0;
+        for (LaneBatch &block: blocks) {
+            running += static_cast<size_t>(block.step(policy));
+        }
+        return running;
+    }
+
+    void GameBatch::harvest() {
+        for (size_t g = 0; g < games; ++g) {
+            if (recorded[g]) continue;
+            const LaneBatch &block = blockOf(g);
+            const int lane = laneOf(g);
+            if (!block.isFinished(lane)) continue;
+
+            GameOutcome outcome;
+            outcome.game = g;
+            outcome.episode = episodes[g];
+            outcome.winner = block.winner(lane);
+            outcome.winnerRole = outcome.winner >= 0 ? block.role(lane, outcome.winner) : Role::Unknown;
+            outcome.steps = block.stepCount(lane);
+            outcome.eliminationOrder.resize(static_cast<size_t>(block.seatCount(lane)));
+            for (int s = 0; s < block.seatCount(lane); ++s) {
+                outcome.eliminationOrder[s] = block.eliminationOrder(lane, s);
+            }
+            pending.push_back(move(outcome));
+            recorded[g] = 1;
+        }
+    }
+
+    size_t GameBatch::resetFinished() {
+        harvest();
+        size_t count = 0;
+        for (size_t g = 0; g < games; ++g) {
+            if (!recorded[g]) continue;
+            blocks[g / LaneBatch::LANES].reset(laneOf(g), seats);
+            recorded[g] = 0;
+            ++episodes[g];
+            ++count;
+        }
+        return count;
+    }
+
+    vector<GameOutcome> GameBatch::collectOutcomes() {
+        harvest();
+        vector<GameOutcome> out;
+        out.swap(pending);
+        return out;
+    }
+
+    bool GameBatch::isFinished(const size_t game) const {
+        return blockOf(game).isFinished(laneOf(game));
+    }
+
+    int GameBatch::winner(const size_t game) const {
+        return blockOf(game).winner(laneOf(game));
+    }
+
+    int GameBatch::coins(const size_t game, const int seat) const {
+        return blockOf(game).coins(laneOf(game), seat);
+    }
+
+    const LaneBatch &GameBatch::blockOf(const size_t game) const {
+        return blocks.at(game / LaneBatch::LANES);
+    }
+
+    int GameBatch::laneOf(const size_t game) const {
+        return static_cast<int>(game % LaneBatch::LANES);
+    }
+} // namespace coup
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "LaneBatch.hpp"
+
+namespace coup {
+    /**
+     * @struct GameOutcome
+     * @brief Result of one finished game in a GameBatch.
+     */
+    struct GameOutcome {
+        size_t game = 0;        ///< Game index inside the batch
+        uint32_t episode = 0;   ///< How many times this slot was reset before this game
+        int winner = -1;        ///< Winning seat, -1 if the game hit the step limit
+        Role winnerRole = Role::Unknown; ///< Role of the winning seat
+        int steps = 0;          ///< Actions played
+        std::vector<int> eliminationOrder; ///< Per seat: 1 = first out, 0 = survived
+    };
+
+    /**
+     * @class GameBatch
+     * @brief Owns many independent games in one contiguous arena of LaneBatch blocks.
+     *
+     * Games follow coup::Game rules (see LaneBatch) without a Game object, a
+     * player vector or heap-allocated Players per game. Game g lives in block
+     * g / LANES, lane g % LANES.
+     */
+    class GameBatch {
+    public:
+        /**
+         * @brief Allocate the arena and reset every game.
+         * @param games Number of games (rounded up to whole blocks internally)
+         * @param seats Players per game
+         * @param seed Base seed for the policies' random streams
+         * @throws InitError on a bad seat count
+         */
+        GameBatch(size_t games, int seats, uint32_t seed = 1);
+
+        /** @return Number of games in the batch. */
+        size_t size() const;
+
+        /**
+         * @brief Apply one policy action to every running game.
+         * @param policy Action chooser
+         * @return Number of games still running
+         */
+        size_t stepAll(LanePolicy policy = randomLanePolicy);
+
+        /**
+         * @brief Record outcomes of finished games and start fresh ones in their slots.
+         * @return Number of games reset
+         */
+        size_t resetFinished();
+
+        /**
+         * @brief Outcomes recorded since the last call, including games still unreset.
+         * Each finished game is reported exactly once.
+         */
+        std::vector<GameOutcome> collectOutcomes();
+
+        //------------------------------------------------------------------------
+        // Per-game queries
+        //------------------------------------------------------------------------
+
+        bool isFinished(size_t game) const;   ///< True once the game has ended
+        int winner(size_t game) const;        ///< Winning seat, -1 if none
+        int coins(size_t game, int seat) const; ///< Coins of a seat
+        const LaneBatch& blockOf(size_t game) const; ///< Block holding a game
+        int laneOf(size_t game) const;        ///< Lane of a game inside its block
+
+    private:
+        std::vector<LaneBatch> blocks;   ///< Contiguous arena of game blocks
+        std::vector<uint32_t> episodes;  ///< Reset count per game slot
+        std::vector<uint8_t> recorded;   ///< 1 if the current episode's outcome was recorded
+        std::vector<GameOutcome> pending; ///< Outcomes waiting for collectOutcomes
+        size_t games;
+        int seats;
+
+        void harvest();
+    };
+} // namespace coup
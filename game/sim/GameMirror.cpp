@@ -0,0 +1,81 @@
+#include "GameMirror.hpp"
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include "../GameExceptions.hpp"
+#include "../player/Player.hpp"
+
+using namespace std;
+
+namespace coup {
+    static_assert(is_trivially_copyable<GameSnapshot>::value, "snapshots are copied as words");
+
+    string GameSnapshot::nameOf(const size_t seat) const {
+        return string(seats[seat].name, strnlen(seats[seat].name, NAME_LENGTH));
+    }
+
+    bool GameSnapshot::over() const {
+        return playerCount == 1;
+    }
+
+    //------------------------------------------------------------------------------
+    // Writer
+    //------------------------------------------------------------------------------
+
+    void GameMirror::publish(const Game &game) {
+        const vector<Player *> &players = game.getPlayers();
+        if (players.size() > GameSnapshot::MAX_PLAYERS) {
+            throw InitError("GameMirror holds at most 6 players");
+        }
+        GameSnapshot snapshot;
+        const uint64_t s = sequence.load(memory_order_relaxed);
+        snapshot.version = s / 2;
+        snapshot.turnCount = game.getTurnCount();
+        snapshot.turn = static_cast<uint8_t>(game.getTurn());
+        snapshot.playerCount = static_cast<uint8_t>(players.size());
+        for (size_t i = 0; i < players.size(); ++i) {
+            const Player *p = players[i];
+            GameSnapshot::Seat &seat = snapshot.seats[i];
+            strncpy(seat.name, p->getName().c_str(), GameSnapshot::NAME_LENGTH);
+            seat.role = static_cast<uint8_t>(p->getRole());
+            seat.turnsLeft = static_cast<uint8_t>(p->getNumOfTurns());
+            seat.flags = static_cast<uint8_t>(p->isGatherAllow() | p->isTaxAllow() << 1 | p->isArrestAllow() << 2 |
+                                              p->isBribeAllow() << 3 | p->isCoupShieldActive() << 4);
+            seat.coins = static_cast<int16_t>(p->getCoins());
+        }
+
+        uint64_t buffer[WORDS] = {};
+        memcpy(buffer, &snapshot, sizeof(GameSnapshot));
+
+        // Odd sequence first, so a reader that sees any new word also sees the odd count
+        sequence.store(s + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(buffer[i], memory_order_relaxed);
+        sequence.store(s + 2, memory_order_release);
+    }
+
+    //------------------------------------------------------------------------------
+    // Readers
+    //------------------------------------------------------------------------------
+
+    bool GameMirror::tryRead(GameSnapshot &out) const {
+        const uint64_t before = sequence.load(memory_order_acquire);
+        if (before & 1u) return false;
+        uint64_t buffer[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) buffer[i] = words[i].load(memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (sequence.load(memory_order_relaxed) != before) return false;
+        memcpy(&out, buffer, sizeof(GameSnapshot));
+        return true;
+    }
+
+    GameSnapshot GameMirror::read() const {
+        GameSnapshot snapshot;
+        while (!tryRead(snapshot)) this_thread::yield();
+        return snapshot;
+    }
+
+    uint64_t GameMirror::version() const {
+        return sequence.load(memory_order_acquire) / 2;
+    }
+} // namespace coup
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @struct GameSnapshot
+     * @brief Everything a spectator can see of a Game, in a fixed-size copyable block.
+     */
+    struct GameSnapshot {
+        static constexpr size_t MAX_PLAYERS = 6;
+        static constexpr size_t NAME_LENGTH = 15;  ///< Longer names are cut
+
+        /**
+         * @struct Seat
+         * @brief One player still in the game.
+         */
+        struct Seat {
+            char name[NAME_LENGTH + 1] = {};
+            uint8_t role = 0;       ///< Role value
+            uint8_t turnsLeft = 0;
+            uint8_t flags = 0;      ///< Bit 0 gather, 1 tax, 2 arrest, 3 bribe, 4 coup shield
+            int16_t coins = 0;
+        };
+
+        uint64_t version = 0;       ///< Publications before this one
+        int32_t turnCount = 0;
+        uint8_t turn = 0;           ///< Index into seats of the player to move
+        uint8_t playerCount = 0;
+        Seat seats[MAX_PLAYERS];
+
+        /** @return The name of a seat as a string. */
+        std::string nameOf(size_t seat) const;
+
+        /** @return True when one player is left. */
+        bool over() const;
+    };
+
+    /**
+     * @class GameMirror
+     * @brief Seqlock that publishes GameSnapshots from one writer to any number of reader threads.
+     *
+     * The thread that owns a Game calls publish() after each committed change,
+     * never in the middle of one, so readers cannot observe players half way
+     * through an erase. Readers copy the latest snapshot without locks: they
+     * retry only if a publish overlapped the copy, and the writer never waits
+     * for them. The snapshot is stored as atomic words, so a torn copy is
+     * detected and discarded rather than being a data race.
+     */
+    class GameMirror {
+    public:
+        GameMirror() = default;
+        GameMirror(const GameMirror&) = delete;
+        GameMirror& operator=(const GameMirror&) = delete;
+
+        /**
+         * @brief Writer only: capture the visible state of a game.
+         * @throws InitError if the game has more than GameSnapshot::MAX_PLAYERS players
+         */
+        void publish(const Game& game);
+
+        /**
+         * @brief Latest published snapshot; safe from any thread.
+         */
+        GameSnapshot read() const;
+
+        /**
+         * @brief One attempt at read().
+         * @return False if a publish was under way; out is then unspecified
+         */
+        bool tryRead(GameSnapshot& out) const;
+
+        /** @return Snapshots published so far. */
+        uint64_t version() const;
+
+    private:
+        static constexpr size_t WORDS = (sizeof(GameSnapshot) + 7) / 8;
+
+        alignas(64) std::atomic<uint64_t> sequence{0}; ///< Odd while a publish is under way
+        std::atomic<uint64_t> words[WORDS] = {};
+    };
+} // namespace coup
@@ -0,0 +1,314 @@
+#include "LaneBatch.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr uint32_t bit(const ActionType action) {
+            return 1u << static_cast<int>(action);
+        }
+
+        constexpr uint32_t TARGETED = bit(ActionType::Arrest) | bit(ActionType::Sanction) | bit(ActionType::Coup);
+
+        // Same order as createRoleByIndex in Game.cpp
+        constexpr Role DEFAULT_ROLES[LaneBatch::MAX_SEATS] = {
+            Role::Governor, Role::Spy, Role::Baron, Role::General, Role::Judge, Role::Merchant
+        };
+
+        /**
+         * @brief Index of the n-th set bit of a mask (n is zero based).
+         */
+        int nthSetBit(uint32_t mask, uint32_t n) {
+            for (int i = 0; mask; ++i, mask >>= 1) {
+                if ((mask & 1u) && n-- == 0) return i;
+            }
+            return -1;
+        }
+
+        int popCount(uint32_t mask) {
+            int count = 0;
+            for (; mask; mask &= mask - 1) ++count;
+            return count;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Built-in policies
+    //------------------------------------------------------------------------------
+
+    LaneStep randomLanePolicy(const LaneBatch &batch, const int lane, const LaneChoice &choice,
+                              const uint32_t random) {
+        const auto action = static_cast<ActionType>(
+            nthSetBit(choice.legal, (random & 0xFFFFu) % static_cast<uint32_t>(popCount(choice.legal))));
+        int target = -1;
+        if (bit(action) & TARGETED) {
+            const uint32_t pool = action == ActionType::Arrest ? choice.arrestTargets : choice.targets;
+            target = nthSetBit(pool, (random >> 16) % static_cast<uint32_t>(popCount(pool)));
+        }
+        return LaneStep{action, target, batch.currentSeat(lane)};
+    }
+
+    LaneStep greedyLanePolicy(const LaneBatch &batch, const int lane, const LaneChoice &choice,
+                              const uint32_t random) {
+        const int self = batch.currentSeat(lane);
+        if (choice.legal & bit(ActionType::Coup)) {
+            int richest = -1;
+            for (int s = 0; s < LaneBatch::MAX_SEATS; ++s) {
+                if ((choice.targets >> s & 1u) && (richest < 0 || batch.coins(lane, s) > batch.coins(lane, richest))) {
+                    richest = s;
+                }
+            }
+            return LaneStep{ActionType::Coup, richest, self};
+        }
+        for (const ActionType action: {ActionType::Ability, ActionType::Tax, ActionType::Gather}) {
+            if (choice.legal & bit(action)) {
+                return LaneStep{action, -1, self};
+            }
+        }
+        return randomLanePolicy(batch, lane, choice, random);
+    }
+
+    //------------------------------------------------------------------------------
+    // Construction / reset
+    //------------------------------------------------------------------------------
+
+    LaneBatch::LaneBatch(const int seatCount, const uint32_t seed) {
+        for (int lane = 0; lane < LANES; ++lane) {
+            // xorshift state must never be zero
+            rng[lane] = (seed + 1u) * 2654435761u ^ (static_cast<uint32_t>(lane) + 1u) * 40503u;
+            if (rng[lane] == 0) rng[lane] = 0x9E3779B9u;
+            reset(lane, seatCount);
+        }
+    }
+
+    void LaneBatch::reset(const int lane, const int seatCount) {
+        if (seatCount < 2 || seatCount > MAX_SEATS) {
+            throw InitError("LaneBatch supports 2 to 6 seats");
+        }
+        reset(lane, vector<Role>(DEFAULT_ROLES, DEFAULT_ROLES + seatCount));
+    }
+
+    void LaneBatch::reset(const int lane, const vector<Role> &seatRoles) {
+        const int seatCount = static_cast<int>(seatRoles.size());
+        if (seatCount < 2 || seatCount > MAX_SEATS) {
+            throw InitError("LaneBatch supports 2 to 6 seats");
+        }
+        for (int s = 0; s < MAX_SEATS; ++s) {
+            const bool seated = s < seatCount;
+            coinsOf[s][lane] = 0;
+            turnsLeft[s][lane] = 1;
+            flags[s][lane] = seated ? static_cast<uint8_t>(DEBUFF_MASK | ALIVE) : 0;
+            lastArrested[s][lane] = -1;
+            outOrder[s][lane] = 0;
+            roles[s][lane] = static_cast<uint8_t>(seated ? seatRoles[s] : Role::Unknown);
+        }
+        current[lane] = 0;
+        seats[lane] = seatCount;
+        alive[lane] = seatCount;
+        steps[lane] = 0;
+        winners[lane] = -1;
+        last[lane] = LaneStep{};
+    }
+
+    void LaneBatch::retire(const int lane) {
+        steps[lane] = MAX_STEPS;
+        winners[lane] = -1;
+    }
+
+    //------------------------------------------------------------------------------
+    // Stepping
+    //------------------------------------------------------------------------------
+
+    uint32_t LaneBatch::nextRandom(const int lane) {
+        uint32_t x = rng[lane];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        rng[lane] = x;
+        return x;
+    }
+
+    int LaneBatch::step(const LanePolicy policy) {
+        // Gather the acting seat of every lane into contiguous columns
+        alignas(64) int32_t curCoins[LANES];
+        alignas(64) uint32_t curFlags[LANES];
+        alignas(64) uint32_t curRole[LANES];
+        alignas(64) int32_t curLast[LANES];
+        for (int l = 0; l < LANES; ++l) {
+            const int s = current[l];
+            curCoins[l] = coinsOf[s][l];
+            curFlags[l] = flags[s][l];
+            curRole[l] = roles[s][l];
+            curLast[l] = lastArrested[s][l];
+        }
+
+        // Valid targets: alive, not self; arrest also needs the target to be able to pay
+        alignas(64) uint32_t targets[LANES] = {};
+        alignas(64) uint32_t arrestTargets[LANES] = {};
+        for (int s = 0; s < MAX_SEATS; ++s) {
+            for (int l = 0; l < LANES; ++l) {
+                const uint32_t ok = ((flags[s][l] & ALIVE) != 0) & (s != current[l]);
+                const int32_t need = roles[s][l] == static_cast<uint8_t>(Role::General) ? 0
+                                     : roles[s][l] == static_cast<uint8_t>(Role::Merchant) ? 2 : 1;
+                const uint32_t canArrest = ok & (coinsOf[s][l] >= need) & (curLast[l] != s);
+                targets[l] |= ok << s;
+                arrestTargets[l] |= canArrest << s;
+            }
+        }
+
+        // Legal action mask per lane, branch-free so it vectorizes
+        alignas(64) uint32_t legal[LANES];
+        for (int l = 0; l < LANES; ++l) {
+            const int32_t c = curCoins[l];
+            const uint32_t hasTarget = targets[l] != 0;
+            uint32_t m = bit(ActionType::Skip);
+            m |= (curFlags[l] & CAN_GATHER) ? bit(ActionType::Gather) : 0u;
+            m |= (curFlags[l] & CAN_TAX) ? bit(ActionType::Tax) : 0u;
+            m |= (c >= Game::BRIBE_COST) ? bit(ActionType::Bribe) : 0u;
+            m |= ((curFlags[l] & CAN_ARREST) && arrestTargets[l]) ? bit(ActionType::Arrest) : 0u;
+            m |= (c >= Game::SANCTION_COST && hasTarget) ? bit(ActionType::Sanction) : 0u;
+            m |= (c >= Game::COUP_COST && hasTarget) ? bit(ActionType::Coup) : 0u;
+            m |= (curRole[l] == static_cast<uint32_t>(Role::Baron) && c >= 3) ? bit(ActionType::Ability) : 0u;
+            m = (c >= Game::FORCE_COUP) ? bit(ActionType::Coup) : m;
+            const bool running = winners[l] < 0 && steps[l] < MAX_STEPS;
+            legal[l] = running ? m : 0u;
+        }
+
+        // Pick and apply; this part is per-lane scalar work
+        int running = 0;
+        for (int l = 0; l < LANES; ++l) {
+            if (!legal[l]) {
+                last[l] = LaneStep{};
+                continue;
+            }
+            const LaneChoice choice{legal[l], targets[l], arrestTargets[l]};
+            const LaneStep picked = policy(*this, l, choice, nextRandom(l));
+            const bool targeted = (bit(picked.action) & TARGETED) != 0;
+            const uint32_t pool = picked.action == ActionType::Arrest ? choice.arrestTargets : choice.targets;
+            if (!(choice.legal & bit(picked.action)) ||
+                (targeted && (picked.target < 0 || !(pool >> picked.target & 1u)))) {
+                throw ActionError("Lane policy chose an illegal action");
+            }
+            last[l] = LaneStep{picked.action, targeted ? picked.target : -1, current[l]};
+            apply(l, picked.action, last[l].target);
+            ++steps[l];
+            advanceTurn(l);
+            if (!isFinished(l)) ++running;
+        }
+        return running;
+    }
+
+    void LaneBatch::runToEnd(const LanePolicy policy) {
+        while (step(policy) > 0) {
+        }
+    }
+
+    /**
+     * @brief Mirror of Player::playerUsedTurn: consume a turn and clear debuffs.
+     */
+    void LaneBatch::usedTurn(const int lane, const int seat) {
+        if (turnsLeft[seat][lane] > 0) {
+            --turnsLeft[seat][lane];
+            flags[seat][lane] |= DEBUFF_MASK;
+        }
+    }
+
+    void LaneBatch::apply(const int lane, const ActionType action, const int target) {
+        const int s = current[lane];
+        int32_t &own = coinsOf[s][lane];
+        switch (action) {
+            case ActionType::Gather:
+                own += 1;
+                usedTurn(lane, s);
+                break;
+            case ActionType::Tax:
+                own += roles[s][lane] == static_cast<uint8_t>(Role::Governor) ? 3 : 2;
+                usedTurn(lane, s);
+                break;
+            case ActionType::Bribe:
+                own -= Game::BRIBE_COST;
+                turnsLeft[s][lane] += 1;
+                break;
+            case ActionType::Arrest: {
+                const auto targetRole = static_cast<Role>(roles[target][lane]);
+                if (targetRole == Role::Merchant) {
+                    coinsOf[target][lane] -= 2;
+                } else if (targetRole != Role::General) {
+                    coinsOf[target][lane] -= 1;
+                    own += 1;
+                }
+                usedTurn(lane, s);
+                lastArrested[s][lane] = static_cast<int8_t>(target);
+                break;
+            }
+            case ActionType::Sanction: {
+                const auto targetRole = static_cast<Role>(roles[target][lane]);
+                own -= Game::SANCTION_COST;
+                if (targetRole == Role::Baron) coinsOf[target][lane] += 1;
+                flags[target][lane] &= static_cast<uint8_t>(~(CAN_GATHER | CAN_TAX));
+                usedTurn(lane, s);
+                if (targetRole == Role::Judge && own >= 1) own -= 1; // Judge retaliation
+                break;
+            }
+            case ActionType::Coup:
+                own -= Game::COUP_COST;
+                flags[target][lane] &= static_cast<uint8_t>(~ALIVE);
+                --alive[lane];
+                outOrder[target][lane] = static_cast<uint8_t>(seats[lane] - alive[lane]);
+                usedTurn(lane, s);
+                break;
+            case ActionType::Ability: // Baron investment: pay 3, gain 6
+                own += 3;
+                usedTurn(lane, s);
+                break;
+            case ActionType::Skip:
+                flags[s][lane] |= DEBUFF_MASK;
+                usedTurn(lane, s);
+                break;
+        }
+    }
+
+    /**
+     * @brief Mirror of Game::advanceTurnIfNeeded / Game::nextTurn for one lane.
+     */
+    void LaneBatch::advanceTurn(const int lane) {
+        if (alive[lane] == 1) {
+            for (int s = 0; s < seats[lane]; ++s) {
+                if (flags[s][lane] & ALIVE) winners[lane] = s;
+            }
+            return;
+        }
+        const int s = current[lane];
+        if (turnsLeft[s][lane] > 0) return;
+
+        turnsLeft[s][lane] = 1;
+        flags[s][lane] |= DEBUFF_MASK;
+        int next = s;
+        do {
+            next = (next + 1) % seats[lane];
+        } while (!(flags[next][lane] & ALIVE));
+        current[lane] = next;
+        if (roles[s][lane] == static_cast<uint8_t>(Role::Merchant) && coinsOf[s][lane] >= 3) {
+            coinsOf[s][lane] += 1;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Queries
+    //------------------------------------------------------------------------------
+
+    bool LaneBatch::isFinished(const int lane) const {
+        return winners[lane] >= 0 || steps[lane] >= MAX_STEPS;
+    }
+
+    int LaneBatch::winner(const int lane) const { return winners[lane]; }
+    int LaneBatch::currentSeat(const int lane) const { return current[lane]; }
+    int LaneBatch::seatCount(const int lane) const { return seats[lane]; }
+    int LaneBatch::stepCount(const int lane) const { return steps[lane]; }
+    int LaneBatch::coins(const int lane, const int seat) const { return coinsOf[seat][lane]; }
+    bool LaneBatch::isAlive(const int lane, const int seat) const { return flags[seat][lane] & ALIVE; }
+    int LaneBatch::eliminationOrder(const int lane, const int seat) const { return outOrder[seat][lane]; }
+    Role LaneBatch::role(const int lane, const int seat) const { return static_cast<Role>(roles[seat][lane]); }
+    LaneStep LaneBatch::lastStep(const int lane) const { return last[lane]; }
+} // namespace coup
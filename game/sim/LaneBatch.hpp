@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @struct LaneStep
+     * @brief Action taken by one lane during the last LaneBatch::step.
+     */
+    struct LaneStep {
+        ActionType action = ActionType::Skip; ///< Action that was applied
+        int target = -1;                      ///< Target seat, -1 for self actions
+        int actor = -1;                       ///< Seat that acted, -1 if the lane was idle
+    };
+
+    /**
+     * @struct LaneChoice
+     * @brief Legal options of the acting seat in one lane, as bit masks.
+     */
+    struct LaneChoice {
+        uint32_t legal = 0;         ///< Bit per ActionType that may be played
+        uint32_t targets = 0;       ///< Seats that may be sanctioned or couped
+        uint32_t arrestTargets = 0; ///< Seats that may be arrested
+    };
+
+    class LaneBatch;
+
+    /**
+     * @brief Picks the action for one lane. Must return a legal action and target.
+     * @param batch Batch being stepped (read-only)
+     * @param lane Lane to decide for
+     * @param choice Legal options of the acting seat
+     * @param random Fresh 32-bit random value for this decision
+     */
+    using LanePolicy = LaneStep (*)(const LaneBatch& batch, int lane, const LaneChoice& choice, uint32_t random);
+
+    /**
+     * @brief Uniform over legal actions, then uniform over that action's targets.
+     */
+    LaneStep randomLanePolicy(const LaneBatch& batch, int lane, const LaneChoice& choice, uint32_t random);
+
+    /**
+     * @brief Coup the richest opponent when possible, otherwise grow coins as fast as allowed.
+     */
+    LaneStep greedyLanePolicy(const LaneBatch& batch, int lane, const LaneChoice& choice, uint32_t random);
+
+    /**
+     * @class LaneBatch
+     * @brief Runs LANES independent games in lockstep, one random action per lane per step.
+     *
+     * State is stored seat-major and lane-minor (coins[seat][lane]) so the legality
+     * and turn kernels are plain loops over lanes that the compiler can vectorize.
+     * Rules follow Game/Player exactly: the same costs, Merchant/General arrest
+     * rules, Baron and Judge sanction effects, the Merchant passive in nextTurn and
+     * the forced coup at FORCE_COUP coins. Block prompts are GUI-only and are
+     * treated as declined. Actions are chosen by a LanePolicy (random by default).
+     */
+    class LaneBatch {
+    public:
+        static constexpr int LANES = 16;      ///< Games advanced together
+        static constexpr int MAX_SEATS = 6;   ///< Largest table size
+        static constexpr int MAX_STEPS = 2000; ///< Steps before a lane is abandoned
+
+        /**
+         * @brief Create a batch with every lane reset to the given table size.
+         * @param seats Players per game, roles in Game(names) order
+         * @param seed Seed for the per-lane random policies
+         */
+        explicit LaneBatch(int seats = MAX_SEATS, uint32_t seed = 1);
+
+        /**
+         * @brief Reset one lane with roles in Game(names) order.
+         * @param lane Lane index
+         * @param seats Players in the game (2..MAX_SEATS)
+         * @throws InitError on a bad seat count
+         */
+        void reset(int lane, int seats);
+
+        /**
+         * @brief Reset one lane with explicit roles.
+         * @param lane Lane index
+         * @param roles Role per seat (2..MAX_SEATS entries)
+         * @throws InitError on a bad seat count
+         */
+        void reset(int lane, const std::vector<Role>& roles);
+
+        /**
+         * @brief Mark a lane finished without a winner so it is no longer stepped.
+         * @param lane Lane index
+         */
+        void retire(int lane);
+
+        /**
+         * @brief Apply one policy action in every running lane.
+         * @param policy Action chooser, random if not given
+         * @return Number of lanes still running after the step
+         */
+        int step(LanePolicy policy = randomLanePolicy);
+
+        /**
+         * @brief Step until every lane has finished.
+         * @param policy Action chooser, random if not given
+         */
+        void runToEnd(LanePolicy policy = randomLanePolicy);
+
+        //------------------------------------------------------------------------
+        // Lane queries
+        //------------------------------------------------------------------------
+
+        bool isFinished(int lane) const;     ///< True if the lane has a winner or timed out
+        int winner(int lane) const;          ///< Winning seat, -1 if none
+        int currentSeat(int lane) const;     ///< Seat whose turn it is
+        int seatCount(int lane) const;       ///< Seats the lane was reset with
+        int stepCount(int lane) const;       ///< Actions applied since reset
+        int coins(int lane, int seat) const; ///< Coins held by a seat
+        bool isAlive(int lane, int seat) const; ///< False once a seat was couped
+        int eliminationOrder(int lane, int seat) const; ///< 1 for the first seat couped, 0 if alive
+        Role role(int lane, int seat) const; ///< Role of a seat
+        LaneStep lastStep(int lane) const;   ///< Action applied by the last step
+
+    private:
+        static constexpr uint8_t CAN_GATHER = 1;
+        static constexpr uint8_t CAN_TAX = 2;
+        static constexpr uint8_t CAN_ARREST = 4;
+        static constexpr uint8_t ALIVE = 8;
+        static constexpr uint8_t DEBUFF_MASK = CAN_GATHER | CAN_TAX | CAN_ARREST;
+
+        // Seat-major state, one column per lane
+        alignas(64) int32_t coinsOf[MAX_SEATS][LANES]{};
+        alignas(64) int32_t turnsLeft[MAX_SEATS][LANES]{};
+        alignas(64) uint8_t flags[MAX_SEATS][LANES]{};
+        alignas(64) int8_t lastArrested[MAX_SEATS][LANES]{};
+        alignas(64) uint8_t roles[MAX_SEATS][LANES]{};
+        alignas(64) uint8_t outOrder[MAX_SEATS][LANES]{};
+
+        // Per-lane state
+        alignas(64) int32_t current[LANES]{};
+        alignas(64) int32_t seats[LANES]{};
+        alignas(64) int32_t alive[LANES]{};
+        alignas(64) int32_t steps[LANES]{};
+        alignas(64) int32_t winners[LANES]{};
+        alignas(64) uint32_t rng[LANES]{};
+        LaneStep last[LANES]{};
+
+        uint32_t nextRandom(int lane);
+        void usedTurn(int lane, int seat);
+        void apply(int lane, ActionType action, int target);
+        void advanceTurn(int lane);
+    };
+} // namespace coup
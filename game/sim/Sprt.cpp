@@ -0,0 +1,204 @@
+#include "Sprt.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "WorkStealingPool.hpp"
+#include "../GameExceptions.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr uint64_t MIN_PAIRS = 6;        // no verdict before the candidate has played every role
+        constexpr double VARIANCE_FLOOR = 1e-3;
+
+        double expectedScore(const double elo) {
+            return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+        }
+
+        size_t roleSlot(const Role role) {
+            return static_cast<size_t>(find(ROLE_CYCLE.begin(), ROLE_CYCLE.end(), role) - ROLE_CYCLE.begin());
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Statistics
+    //------------------------------------------------------------------------------
+
+    void PairStats::add(const double first, const double second) {
+        const long outcome = lround((first + second) * 2.0);
+        if (outcome < 0 || outcome > 4) {
+            throw InitError("Game scores must lie between 0 and 1");
+        }
+        ++counts[static_cast<size_t>(outcome)];
+    }
+
+    void PairStats::merge(const PairStats &other) {
+        for (size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+    }
+
+    uint64_t PairStats::pairs() const {
+        uint64_t n = 0;
+        for (const uint64_t c: counts) n += c;
+        return n;
+    }
+
+    const array<uint64_t, 5> &PairStats::outcomes() const {
+        return counts;
+    }
+
+    double PairStats::mean() const {
+        const uint64_t n = pairs();
+        if (n == 0) return 0.5;
+        double sum = 0.0;
+        for (size_t i = 0; i < counts.size(); ++i) sum += static_cast<double>(counts[i]) * (i / 4.0);
+        return sum / static_cast<double>(n);
+    }
+
+    double PairStats::variance() const {
+        const uint64_t n = pairs();
+        if (n == 0) return 0.0;
+        const double m = mean();
+        double sum = 0.0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            sum += static_cast<double>(counts[i]) * (i / 4.0 - m) * (i / 4.0 - m);
+        }
+        return sum / static_cast<double>(n);
+    }
+
+    double PairStats::elo() const {
+        const double m = min(max(mean(), 0.001), 0.999);
+        return max(-1200.0, min(1200.0, -400.0 * log10(1.0 / m - 1.0)));
+    }
+
+    double PairStats::llr(const double elo0, const double elo1) const {
+        const uint64_t n = pairs();
+        if (n == 0) return 0.0;
+        const double s0 = expectedScore(elo0);
+        const double s1 = expectedScore(elo1);
+        const double v = max(variance(), VARIANCE_FLOOR);
+        return static_cast<double>(n) * (s1 - s0) * (2.0 * mean() - s0 - s1) / (2.0 * v);
+    }
+
+    //------------------------------------------------------------------------------
+    // Test
+    //------------------------------------------------------------------------------
+
+    Sprt::Sprt(const BotRegistry &registry, string candidate, string baseline, Options options)
+        : registry(registry), candidate(move(candidate)), baseline(move(baseline)), options(options) {
+        if (!registry.has(this->candidate)) throw InitError("Unknown bot: " + this->candidate);
+        if (!registry.has(this->baseline)) throw InitError("Unknown bot: " + this->baseline);
+        if (!(options.elo > 0.0)) {
+            throw InitError("The Elo difference to detect must be positive");
+        }
+        if (!(options.alpha > 0.0 && options.alpha < 0.5 && options.beta > 0.0 && options.beta < 0.5)) {
+            throw InitError("Error rates must lie between 0 and 0.5");
+        }
+    }
+
+    array<Role, 2> Sprt::pairRoles(const uint64_t pair) {
+        const size_t first = static_cast<size_t>(pair % ROLE_CYCLE.size());
+        const size_t offset = 1 + static_cast<size_t>(pair / ROLE_CYCLE.size() % (ROLE_CYCLE.size() - 1));
+        return {ROLE_CYCLE[first], ROLE_CYCLE[(first + offset) % ROLE_CYCLE.size()]};
+    }
+
+    double Sprt::lower() const {
+        return log(options.beta / (1.0 - options.alpha));
+    }
+
+    double Sprt::upper() const {
+        return log((1.0 - options.beta) / options.alpha);
+    }
+
+    double Sprt::llrStronger() const {
+        return results.llr(0.0, options.elo);
+    }
+
+    double Sprt::llrWeaker() const {
+        return results.llr(0.0, -options.elo);
+    }
+
+    Sprt::Verdict Sprt::check() const {
+        if (results.pairs() < MIN_PAIRS) return Verdict::Undecided;
+        const double stronger = llrStronger();
+        const double weaker = llrWeaker();
+        if (stronger >= upper()) return Verdict::Stronger;
+        if (weaker >= upper()) return Verdict::Weaker;
+        if (stronger <= lower() && weaker <= lower()) return Verdict::Equal;
+        return Verdict::Undecided;
+    }
+
+    Sprt::Verdict Sprt::run(const function<void(const Sprt &)> &onBatch) {
+        results = PairStats();
+        wins.fill(0);
+        played.fill(0);
+        decided = Verdict::Undecided;
+
+        WorkStealingPool pool(options.threads);
+        vector<BatchPolicy> candidates, baselines;
+        for (size_t w = 0; w < pool.threads(); ++w) {
+            candidates.push_back(registry.create(candidate));
+            baselines.push_back(registry.create(baseline));
+        }
+
+        while (decided == Verdict::Undecided && results.pairs() < options.maxPairs) {
+            const uint64_t first = results.pairs();
+            const size_t count = static_cast<size_t>(
+                min<uint64_t>(max<size_t>(1, options.batch) * pool.threads(), options.maxPairs - first));
+            // Game 0 seats the candidate first, game 1 the baseline, with the same roles and opening
+            vector<array<SeatedResult, 2>> out(count);
+            pool.run(count, [&](const size_t task, const size_t worker) {
+                const uint64_t pair = first + task;
+                const array<Role, 2> roles = pairRoles(pair);
+                const uint64_t seed = options.seed * 0x9E3779B97F4A7C15ull ^ pair;
+                out[task][0] = playSeated({&candidates[worker], &baselines[worker]}, {roles[0], roles[1]},
+                                          options.maxDecisions, options.openingMoves, seed);
+                out[task][1] = playSeated({&baselines[worker], &candidates[worker]}, {roles[0], roles[1]},
+                                          options.maxDecisions, options.openingMoves, seed);
+            });
+            // Taken in pair order, so stopping does not depend on which thread finished first
+            for (size_t task = 0; task < count && decided == Verdict::Undecided; ++task) {
+                const array<Role, 2> roles = pairRoles(first + task);
+                for (size_t game = 0; game < 2; ++game) {
+                    const SeatedResult &r = out[task][game];
+                    const size_t slot = roleSlot(roles[game]);
+                    ++played[slot];
+                    wins[slot] += r.finished && r.ranks[game] == 0;
+                }
+                results.add(placementPoints(out[task][0].ranks, 0), placementPoints(out[task][1].ranks, 1));
+                decided = check();
+            }
+            if (onBatch) onBatch(*this);
+        }
+        return decided;
+    }
+
+    Sprt::Verdict Sprt::verdict() const {
+        return decided;
+    }
+
+    const PairStats &Sprt::stats() const {
+        return results;
+    }
+
+    uint64_t Sprt::games() const {
+        return results.pairs() * 2;
+    }
+
+    const array<uint32_t, 6> &Sprt::roleWins() const {
+        return wins;
+    }
+
+    const array<uint32_t, 6> &Sprt::roleGames() const {
+        return played;
+    }
+
+    const char *verdictName(const Sprt::Verdict verdict) {
+        switch (verdict) {
+            case Sprt::Verdict::Stronger: return "stronger";
+            case Sprt::Verdict::Weaker: return "weaker";
+            case Sprt::Verdict::Equal: return "equal";
+            default: return "undecided";
+        }
+    }
+} // namespace coup
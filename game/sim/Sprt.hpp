@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "Tournament.hpp"
+
+namespace coup {
+    /**
+     * @class PairStats
+     * @brief Running results of mirrored game pairs, kept as counts so they add up exactly in any order.
+     *
+     * A pair scores 0, 1/4, 1/2, 3/4 or 1 for the first bot: the mean of its
+     * two game scores, each 0, 1/2 (unfinished) or 1. Counting the five
+     * outcomes is enough for the mean and variance of the pair score.
+     */
+    class PairStats {
+    public:
+        /**
+         * @param first Score of the first game of the pair, 0, 0.5 or 1
+         * @param second Score of the mirrored game
+         */
+        void add(double first, double second);
+
+        void merge(const PairStats& other);
+
+        uint64_t pairs() const;
+
+        /** @return Pairs by outcome, from both lost (0) to both won (4). */
+        const std::array<uint64_t, 5>& outcomes() const;
+
+        /** @return Mean pair score, 0.5 with no pairs. */
+        double mean() const;
+
+        /** @return Variance of the pair score. */
+        double variance() const;
+
+        /** @return Elo difference the mean score implies, clamped to +-1200. */
+        double elo() const;
+
+        /**
+         * @brief Generalised SPRT log-likelihood ratio of elo1 over elo0.
+         *
+         * Uses the normal approximation on the pair score: N (s1 - s0)(2m - s0 - s1) / 2v,
+         * where s0 and s1 are the expected scores at elo0 and elo1. The variance is
+         * floored so a one-sided start still needs a few pairs to decide.
+         */
+        double llr(double elo0, double elo1) const;
+
+    private:
+        std::array<uint64_t, 5> counts{};
+    };
+
+    /**
+     * @class Sprt
+     * @brief Plays a candidate bot against a baseline until a sequential test decides which is stronger.
+     *
+     * Games come in mirrored pairs: the same roles, seats and random opening,
+     * with the bots swapped, so luck of the deal cancels out within a pair.
+     * Pair p seats role ROLE_CYCLE[p % 6] against ROLE_CYCLE[(p + 1 + p / 6 % 5) % 6],
+     * so every 30 pairs cover every ordered pair of different roles.
+     *
+     * Two one-sided tests run side by side at the same error rates: 0 Elo
+     * against +elo ("stronger") and 0 against -elo ("weaker"). The first to
+     * accept its alternative decides; once both accept 0 the bots are equal.
+     * Pairs are played in batches on a WorkStealingPool and taken in pair
+     * order, so the verdict and the pair it came at do not depend on threads.
+     */
+    class Sprt {
+    public:
+        enum class Verdict { Undecided, Stronger, Weaker, Equal };
+
+        struct Options {
+            double elo = 30.0;         ///< Smallest difference worth detecting
+            double alpha = 0.05;       ///< Chance of calling equal bots different
+            double beta = 0.05;        ///< Chance of missing a difference of elo
+            uint64_t maxPairs = 20000; ///< Undecided after this many
+            int maxDecisions = 500;
+            int openingMoves = 4;      ///< Random first decisions of every game
+            uint64_t seed = 1;         ///< Picks the openings
+            size_t threads = 1;
+            size_t batch = 16;         ///< Pairs per worker between checks
+        };
+
+        /**
+         * @throws InitError on an unknown bot, elo <= 0, or alpha or beta outside (0, 0.5)
+         */
+        Sprt(const BotRegistry& registry, std::string candidate, std::string baseline, Options options);
+
+        /**
+         * @brief Play until the test decides or maxPairs is reached.
+         * @param onBatch Called after every batch, with the statistics so far
+         */
+        Verdict run(const std::function<void(const Sprt&)>& onBatch = {});
+
+        Verdict verdict() const;
+
+        const PairStats& stats() const;
+
+        /** @return Games counted, two per pair. */
+        uint64_t games() const;
+
+        /** @return Wins of the candidate by ROLE_CYCLE position, and games played in each role. */
+        const std::array<uint32_t, 6>& roleWins() const;
+        const std::array<uint32_t, 6>& roleGames() const;
+
+        /** @return Log-likelihood ratios of the "stronger" and "weaker" tests. */
+        double llrStronger() const;
+        double llrWeaker() const;
+
+        /** @return Bounds both ratios are compared with: accept 0 Elo below lower, the alternative above upper. */
+        double lower() const;
+        double upper() const;
+
+        /** @return Roles of pair p: seat 0 first. */
+        static std::array<Role, 2> pairRoles(uint64_t pair);
+
+    private:
+        const BotRegistry& registry;
+        std::string candidate;
+        std::string baseline;
+        Options options;
+        PairStats results;
+        std::array<uint32_t, 6> wins{};
+        std::array<uint32_t, 6> played{};
+        Verdict decided = Verdict::Undecided;
+
+        Verdict check() const;
+    };
+
+    /** @return "stronger", "weaker", "equal" or "undecided". */
+    const char* verdictName(Sprt::Verdict verdict);
+} // namespace coup
@@ -0,0 +1,398 @@
+#include "Tournament.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include "TurnPipeline.hpp"
+#include "WorkStealingPool.hpp"
+#include "../GameExceptions.hpp"
+#include "../bot/ActionSpace.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        constexpr const char *JOURNAL_MAGIC = "coup-tournament 1";
+
+        int nthBit(uint32_t mask, uint32_t n) {
+            for (int bit = 0; bit < 32; ++bit) {
+                if (!(mask >> bit & 1u)) continue;
+                if (n-- == 0) return bit;
+            }
+            return -1;
+        }
+
+        uint64_t mix(uint64_t x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        /** @brief Legal answer chosen by a hash of the position, so replays pick the same one. */
+        void randomBatchPolicy(const vector<DecisionRequest> &requests, vector<int> &answers) {
+            for (size_t i = 0; i < requests.size(); ++i) {
+                const DecisionRequest &r = requests[i];
+                uint64_t key = r.legal;
+                key = key << 16 ^ static_cast<uint64_t>(r.state->getTurnCount());
+                key = key << 8 ^ static_cast<uint64_t>(r.player->getCoins());
+                key = key << 8 ^ r.state->recentActionCount() << 1 ^ (r.kind == DecisionKind::Block);
+                for (const Player *p: r.state->getPlayers()) key = mix(key ^ static_cast<uint64_t>(p->getCoins()));
+                answers[i] = nthBit(r.legal, static_cast<uint32_t>(mix(key) % __builtin_popcount(r.legal)));
+            }
+        }
+
+        void passiveBatchPolicy(const vector<DecisionRequest> &requests, vector<int> &answers) {
+            for (size_t i = 0; i < requests.size(); ++i) {
+                const uint32_t legal = requests[i].legal;
+                if (requests[i].kind == DecisionKind::Block) {
+                    answers[i] = 0;
+                } else {
+                    answers[i] = (legal >> actions::GATHER & 1u) ? actions::GATHER : nthBit(legal, 0);
+                }
+            }
+        }
+
+        size_t roleSlot(const Role role) {
+            return static_cast<size_t>(find(ROLE_CYCLE.begin(), ROLE_CYCLE.end(), role) - ROLE_CYCLE.begin());
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Bots
+    //------------------------------------------------------------------------------
+
+    BotRegistry BotRegistry::builtins() {
+        BotRegistry registry;
+        registry.add("heuristic", [] { return BatchPolicy(heuristicBatchPolicy); });
+        registry.add("random", [] { return BatchPolicy(randomBatchPolicy); });
+        registry.add("passive", [] { return BatchPolicy(passiveBatchPolicy); });
+        return registry;
+    }
+
+    void BotRegistry::add(const string &name, BotFactory factory) {
+        if (name.empty() || has(name)) {
+            throw InitError("Bot names must be unique and not empty: '" + name + "'");
+        }
+        order.push_back(name);
+        factories.emplace(name, move(factory));
+    }
+
+    bool BotRegistry::has(const string &name) const {
+        return factories.count(name) != 0;
+    }
+
+    const vector<string> &BotRegistry::names() const {
+        return order;
+    }
+
+    BatchPolicy BotRegistry::create(const string &name) const {
+        const auto it = factories.find(name);
+        if (it == factories.end()) {
+            throw InitError("Unknown bot: " + name);
+        }
+        return it->second();
+    }
+
+    //------------------------------------------------------------------------------
+    // One game
+    //------------------------------------------------------------------------------
+
+    SeatedResult playSeated(const vector<BatchPolicy *> &seats, const vector<Role> &roles, const int maxDecisions,
+                            const int openingMoves, const uint64_t openingSeed) {
+        if (seats.size() != roles.size() || seats.size() < 2) {
+            throw InitError("A seated game needs a policy and a role for each of at least 2 seats");
+        }
+        const size_t count = seats.size();
+        vector<string> names;
+        for (size_t s = 0; s < count; ++s) names.push_back("S" + to_string(s));
+        Game game(names, roles);
+        TurnPipeline pipeline(game);
+
+        vector<int> outAt(count, -1); // order of elimination per seat
+        int out = 0;
+        vector<DecisionRequest> request(1);
+        vector<int> answer(1);
+        SeatedResult result;
+        while (pipeline.awaiting() != Await::Done && result.decisions < maxDecisions) {
+            DecisionRequest &r = request[0];
+            r.kind = pipeline.awaiting() == Await::Block ? DecisionKind::Block : DecisionKind::Turn;
+            r.state = &game;
+            r.player = pipeline.decider();
+            r.challenged = pipeline.challenged();
+            r.legal = pipeline.legal();
+            int a;
+            if (result.decisions < openingMoves) {
+                const uint64_t pick = mix(openingSeed ^ mix(static_cast<uint64_t>(result.decisions)));
+                a = nthBit(r.legal, static_cast<uint32_t>(pick % __builtin_popcount(r.legal)));
+            } else {
+                const size_t seat = static_cast<size_t>(stoi(r.player->getName().substr(1)));
+                (*seats[seat])(request, answer);
+                a = answer[0];
+            }
+            if (a < 0 || a >= 32 || !(r.legal >> a & 1u)) a = pipeline.fallback();
+            const size_t before = game.getPlayers().size();
+            pipeline.resume(a);
+            ++result.decisions;
+            if (game.getPlayers().size() == before) continue;
+            for (size_t s = 0; s < count; ++s) {
+                if (outAt[s] >= 0) continue;
+                bool present = false;
+                for (const Player *p: game.getPlayers()) present |= p->getName() == names[s];
+                if (!present) outAt[s] = out++;
+            }
+        }
+        result.finished = pipeline.awaiting() == Await::Done;
+        result.ranks.resize(count);
+        for (size_t s = 0; s < count; ++s) {
+            result.ranks[s] = static_cast<uint8_t>(outAt[s] < 0 ? 0 : count - 1 - static_cast<size_t>(outAt[s]));
+        }
+        return result;
+    }
+
+    double placementPoints(const vector<uint8_t> &ranks, const size_t seat) {
+        const size_t last = ranks.size() - 1;
+        const size_t rank = ranks[seat];
+        const size_t tied = static_cast<size_t>(count(ranks.begin(), ranks.end(), ranks[seat]));
+        double sum = 0.0;
+        for (size_t place = rank; place < rank + tied; ++place) sum += static_cast<double>(last - place) / last;
+        return sum / tied;
+    }
+
+    double EntrantRecord::score() const {
+        return games ? static_cast<double>(points) / 1e6 / games : 0.0;
+    }
+
+    //------------------------------------------------------------------------------
+    // Scheduling
+    //------------------------------------------------------------------------------
+
+    Tournament::Tournament(const BotRegistry &registry, vector<string> entrants, Options options)
+        : registry(registry), entrants(move(entrants)), options(move(options)) {
+        if (this->entrants.size() < 2) {
+            throw InitError("A tournament needs at least 2 entrants");
+        }
+        for (const string &bot: this->entrants) {
+            if (!registry.has(bot)) throw InitError("Unknown bot: " + bot);
+            records.push_back(EntrantRecord{bot});
+        }
+        if (this->options.seats.empty()) {
+            throw InitError("A tournament needs at least one table size");
+        }
+        for (const int seats: this->options.seats) {
+            if (seats < 2 || seats > 6) throw InitError("Tables seat 2 to 6 players");
+        }
+    }
+
+    uint32_t Tournament::roundCount() const {
+        return options.format == Format::RoundRobin ? 1u : static_cast<uint32_t>(max(0, options.rounds));
+    }
+
+    void Tournament::addGroup(const uint32_t round, const vector<uint32_t> &group, vector<Fixture> &out) const {
+        const size_t k = group.size();
+        for (size_t rotation = 0; rotation < ROLE_CYCLE.size(); ++rotation) {
+            Fixture f;
+            f.round = round;
+            f.index = static_cast<uint32_t>(out.size());
+            for (size_t seat = 0; seat < k; ++seat) {
+                const size_t c = (seat + k * ROLE_CYCLE.size() - rotation) % k;
+                f.entrants.push_back(group[c]);
+                f.roles.push_back(ROLE_CYCLE[(c + rotation) % ROLE_CYCLE.size()]);
+            }
+            out.push_back(move(f));
+        }
+    }
+
+    vector<Fixture> Tournament::schedule(const uint32_t round) const {
+        vector<Fixture> fixtures;
+        const uint32_t n = static_cast<uint32_t>(entrants.size());
+        if (options.format == Format::RoundRobin) {
+            // Every group of every size, in lexicographic order
+            for (const int seats: options.seats) {
+                const uint32_t k = static_cast<uint32_t>(seats);
+                if (k > n) continue;
+                vector<uint32_t> group(k);
+                for (uint32_t i = 0; i < k; ++i) group[i] = i;
+                while (true) {
+                    addGroup(round, group, fixtures);
+                    int i = static_cast<int>(k) - 1;
+                    while (i >= 0 && group[i] == n - k + static_cast<uint32_t>(i)) --i;
+                    if (i < 0) break;
+                    ++group[i];
+                    for (uint32_t j = static_cast<uint32_t>(i) + 1; j < k; ++j) group[j] = group[j - 1] + 1;
+                }
+            }
+            return fixtures;
+        }
+        // Swiss: neighbours in the standings share a table; a lone leftover sits the round out
+        const size_t k = min<size_t>(static_cast<size_t>(options.seats[round % options.seats.size()]), n);
+        const vector<size_t> order = ranking();
+        for (size_t first = 0; first + 1 < order.size(); first += k) {
+            vector<uint32_t> group;
+            for (size_t i = first; i < min(order.size(), first + k); ++i) group.push_back(static_cast<uint32_t>(order[i]));
+            addGroup(round, group, fixtures);
+        }
+        return fixtures;
+    }
+
+    //------------------------------------------------------------------------------
+    // Standings
+    //------------------------------------------------------------------------------
+
+    void Tournament::apply(const Fixture &fixture, const SeatedResult &result) {
+        for (size_t seat = 0; seat < fixture.entrants.size(); ++seat) {
+            EntrantRecord &r = records[fixture.entrants[seat]];
+            const bool won = result.finished && result.ranks[seat] == 0;
+            const size_t slot = roleSlot(fixture.roles[seat]);
+            ++r.games;
+            r.wins += won;
+            r.points += llround(placementPoints(result.ranks, seat) * 1e6);
+            ++r.roleGames[slot];
+            r.roleWins[slot] += won;
+        }
+    }
+
+    const vector<EntrantRecord> &Tournament::standings() const {
+        return records;
+    }
+
+    vector<size_t> Tournament::ranking() const {
+        vector<size_t> order(records.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        stable_sort(order.begin(), order.end(), [this](const size_t a, const size_t b) {
+            // Compare points per game exactly: a.points * b.games vs b.points * a.games
+            const __int128 left = static_cast<__int128>(records[a].points) * max<uint32_t>(1, records[b].games);
+            const __int128 right = static_cast<__int128>(records[b].points) * max<uint32_t>(1, records[a].games);
+            return left > right;
+        });
+        return order;
+    }
+
+    size_t Tournament::resumed() const {
+        return fromJournal;
+    }
+
+    //------------------------------------------------------------------------------
+    // Journal
+    //------------------------------------------------------------------------------
+
+    string Tournament::header() const {
+        ostringstream out;
+        out << JOURNAL_MAGIC << ' ' << (options.format == Format::RoundRobin ? "rr" : "swiss") << ' '
+                << options.rounds << ' ' << options.maxDecisions << " seats";
+        for (const int s: options.seats) out << ' ' << s;
+        out << " bots";
+        for (const string &bot: entrants) out << ' ' << bot;
+        return out.str();
+    }
+
+    map<pair<uint32_t, uint32_t>, SeatedResult> Tournament::loadJournal() const {
+        map<pair<uint32_t, uint32_t>, SeatedResult> done;
+        vector<string> kept{header()};
+        ifstream in(options.journal);
+        string line;
+        if (in && getline(in, line) && line != kept[0]) {
+            throw InitError("Journal " + options.journal + " belongs to a different tournament");
+        }
+        // A line cut short by a crash has too few fields (or no newline) and is dropped
+        while (in && getline(in, line)) {
+            if (in.eof()) break;
+            istringstream fields(line);
+            uint32_t round, index, finished, seats;
+            SeatedResult result;
+            if (!(fields >> round >> index >> finished >> result.decisions >> seats) || seats < 2 || seats > 6) break;
+            result.finished = finished != 0;
+            result.ranks.resize(seats);
+            bool ok = true;
+            for (uint8_t &rank: result.ranks) {
+                unsigned value;
+                ok = ok && (fields >> value) && value < seats;
+                if (ok) rank = static_cast<uint8_t>(value);
+            }
+            if (!ok) break;
+            done[{round, index}] = result;
+            kept.push_back(line);
+        }
+        in.close();
+        // Rewrite the header and the complete lines, so appending never continues a torn one
+        const string tmp = options.journal + ".tmp";
+        {
+            ofstream out(tmp, ios::trunc);
+            for (const string &l: kept) out << l << '\n';
+            if (!out) {
+                throw runtime_error("Cannot rewrite journal: " + options.journal);
+            }
+        }
+        if (rename(tmp.c_str(), options.journal.c_str()) != 0) {
+            throw runtime_error("Cannot replace journal: " + options.journal);
+        }
+        return done;
+    }
+
+    //------------------------------------------------------------------------------
+    // Running
+    //------------------------------------------------------------------------------
+
+    size_t Tournament::run(const function<void(const Fixture &, const SeatedResult &)> &onGame) {
+        for (EntrantRecord &r: records) r = EntrantRecord{r.bot};
+        fromJournal = 0;
+        map<pair<uint32_t, uint32_t>, SeatedResult> done;
+        ofstream journal;
+        if (!options.journal.empty()) {
+            done = loadJournal();
+            journal.open(options.journal, ios::app);
+            if (!journal) {
+                throw runtime_error("Cannot open journal: " + options.journal);
+            }
+        }
+
+        WorkStealingPool pool(options.threads);
+        // One instance of every entrant per worker: policies may keep scratch state
+        vector<vector<BatchPolicy>> policies(pool.threads());
+        for (auto &mine: policies) {
+            for (const string &bot: entrants) mine.push_back(registry.create(bot));
+        }
+
+        size_t played = 0;
+        mutex lock;
+        for (uint32_t round = 0; round < roundCount(); ++round) {
+            const vector<Fixture> fixtures = schedule(round);
+            vector<size_t> pending;
+            for (const Fixture &f: fixtures) {
+                const auto it = done.find({f.round, f.index});
+                if (it == done.end()) {
+                    pending.push_back(f.index);
+                    continue;
+                }
+                apply(f, it->second);
+                ++fromJournal;
+                if (onGame) onGame(f, it->second);
+            }
+            pool.run(pending.size(), [&](const size_t task, const size_t worker) {
+                const Fixture &f = fixtures[pending[task]];
+                vector<BatchPolicy *> seats;
+                for (const uint32_t e: f.entrants) seats.push_back(&policies[worker][e]);
+                const SeatedResult result = playSeated(seats, f.roles, options.maxDecisions);
+
+                lock_guard<mutex> guard(lock);
+                apply(f, result);
+                ++played;
+                if (journal.is_open()) {
+                    journal << f.round << ' ' << f.index << ' ' << result.finished << ' ' << result.decisions << ' '
+                            << result.ranks.size();
+                    for (const uint8_t rank: result.ranks) journal << ' ' << static_cast<unsigned>(rank);
+                    journal << '\n' << flush;
+                    if (!journal) {
+                        throw runtime_error("Cannot write journal: " + options.journal);
+                    }
+                }
+                if (onGame) onGame(f, result);
+            });
+        }
+        return played;
+    }
+} // namespace coup
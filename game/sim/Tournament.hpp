@@ -0,0 +1,183 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../bot/DecisionService.hpp"
+
+namespace coup {
+    /** @brief Makes a fresh instance of a bot; every worker thread gets its own. */
+    using BotFactory = std::function<BatchPolicy()>;
+
+    /**
+     * @class BotRegistry
+     * @brief Bot policies by name, in registration order.
+     */
+    class BotRegistry {
+    public:
+        /**
+         * @brief The bots that need no files: "heuristic" (heuristicBatchPolicy),
+         *        "random" (a legal answer picked by hashing the position) and
+         *        "passive" (gathers, never blocks).
+         */
+        static BotRegistry builtins();
+
+        /**
+         * @throws InitError on an empty or duplicate name
+         */
+        void add(const std::string& name, BotFactory factory);
+
+        bool has(const std::string& name) const;
+
+        const std::vector<std::string>& names() const;
+
+        /**
+         * @throws InitError if no bot has that name
+         */
+        BatchPolicy create(const std::string& name) const;
+
+    private:
+        std::vector<std::string> order;
+        std::unordered_map<std::string, BotFactory> factories;
+    };
+
+    /**
+     * @brief Turn order of the roles in rotations: the fixed order Game deals ("P0" Governor, ...).
+     */
+    constexpr std::array<Role, 6> ROLE_CYCLE = {
+        Role::Governor, Role::Spy, Role::Baron, Role::General, Role::Judge, Role::Merchant
+    };
+
+    /**
+     * @struct SeatedResult
+     * @brief How one game between seated bots ended.
+     */
+    struct SeatedResult {
+        std::vector<uint8_t> ranks;  ///< Per seat: 0 for the winner, higher for earlier eliminations
+        int decisions = 0;
+        bool finished = false;       ///< False if the decision limit stopped it; survivors then tie at rank 0
+    };
+
+    /**
+     * @brief Play one game, each seat answered by its own policy.
+     *
+     * Seats play as "S0", "S1", ... in turn order. An answer that is not legal
+     * is replaced by TurnPipeline::fallback(), as if the bot's clock ran out.
+     * @param seats Policy per seat; a policy is called with one request at a time
+     * @param roles Role per seat
+     * @param maxDecisions Answers after which the game is stopped
+     * @param openingMoves First decisions taken at random instead of asking the seat, to vary play between bots
+     *        that always answer the same way
+     * @param openingSeed Picks the opening; the same seed and roles give the same opening
+     * @throws InitError if seats and roles differ in size or there are fewer than 2
+     */
+    SeatedResult playSeated(const std::vector<BatchPolicy*>& seats, const std::vector<Role>& roles, int maxDecisions,
+                            int openingMoves = 0, uint64_t openingSeed = 0);
+
+    /**
+     * @return Share of the table a seat beat, from 1 (won) to 0 (first out); tied places are averaged
+     */
+    double placementPoints(const std::vector<uint8_t>& ranks, size_t seat);
+
+    /**
+     * @struct Fixture
+     * @brief One scheduled game.
+     */
+    struct Fixture {
+        uint32_t round = 0;
+        uint32_t index = 0;              ///< Position in the round's schedule
+        std::vector<uint32_t> entrants;  ///< Entrant per seat
+        std::vector<Role> roles;         ///< Role per seat
+    };
+
+    /**
+     * @struct EntrantRecord
+     * @brief Running totals of one entrant.
+     */
+    struct EntrantRecord {
+        std::string bot;
+        uint32_t games = 0;
+        uint32_t wins = 0;
+        int64_t points = 0;                 ///< placementPoints() in millionths, exact in any order
+        std::array<uint32_t, 6> roleGames{};
+        std::array<uint32_t, 6> roleWins{}; ///< By ROLE_CYCLE position
+
+        double score() const;
+    };
+
+    /**
+     * @class Tournament
+     * @brief Round-robin or Swiss tournament between bots, played on a WorkStealingPool.
+     *
+     * Every group of bots plays six games: each rotation moves the bots one
+     * seat on and deals each bot the next role of ROLE_CYCLE, so every bot
+     * plays every role and, at tables up to six, every seat. Round-robin plays
+     * every group of every seat count in one round; Swiss plays the given
+     * number of rounds, grouping bots with similar scores, seat counts taking
+     * turns. Standings change as games finish. With a journal every finished
+     * game is appended as a line, and a run over an existing journal skips
+     * the games it holds, so an interrupted tournament picks up where it
+     * stopped and ends with the same standings.
+     */
+    class Tournament {
+    public:
+        enum class Format { RoundRobin, Swiss };
+
+        struct Options {
+            Format format = Format::RoundRobin;
+            std::vector<int> seats{2, 3, 4, 5, 6}; ///< Table sizes used
+            int rounds = 5;                         ///< Swiss only
+            int maxDecisions = 500;
+            size_t threads = 1;
+            std::string journal;                    ///< Resume file, empty for none
+        };
+
+        /**
+         * @param entrants Registry names, one per entrant (a bot may enter twice)
+         * @throws InitError on fewer than 2 entrants, an unknown bot or a table size outside 2..6
+         */
+        Tournament(const BotRegistry& registry, std::vector<std::string> entrants, Options options);
+
+        /**
+         * @brief Play (or resume) the whole tournament.
+         * @param onGame Told about each finished game, from the thread that records it
+         * @return Games played in this call, not counting those taken from the journal
+         * @throws InitError if the journal belongs to a different tournament
+         * @throws std::runtime_error if the journal cannot be written
+         */
+        size_t run(const std::function<void(const Fixture&, const SeatedResult&)>& onGame = {});
+
+        /** @return Records in entrant order. */
+        const std::vector<EntrantRecord>& standings() const;
+
+        /** @return Entrant indices, best score first. */
+        std::vector<size_t> ranking() const;
+
+        /** @return Games taken from the journal in the last run(). */
+        size_t resumed() const;
+
+        /** @return Fixtures of one round, given the standings before it. */
+        std::vector<Fixture> schedule(uint32_t round) const;
+
+        /** @return Rounds the format plays. */
+        uint32_t roundCount() const;
+
+    private:
+        const BotRegistry& registry;
+        std::vector<std::string> entrants;
+        Options options;
+        std::vector<EntrantRecord> records;
+        size_t fromJournal = 0;
+
+        void addGroup(uint32_t round, const std::vector<uint32_t>& group, std::vector<Fixture>& out) const;
+        void apply(const Fixture& fixture, const SeatedResult& result);
+        std::string header() const;
+        std::map<std::pair<uint32_t, uint32_t>, SeatedResult> loadJournal() const; ///< Also (re)writes its header
+    };
+} // namespace coup
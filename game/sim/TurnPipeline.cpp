@@ -0,0 +1,225 @@
+#include "TurnPipeline.hpp"
+#include <algorithm>
+#include "../GameExceptions.hpp"
+#include "../bot/ActionSpace.hpp"
+
+using namespace std;
+
+namespace coup {
+    namespace {
+        /**
+         * @brief Role that may block an action, as prompted by the GamePanel handlers.
+         */
+        Role blockerFor(const ActionType action) {
+            switch (action) {
+                case ActionType::Tax: return Role::Governor;
+                case ActionType::Bribe: return Role::Judge;
+                case ActionType::Arrest: return Role::Spy;
+                case ActionType::Coup: return Role::General;
+                default: return Role::Unknown;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // TurnPipeline
+    //------------------------------------------------------------------------------
+
+    TurnPipeline::TurnPipeline(Game &game) : table(&game) {
+        settle();
+    }
+
+    Await TurnPipeline::awaiting() const {
+        return state;
+    }
+
+    const Player *TurnPipeline::decider() const {
+        switch (state) {
+            case Await::Action: return table->getPlayers()[table->getTurn()];
+            case Await::Block: return blockers[nextBlocker];
+            default: return nullptr;
+        }
+    }
+
+    uint32_t TurnPipeline::legal() const {
+        switch (state) {
+            case Await::Action: return legalActionMask(*table);
+            case Await::Block:
+                if (pendingType == ActionType::Coup && blockers[nextBlocker]->getCoins() < GENERAL_BLOCK_COST) {
+                    return ALLOW;
+                }
+                return ALLOW | BLOCK;
+            default: return 0;
+        }
+    }
+
+    ActionType TurnPipeline::challenged() const {
+        return pendingType;
+    }
+
+    int TurnPipeline::fallback() const {
+        if (state == Await::Block) return 0;
+        if (state != Await::Action) return -1;
+        const uint32_t mask = legal();
+        if (mask >> actions::SKIP & 1u) return actions::SKIP;
+        int answer = 0; // skipping is only illegal while a coup is forced
+        while (!(mask >> answer & 1u)) ++answer;
+        return answer;
+    }
+
+    const Game &TurnPipeline::game() const {
+        return *table;
+    }
+
+    void TurnPipeline::resume(const int answer) {
+        switch (state) {
+            case Await::Action: choose(answer);
+                break;
+            case Await::Block: answerBlock(answer);
+                break;
+            case Await::Done: throw ActionError("Game is over");
+        }
+    }
+
+    // Validate the action and open the block window, or resolve straight away
+    void TurnPipeline::choose(const int action) {
+        if (action < 0 || action >= actions::COUNT || !((legalActionMask(*table) >> action) & 1u)) {
+            throw ActionError("Illegal action index: " + to_string(action));
+        }
+        Player *target = nullptr;
+        pendingType = decodeAction(*table, action, target);
+        pendingAction = action;
+
+        const Player *current = table->getPlayers()[table->getTurn()];
+        const Role role = blockerFor(pendingType);
+        blockers.clear();
+        nextBlocker = 0;
+        if (role != Role::Unknown) {
+            for (Player *p: table->getPlayers()) {
+                if (p != current && p->getRole() == role) blockers.push_back(p);
+            }
+        }
+        if (blockers.empty()) {
+            resolve();
+        } else {
+            state = Await::Block;
+        }
+    }
+
+    // One role holder answers; the first block ends the window as in GamePanel::AskBlock
+    void TurnPipeline::answerBlock(const int answer) {
+        if (answer < 0 || answer > 1 || !((legal() >> answer) & 1u)) {
+            throw ActionError("Illegal block answer: " + to_string(answer));
+        }
+        if (answer == 0) {
+            if (++nextBlocker == blockers.size()) resolve();
+            return;
+        }
+        Player *blocker = blockers[nextBlocker];
+        Player *current = table->getPlayers()[table->getTurn()];
+        // Same payments as the GamePanel handlers; the blocked turn is not consumed
+        table->playerPayAfterBlock(pendingType == ActionType::Coup ? blocker : current, blocker->getRole());
+        if (pendingType == ActionType::Coup) table->advanceTurnIfNeeded();
+        settle();
+    }
+
+    void TurnPipeline::resolve() {
+        applyAction(*table, pendingAction);
+        settle();
+    }
+
+    void TurnPipeline::settle() {
+        blockers.clear();
+        nextBlocker = 0;
+        state = table->getPlayers().size() < 2 ? Await::Done : Await::Action;
+    }
+
+    vector<uint8_t> TurnPipeline::pack() const {
+        vector<uint8_t> out{
+            static_cast<uint8_t>(state), static_cast<uint8_t>(pendingAction), static_cast<uint8_t>(pendingType),
+            static_cast<uint8_t>(nextBlocker), static_cast<uint8_t>(blockers.size())
+        };
+        const auto &players = table->getPlayers();
+        for (const Player *p: blockers) {
+            out.push_back(static_cast<uint8_t>(find(players.begin(), players.end(), p) - players.begin()));
+        }
+        return out;
+    }
+
+    void TurnPipeline::unpack(const uint8_t *data, const size_t length) {
+        if (length < 5 || length != 5u + data[4] || data[0] > static_cast<uint8_t>(Await::Done)) {
+            throw InitError("Corrupt pipeline snapshot");
+        }
+        const auto &players = table->getPlayers();
+        vector<Player *> restored;
+        for (size_t i = 0; i < data[4]; ++i) {
+            if (data[5 + i] >= players.size()) throw InitError("Corrupt pipeline snapshot: bad blocker");
+            restored.push_back(players[data[5 + i]]);
+        }
+        if (static_cast<Await>(data[0]) == Await::Block && data[3] >= restored.size()) {
+            throw InitError("Corrupt pipeline snapshot: no blocker to ask");
+        }
+        if ((data[1] != 0xFF && data[1] >= actions::COUNT) || data[2] > static_cast<uint8_t>(ActionType::Skip)) {
+            throw InitError("Corrupt pipeline snapshot: bad pending action");
+        }
+        state = static_cast<Await>(data[0]);
+        pendingAction = data[1] == 0xFF ? -1 : data[1];
+        pendingType = static_cast<ActionType>(data[2]);
+        nextBlocker = data[3];
+        blockers = move(restored);
+    }
+
+    //------------------------------------------------------------------------------
+    // PipelineScheduler
+    //------------------------------------------------------------------------------
+
+    PipelineScheduler::Task::Task(const Game &source, const int maxDecisions)
+        : game(source), pipeline(game), maxDecisions(maxDecisions) {
+    }
+
+    size_t PipelineScheduler::spawn(const Game &game, const int maxDecisions) {
+        if (game.getPlayers().size() < 2) {
+            throw InitError("A turn pipeline needs at least two players");
+        }
+        tasks.push_back(make_unique<Task>(game, maxDecisions));
+        return tasks.size() - 1;
+    }
+
+    const vector<size_t> &PipelineScheduler::ready() {
+        readyList.clear();
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (!finished(i)) readyList.push_back(i);
+        }
+        return readyList;
+    }
+
+    void PipelineScheduler::resume(const size_t task, const int answer) {
+        if (finished(task)) {
+            throw ActionError("Task is finished");
+        }
+        Task &t = *tasks[task];
+        t.pipeline.resume(answer);
+        ++t.decisions;
+    }
+
+    size_t PipelineScheduler::size() const {
+        return tasks.size();
+    }
+
+    bool PipelineScheduler::finished(const size_t task) const {
+        const Task &t = *tasks.at(task);
+        return t.pipeline.awaiting() == Await::Done || t.decisions >= t.maxDecisions;
+    }
+
+    const TurnPipeline &PipelineScheduler::pipeline(const size_t task) const {
+        return tasks.at(task)->pipeline;
+    }
+
+    const Game &PipelineScheduler::game(const size_t task) const {
+        return tasks.at(task)->game;
+    }
+
+    int PipelineScheduler::decisions(const size_t task) const {
+        return tasks.at(task)->decisions;
+    }
+} // namespace coup
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../Game.hpp"
+
+namespace coup {
+    /**
+     * @brief What a suspended turn pipeline is waiting for.
+     */
+    enum class Await {
+        Action, ///< The current player's flat action index (ActionSpace.hpp)
+        Block,  ///< A role holder's block answer: 0 = allow, 1 = block
+        Done    ///< The game is over
+    };
+
+    /**
+     * @class TurnPipeline
+     * @brief Resumable turn flow for one Game, without dialogs or threads.
+     *
+     * Runs the same stages as the GamePanel::Handle* methods:
+     * choose -> validate -> block window -> pay or resolve -> advanceTurnIfNeeded.
+     * Where the GUI opens a modal dialog the pipeline suspends instead and
+     * reports what it awaits; resume() feeds the answer and runs to the next
+     * suspension point. The state is a handful of fields, so many thousands of
+     * suspended games fit on one thread.
+     */
+    class TurnPipeline {
+    public:
+        static constexpr uint32_t ALLOW = 1u << 0; ///< Block answer 0 in legal()
+        static constexpr uint32_t BLOCK = 1u << 1; ///< Block answer 1 in legal()
+        static constexpr int GENERAL_BLOCK_COST = 5; ///< What GamePanel asks a General to pay
+
+        /**
+         * @param game Game to drive; must outlive the pipeline and only be changed through it
+         */
+        explicit TurnPipeline(Game& game);
+
+        /** @return Current suspension point. */
+        Await awaiting() const;
+
+        /** @return Player who must answer, nullptr when done. */
+        const Player* decider() const;
+
+        /** @return Bit mask of legal answers at this suspension point. */
+        uint32_t legal() const;
+
+        /** @return Block only: the action that may be blocked. */
+        ActionType challenged() const;
+
+        /**
+         * @brief Answer given when a decision's clock runs out: skip the turn
+         *        (the first legal coup when one is forced) or decline the block.
+         * @return -1 when the game is over
+         */
+        int fallback() const;
+
+        /** @return Game driven by this pipeline. */
+        const Game& game() const;
+
+        /**
+         * @brief Answer the current suspension point and run to the next one.
+         * @param answer Action index or block answer
+         * @throws ActionError if the answer is not legal or the game is over
+         */
+        void resume(int answer);
+
+        /**
+         * @brief Serialize the suspension point in a few bytes (the game is packed on its own).
+         */
+        std::vector<uint8_t> pack() const;
+
+        /**
+         * @brief Restore a suspension point saved by pack() over the same game state.
+         * @throws InitError if the bytes do not fit the game
+         */
+        void unpack(const uint8_t* data, size_t length);
+
+    private:
+        Game* table;
+        Await state = Await::Action;
+        int pendingAction = -1;              ///< Action waiting on the block window
+        ActionType pendingType = ActionType::Skip;
+        std::vector<Player*> blockers;       ///< Role holders asked in seat order
+        size_t nextBlocker = 0;
+
+        void choose(int action);
+        void answerBlock(int answer);
+        void resolve();
+        void settle();
+    };
+
+    /**
+     * @class PipelineScheduler
+     * @brief Interleaves many suspended games on the calling thread.
+     *
+     * Each task owns a Game and its TurnPipeline. ready() lists the tasks that
+     * are waiting for an answer; resume() answers one and it moves on to its
+     * next suspension point. Nothing blocks, so one scheduler per worker thread
+     * is enough to drive tens of thousands of games.
+     */
+    class PipelineScheduler {
+    public:
+        /**
+         * @brief Add a game (copied) as a new task.
+         * @param game Game with at least two players
+         * @param maxDecisions Answers after which the task is stopped without a winner
+         * @return Task id
+         * @throws InitError if the game has fewer than two players
+         */
+        size_t spawn(const Game& game, int maxDecisions);
+
+        /** @return Ids of tasks waiting for an answer, in spawn order. */
+        const std::vector<size_t>& ready();
+
+        /**
+         * @brief Answer a waiting task.
+         * @throws ActionError if the answer is not legal
+         */
+        void resume(size_t task, int answer);
+
+        size_t size() const;
+        bool finished(size_t task) const;
+        const TurnPipeline& pipeline(size_t task) const;
+        const Game& game(size_t task) const;
+
+        /** @return Answers given to a task so far. */
+        int decisions(size_t task) const;
+
+    private:
+        /**
+         * @brief Game and pipeline kept together so the pipeline's pointer stays valid.
+         */
+        struct Task {
+            Game game;
+            TurnPipeline pipeline;
+            int maxDecisions;
+            int decisions = 0;
+
+            Task(const Game& source, int maxDecisions);
+        };
+
+        std::vector<std::unique_ptr<Task>> tasks;
+        std::vector<size_t> readyList;
+    };
+} // namespace coup
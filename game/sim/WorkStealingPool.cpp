@@ -0,0 +1,75 @@
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+using namespace std;
+
+namespace coup {
+    WorkStealingPool::WorkStealingPool(const size_t threads) {
+        for (size_t i = 0; i < max<size_t>(1, threads); ++i) queues.push_back(make_unique<Queue>());
+    }
+
+    size_t WorkStealingPool::threads() const {
+        return queues.size();
+    }
+
+    bool WorkStealingPool::takeOwn(const size_t worker, size_t &task) {
+        Queue &q = *queues[worker];
+        lock_guard<mutex> guard(q.lock);
+        if (q.tasks.empty()) return false;
+        task = q.tasks.back();
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool WorkStealingPool::steal(const size_t worker, size_t &task) {
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue &victim = *queues[(worker + i) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (victim.tasks.empty()) continue;
+            task = victim.tasks.front(); // the oldest work, furthest from what the owner touches
+            victim.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    size_t WorkStealingPool::run(const size_t count, const function<void(size_t, size_t)> &task) {
+        // Dealt in reverse so each owner, popping from the back, starts with its lowest task
+        for (size_t t = count; t-- > 0;) queues[t % queues.size()]->tasks.push_back(t);
+
+        atomic<size_t> stolen{0};
+        atomic<bool> failed{false};
+        exception_ptr error;
+        mutex errorLock;
+        auto work = [&](const size_t worker) {
+            size_t next;
+            while (!failed.load(memory_order_relaxed)) {
+                if (!takeOwn(worker, next)) {
+                    if (!steal(worker, next)) return; // nothing left anywhere: tasks never spawn tasks
+                    stolen.fetch_add(1, memory_order_relaxed);
+                }
+                try {
+                    task(next, worker);
+                } catch (...) {
+                    lock_guard<mutex> guard(errorLock);
+                    if (!error) error = current_exception();
+                    failed = true;
+                }
+            }
+        };
+        vector<thread> pool;
+        for (size_t w = 1; w < queues.size(); ++w) {
+            pool.emplace_back(work, w);
+        }
+        work(0);
+        for (auto &t: pool) {
+            t.join();
+        }
+        for (auto &q: queues) q->tasks.clear();
+        if (error) rethrow_exception(error);
+        return stolen.load();
+    }
+} // namespace coup
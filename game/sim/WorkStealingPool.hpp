@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace coup {
+    /**
+     * @class WorkStealingPool
+     * @brief Runs a batch of independent tasks on worker threads that steal from each other.
+     *
+     * Tasks are dealt round-robin into one deque per worker. A worker takes
+     * from the back of its own deque and, once that runs dry, steals from the
+     * front of another's, so a few long games do not leave the other threads
+     * idle. Each deque has its own lock, touched by its owner on every task and
+     * by thieves only when they run out. The calling thread works as worker 0.
+     */
+    class WorkStealingPool {
+    public:
+        /**
+         * @param threads Workers, at least 1
+         */
+        explicit WorkStealingPool(size_t threads);
+
+        size_t threads() const;
+
+        /**
+         * @brief Run tasks 0..count-1 and return when all are done.
+         * @param task Called with the task index and the worker running it
+         * @return Tasks a worker took from another worker's deque
+         * @throws Whatever a task threw first, after every worker has stopped
+         */
+        size_t run(size_t count, const std::function<void(size_t task, size_t worker)>& task);
+
+    private:
+        struct Queue {
+            std::mutex lock;
+            std::deque<size_t> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        bool takeOwn(size_t worker, size_t& task);
+        bool steal(size_t worker, size_t& task);
+    };
+} // namespace coup
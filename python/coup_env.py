@@ -0,0 +1,85 @@
+"""Thin Python wrapper over the Coup C API (game/capi/CoupEnv.h).
+
+Build the shared library with ``make capi`` and point ``COUP_ENV_LIB`` at it
+(defaults to ``build/libcoupenv.so``). Observation, mask, reward and done
+arrays are allocated once as NumPy arrays; the C side writes straight into
+their buffers, so stepping copies nothing and makes one foreign call per batch.
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+_LIB_PATH = os.environ.get(
+    "COUP_ENV_LIB",
+    os.path.join(os.path.dirname(__file__), "..", "build", "libcoupenv.so"),
+)
+
+_lib = ctypes.CDLL(_LIB_PATH)
+
+_f32p = ctypes.POINTER(ctypes.c_float)
+_u8p = ctypes.POINTER(ctypes.c_uint8)
+_i32p = ctypes.POINTER(ctypes.c_int32)
+
+_lib.coup_env_create.restype = ctypes.c_void_p
+_lib.coup_env_create.argtypes = [ctypes.c_size_t, ctypes.c_int, ctypes.c_int]
+_lib.coup_env_destroy.argtypes = [ctypes.c_void_p]
+_lib.coup_env_obs_size.restype = ctypes.c_int
+_lib.coup_env_action_count.restype = ctypes.c_int
+_lib.coup_env_reset.restype = ctypes.c_int
+_lib.coup_env_reset.argtypes = [ctypes.c_void_p, _f32p, _u8p]
+_lib.coup_env_step.restype = ctypes.c_int
+_lib.coup_env_step.argtypes = [ctypes.c_void_p, _i32p, _f32p, _u8p, _f32p, _u8p]
+_lib.coup_env_last_error.restype = ctypes.c_char_p
+_lib.coup_env_last_error.argtypes = [ctypes.c_void_p]
+
+OBS_SIZE = _lib.coup_env_obs_size()
+ACTION_COUNT = _lib.coup_env_action_count()
+
+
+def _ptr(array, kind):
+    return array.ctypes.data_as(kind)
+
+
+class VecEnv:
+    """Vectorized self-play environment with auto-reset.
+
+    ``obs``, ``masks``, ``rewards`` and ``dones`` are reused on every call;
+    copy them if you need to keep a previous step.
+    """
+
+    def __init__(self, num_envs, seats=2, random_roles=False):
+        self._handle = _lib.coup_env_create(num_envs, seats, int(random_roles))
+        if not self._handle:
+            raise ValueError("could not create environment (seats must be 2..6)")
+        self.num_envs = num_envs
+        self.obs = np.zeros((num_envs, OBS_SIZE), dtype=np.float32)
+        self.masks = np.zeros((num_envs, ACTION_COUNT), dtype=np.uint8)
+        self.rewards = np.zeros(num_envs, dtype=np.float32)
+        self.dones = np.zeros(num_envs, dtype=np.uint8)
+
+    def reset(self):
+        self._check(_lib.coup_env_reset(self._handle, _ptr(self.obs, _f32p), _ptr(self.masks, _u8p)))
+        return self.obs, self.masks
+
+    def step(self, actions):
+        actions = np.ascontiguousarray(actions, dtype=np.int32)
+        if actions.shape != (self.num_envs,):
+            raise ValueError("expected one action per environment")
+        self._check(_lib.coup_env_step(
+            self._handle, _ptr(actions, _i32p), _ptr(self.obs, _f32p), _ptr(self.masks, _u8p),
+            _ptr(self.rewards, _f32p), _ptr(self.dones, _u8p)))
+        return self.obs, self.masks, self.rewards, self.dones
+
+    def close(self):
+        if self._handle:
+            _lib.coup_env_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def _check(self, status):
+        if status != 0:
+            raise RuntimeError(_lib.coup_env_last_error(self._handle).decode())
@@ -8,6 +8,47 @@
 #include "../game/player/roleHeader/Merchant.hpp"
 #include "../game/player/roleHeader/Spy.hpp"
 #include "../game/GameExceptions.hpp"
+#include "../game/bot/CfrTrainer.hpp"
+#include "../game/sim/GameBatch.hpp"
+#include "../game/bot/VecEnv.hpp"
+#include "../game/capi/CoupEnv.h"
+#include "../game/bot/Observation.hpp"
+#include "../game/bot/Mlp.hpp"
+#include "../game/bot/DecisionService.hpp"
+#include "../game/bot/BotChannel.hpp"
+#include "../game/sim/TurnPipeline.hpp"
+#include "../game/sim/GameMirror.hpp"
+#include "../game/server/GameServer.hpp"
+#include "../game/server/ShardedServer.hpp"
+#include "../game/server/OutQueue.hpp"
+#include "../game/server/TimerWheel.hpp"
+#include "../game/server/ActionLog.hpp"
+#include "../game/server/Coordinator.hpp"
+#include "../game/server/HashRing.hpp"
+#include "../game/server/ActionInbox.hpp"
+#include "../game/server/Matchmaker.hpp"
+#include "../game/rating/RatingEngine.hpp"
+#include "../game/rating/Leaderboard.hpp"
+#include "../game/sim/Tournament.hpp"
+#include "../game/sim/Sprt.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
 
 using namespace coup;
 using namespace std;
@@ -973,3 +1014,1870 @@ TEST_CASE("Game deep copy: mutations on copy do not affect original") {
     g2.getPlayers()[0]->addCoins(100);
     CHECK(g1.getPlayers()[0]->getCoins() != 100);
 }
+
+
+TEST_CASE("CFR heads-up state applies General coup block") {
+    HeadsUpState state;
+    state.roles = {Role::Baron, Role::General};
+    state.coins = {7, 5};
+    CHECK((state.legalMask() & (1u << static_cast<int>(CfrAction::Coup))) != 0u);
+
+    state.apply(static_cast<int>(CfrAction::Coup));
+    CHECK(state.decision() == Decision::BlockCoup);
+    CHECK(state.decider() == 1);
+
+    state.apply(1); // General blocks
+    CHECK(state.coins[0] == 0);
+    CHECK(state.coins[1] == 0);
+    CHECK(state.winner == -1);
+    CHECK(state.toMove == 0); // blocked coup does not consume the turn
+}
+
+TEST_CASE("CFR training checkpoints and exports a usable policy") {
+    const string checkpoint = "cfr_test.ckpt";
+    const string policy = "cfr_test_policy.txt";
+
+    CfrTrainer trainer(7);
+    trainer.train(32, 2, 16, checkpoint);
+    CHECK(trainer.getIterations() == 32);
+
+    CfrTrainer resumed;
+    resumed.loadCheckpoint(checkpoint);
+    CHECK(resumed.getIterations() == 32);
+    resumed.writePolicy(policy);
+
+    PolicyTable table(policy);
+    Game game({"A", "B"});
+    game.getPlayers()[0]->addCoins(4);
+    HeadsUpState state = HeadsUpState::fromGame(game);
+    auto dist = table.distribution(state);
+    float total = 0.0f;
+    for (float p : dist) total += p;
+    CHECK(total == doctest::Approx(1.0f));
+    CHECK(((state.legalMask() >> table.bestAction(state)) & 1u) == 1u);
+
+    std::remove(checkpoint.c_str());
+    std::remove(policy.c_str());
+}
+
+// Replays one lane action through the regular Game API
+static void replayLaneStep(Game& game, vector<Player*>& seatPlayers, const LaneStep& step) {
+    Player* actor = seatPlayers[step.actor];
+    Player* target = step.target >= 0 ? seatPlayers[step.target] : nullptr;
+    switch (step.action) {
+        case ActionType::Gather: game.gather(actor); break;
+        case ActionType::Tax: game.tax(actor); break;
+        case ActionType::Bribe: game.bribe(actor); break;
+        case ActionType::Arrest: game.arrest(actor, target); break;
+        case ActionType::Sanction: game.sanction(actor, target); break;
+        case ActionType::Coup:
+            game.coup(actor, target);
+            seatPlayers[step.target] = nullptr;
+            break;
+        case ActionType::Ability: game.useAbility(actor); break;
+        case ActionType::Skip: game.skipTurn(actor); break;
+    }
+    game.advanceTurnIfNeeded();
+}
+
+TEST_CASE("LaneBatch matches Game rules action by action") {
+    for (int lane : {0, 5, 11}) {
+        LaneBatch batch(6, 42);
+        Game game(names);
+        vector<Player*> seatPlayers = game.getPlayers();
+
+        while (!batch.isFinished(lane)) {
+            batch.step();
+            const LaneStep step = batch.lastStep(lane);
+            REQUIRE(step.actor >= 0);
+            REQUIRE_NOTHROW(replayLaneStep(game, seatPlayers, step));
+            for (int seat = 0; seat < 6; ++seat) {
+                CHECK(batch.isAlive(lane, seat) == (seatPlayers[seat] != nullptr));
+                if (seatPlayers[seat]) {
+                    CHECK(batch.coins(lane, seat) == seatPlayers[seat]->getCoins());
+                }
+            }
+            if (batch.winner(lane) < 0) {
+                CHECK(game.turn() == seatPlayers[batch.currentSeat(lane)]->getName());
+            }
+        }
+        if (batch.winner(lane) >= 0) {
+            CHECK(game.winner() == seatPlayers[batch.winner(lane)]->getName());
+        }
+    }
+}
+
+TEST_CASE("LaneBatch runs mixed tables to completion") {
+    LaneBatch batch(2, 7);
+    batch.reset(3, {Role::Judge, Role::Baron, Role::Merchant, Role::Spy});
+    CHECK_THROWS_AS(batch.reset(4, vector<Role>{Role::Spy}), InitError);
+    batch.runToEnd();
+    for (int lane = 0; lane < LaneBatch::LANES; ++lane) {
+        CHECK(batch.isFinished(lane));
+        if (batch.winner(lane) >= 0) {
+            CHECK(batch.isAlive(lane, batch.winner(lane)));
+        }
+    }
+    CHECK(batch.seatCount(3) == 4);
+}
+
+TEST_CASE("GameBatch steps, collects and resets many games") {
+    GameBatch batch(1000, 4, 3);
+    CHECK(batch.size() == 1000);
+    while (batch.stepAll(greedyLanePolicy) > 0) {
+    }
+    auto outcomes = batch.collectOutcomes();
+    REQUIRE(outcomes.size() == 1000);
+    CHECK(batch.collectOutcomes().empty()); // each game reported once
+    for (const auto& o : outcomes) {
+        REQUIRE(o.winner >= 0);
+        CHECK(o.eliminationOrder[o.winner] == 0);
+        CHECK(o.winnerRole != Role::Unknown);
+    }
+
+    CHECK(batch.resetFinished() == 1000);
+    CHECK_FALSE(batch.isFinished(999));
+    CHECK(batch.coins(999, 0) == 0);
+    batch.stepAll();
+    CHECK(batch.resetFinished() == 0);
+}
+
+TEST_CASE("ActionSpace masks and applies actions on a real Game") {
+    Game game(names);
+    uint32_t mask = legalActionMask(game);
+    CHECK(((mask >> actions::GATHER) & 1u) == 1u);
+    CHECK(((mask >> actions::BRIBE) & 1u) == 0u);
+    CHECK(((mask >> (actions::COUP)) & 1u) == 0u);
+
+    applyAction(game, actions::TAX); // Governor taxes 3 and passes the turn
+    CHECK(game.getPlayers()[0]->getCoins() == 3);
+    CHECK(game.getTurn() == 1);
+    CHECK_THROWS_AS(applyAction(game, actions::BRIBE), ActionError);
+
+    game.getPlayers()[1]->addCoins(10);
+    mask = legalActionMask(game);
+    CHECK(mask == ((1u << actions::COUP) | (1u << (actions::COUP + 1)) | (1u << (actions::COUP + 2)) |
+                   (1u << (actions::COUP + 3)) | (1u << (actions::COUP + 4))));
+    applyAction(game, actions::COUP + 4); // offset 5 wraps to seat 0
+    CHECK(game.getPlayers().size() == 5);
+    CHECK(game.getPlayers()[0]->getName() == "Alice");
+
+    Game invest(names);
+    applyAction(invest, actions::GATHER);
+    applyAction(invest, actions::GATHER);
+    Player* baron = invest.getPlayers()[2];
+    baron->addCoins(3);
+    applyAction(invest, actions::ABILITY);
+    CHECK(baron->getCoins() == 6);
+    CHECK(invest.recentAction(0).action == ActionType::Ability); // the investment enters the history
+    CHECK(invest.recentAction(0).actor == baron);
+}
+
+TEST_CASE("VecEnv and C API step many games with auto-reset") {
+    const size_t envs = 8;
+    CoupEnv* env = coup_env_create(envs, 3, 0);
+    REQUIRE(env != nullptr);
+    CHECK(coup_env_create(4, 7, 0) == nullptr);
+
+    vector<float> obs(envs * coup_env_obs_size());
+    vector<uint8_t> masks(envs * coup_env_action_count());
+    vector<float> rewards(envs);
+    vector<uint8_t> dones(envs);
+    vector<int32_t> acts(envs);
+    REQUIRE(coup_env_reset(env, obs.data(), masks.data()) == 0);
+    CHECK(obs[obs::IS_MY_TURN] == 1.0f); // observation is for the acting seat
+
+    int finished = 0;
+    mt19937 rng(5);
+    for (int t = 0; t < 400; ++t) {
+        for (size_t i = 0; i < envs; ++i) {
+            vector<int> legal;
+            for (int a = 0; a < coup_env_action_count(); ++a) {
+                if (masks[i * coup_env_action_count() + a]) legal.push_back(a);
+            }
+            REQUIRE_FALSE(legal.empty());
+            acts[i] = legal[rng() % legal.size()];
+        }
+        REQUIRE(coup_env_step(env, acts.data(), obs.data(), masks.data(), rewards.data(), dones.data()) == 0);
+        for (size_t i = 0; i < envs; ++i) {
+            finished += dones[i];
+        }
+    }
+    CHECK(finished > 0);
+
+    acts.assign(envs, actions::COUP + 4); // offset beyond a 3-seat table
+    CHECK(coup_env_step(env, acts.data(), obs.data(), masks.data(), rewards.data(), dones.data()) == -1);
+    CHECK(string(coup_env_last_error(env)).find("Illegal") != string::npos);
+    coup_env_destroy(env);
+
+    // One bad action fails the whole step before any game moves
+    VecEnv batch(3, 3, false);
+    batch.reset(obs.data(), masks.data());
+    vector<vector<uint8_t>> before;
+    for (size_t i = 0; i < batch.size(); ++i) before.push_back(batch.game(i).pack());
+    const vector<float> obsBefore(obs);
+    const int32_t mixed[] = {actions::GATHER, actions::TAX, actions::COUP + 4};
+    CHECK_THROWS_AS(batch.step(mixed, obs.data(), masks.data(), rewards.data(), dones.data()), ActionError);
+    for (size_t i = 0; i < batch.size(); ++i) CHECK(batch.game(i).pack() == before[i]);
+    CHECK(obs == obsBefore);
+}
+
+TEST_CASE("Observation encodes a player's view with history and hidden coins") {
+    Game game(vector<string>{"Gov", "Spy", "Baron"});
+    Player* gov = game.getPlayers()[0];
+    Player* spy = game.getPlayers()[1];
+    game.tax(gov);
+    game.nextTurn();
+    game.gather(spy);
+    game.nextTurn();
+    CHECK(game.getTurnCount() == 2);
+    REQUIRE(game.recentActionCount() == 2);
+    CHECK(game.recentAction(0).action == ActionType::Gather);
+    CHECK(game.recentAction(1).actor == gov);
+    CHECK_THROWS_AS(game.recentAction(2), std::out_of_range);
+
+    int8_t view[obs::SIZE];
+    encodeObservation(game, gov, view);
+    CHECK(view[obs::COINS] == 3);
+    CHECK(view[obs::ROLE + static_cast<int>(Role::Governor)] == 1);
+    CHECK(view[obs::TURN_COUNT] == 2);
+    CHECK(view[obs::OPPONENT + obs::OPP_PRESENT] == 1);
+    CHECK(view[obs::OPPONENT + obs::OPP_COINS] == -1); // Governor cannot see coins
+    CHECK(view[obs::OPPONENT + 2 * obs::OPPONENT_STRIDE + obs::OPP_PRESENT] == 0);
+    CHECK(view[obs::HISTORY + obs::HIST_ACTION] == static_cast<int>(ActionType::Gather) + 1);
+    CHECK(view[obs::HISTORY + obs::HIST_ACTOR] == 2);  // the Spy, one seat after the viewer
+    CHECK(view[obs::HISTORY + obs::HISTORY_STRIDE + obs::HIST_ACTOR] == 1); // the viewer
+
+    encodeObservation(game, spy, view);
+    CHECK(view[obs::OPPONENT + obs::OPPONENT_STRIDE + obs::OPP_COINS] == 3); // Spy sees the Governor
+    CHECK(view[obs::HISTORY + obs::HIST_ACTOR] == 1);
+
+    Game copy(game);
+    REQUIRE(copy.recentActionCount() == 2);
+    CHECK(copy.recentAction(1).actor == copy.getPlayers()[0]);
+
+    float scaled[obs::SIZE];
+    encodeObservation(copy, copy.getPlayers()[0], scaled, true);
+    CHECK(scaled[obs::OPPONENT + obs::OPP_COINS] == doctest::Approx(1.0f / Game::FORCE_COUP));
+
+    Game other(vector<string>{"A", "B"});
+    CHECK_THROWS_AS(encodeObservation(game, other.getPlayers()[0], view), std::invalid_argument);
+}
+
+TEST_CASE("Mlp evaluates batches, round-trips weights and quantizes") {
+    Mlp net(obs::SIZE, {32, 16}, actions::COUNT, 7);
+    CHECK(net.inputSize() == obs::SIZE);
+    CHECK(net.policySize() == actions::COUNT);
+
+    Game game(vector<string>{"A", "B", "C"});
+    const size_t batch = 5; // one blocked group of four plus a remainder row
+    vector<float> input(batch * obs::SIZE);
+    for (size_t r = 0; r < batch; ++r) {
+        encodeObservation(game, game.getPlayers()[r % 3], &input[r * obs::SIZE], true);
+        input[r * obs::SIZE + obs::TURN_COUNT] = static_cast<float>(r);
+    }
+    vector<float> logits(batch * actions::COUNT), values(batch);
+    net.evaluate(input.data(), batch, logits.data(), values.data());
+
+    float single[actions::COUNT];
+    float value = 0.0f;
+    net.evaluate(&input[4 * obs::SIZE], 1, single, &value);
+    CHECK(single[3] == doctest::Approx(logits[4 * actions::COUNT + 3]));
+    CHECK(value == doctest::Approx(values[4]));
+    CHECK(value >= -1.0f);
+    CHECK(value <= 1.0f);
+
+    const string path = "test_mlp.bin";
+    net.save(path);
+    Mlp loaded = Mlp::load(path);
+    vector<float> again(batch * actions::COUNT);
+    loaded.evaluate(input.data(), batch, again.data(), nullptr);
+    for (size_t i = 0; i < again.size(); ++i) {
+        CHECK(again[i] == doctest::Approx(logits[i]));
+    }
+
+    loaded.setPrecision(Mlp::Precision::Int8);
+    loaded.evaluate(input.data(), batch, again.data(), nullptr);
+    float worst = 0.0f;
+    for (size_t i = 0; i < again.size(); ++i) {
+        worst = max(worst, fabs(again[i] - logits[i]));
+    }
+    CHECK(worst < 0.1f);
+
+    const int action = loaded.bestLegalAction(game);
+    CHECK(((legalActionMask(game) >> action) & 1u) == 1u);
+    CHECK_THROWS_AS(Mlp(4, {8}, 3).bestLegalAction(game), InitError);
+
+    {
+        ofstream bad(path, ios::binary | ios::trunc);
+        bad << "MLP1";
+    }
+    CHECK_THROWS_AS(Mlp::load(path), std::runtime_error);
+    remove(path.c_str());
+}
+
+TEST_CASE("DecisionService batches decisions across many games") {
+    SUBCASE("block prompts suspend the game and apply the block") {
+        vector<DecisionRequest> seen;
+        vector<int> script = {actions::GATHER, actions::TAX, 1, actions::GATHER};
+        DecisionService service([&](const vector<DecisionRequest>& requests, vector<int>& answers) {
+            seen.push_back(requests[0]);
+            answers[0] = script[seen.size() - 1];
+        });
+        service.addGame(Game(vector<string>{"Gov", "Spy", "Baron"}));
+        for (size_t i = 0; i < script.size(); ++i) {
+            CHECK(service.step() == 1);
+        }
+        CHECK(seen[2].kind == DecisionKind::Block);
+        CHECK(seen[2].player->getRole() == Role::Governor);
+        CHECK(seen[2].challenged == ActionType::Tax);
+        CHECK(seen[3].kind == DecisionKind::Turn);
+        CHECK(seen[3].player->getRole() == Role::Spy); // a blocked tax does not end the turn
+        CHECK(((seen[3].legal >> actions::TAX) & 1u) == 0u);
+        CHECK(service.game(0).getPlayers()[1]->getCoins() == 1);
+    }
+
+    SUBCASE("heuristic and network policies finish every game") {
+        Mlp net(obs::SIZE, {32}, actions::COUNT, 3);
+        for (const BatchPolicy& policy: {BatchPolicy(heuristicBatchPolicy), mlpBatchPolicy(net)}) {
+            DecisionService service(policy, 16);
+            for (int i = 0; i < 40; ++i) {
+                service.addGame(Game(vector<string>{"A", "B", "C", "D"}, i % 2 == 0), 300);
+            }
+            const size_t batches = service.run();
+            CHECK(batches == service.batchesEvaluated());
+            CHECK(service.requestsAnswered() > batches);
+            for (size_t g = 0; g < service.size(); ++g) {
+                CHECK(service.finished(g));
+                CHECK(service.decisions(g) <= 300);
+                if (service.winner(g)) CHECK(service.game(g).getPlayers().size() == 1u);
+            }
+        }
+    }
+
+    SUBCASE("illegal answers are rejected") {
+        DecisionService service([](const vector<DecisionRequest>&, vector<int>& answers) {
+            answers.assign(answers.size(), actions::COUP);
+        });
+        service.addGame(Game(vector<string>{"A", "B"}));
+        CHECK_THROWS_AS(service.run(), ActionError);
+        CHECK_THROWS_AS(DecisionService(heuristicBatchPolicy, 0), InitError);
+    }
+}
+
+TEST_CASE("TurnPipeline suspends at block prompts and the scheduler interleaves games") {
+    Game game(vector<string>{"Gov", "Spy", "Baron", "General"});
+    Player* gov = game.getPlayers()[0];
+    Player* general = game.getPlayers()[3];
+    gov->addCoins(7);
+    general->addCoins(5);
+
+    TurnPipeline pipeline(game);
+    CHECK(pipeline.awaiting() == Await::Action);
+    CHECK(pipeline.decider() == gov);
+    pipeline.resume(actions::COUP + 1); // coup the Baron
+    CHECK(pipeline.awaiting() == Await::Block);
+    CHECK(pipeline.decider() == general);
+    CHECK(pipeline.challenged() == ActionType::Coup);
+    CHECK(pipeline.legal() == (TurnPipeline::ALLOW | TurnPipeline::BLOCK));
+    CHECK_THROWS_AS(pipeline.resume(2), ActionError);
+    pipeline.resume(1);
+    CHECK(pipeline.awaiting() == Await::Action);
+    CHECK(pipeline.decider() == gov); // a blocked coup still costs but does not end the turn
+    CHECK(gov->getCoins() == 0);
+    CHECK(general->getCoins() == 0);
+    CHECK(game.getPlayers().size() == 4u);
+
+    PipelineScheduler scheduler;
+    for (int i = 0; i < 2000; ++i) {
+        scheduler.spawn(Game(vector<string>{"A", "B", "C"}, i % 2 == 0), 400);
+    }
+    mt19937 rng(11);
+    int rounds = 0;
+    while (!scheduler.ready().empty()) {
+        const vector<size_t> waiting = scheduler.ready();
+        for (const size_t task: waiting) {
+            const uint32_t legal = scheduler.pipeline(task).legal();
+            vector<int> options;
+            for (int a = 0; a < 32; ++a) {
+                if ((legal >> a) & 1u) options.push_back(a);
+            }
+            scheduler.resume(task, options[rng() % options.size()]);
+        }
+        ++rounds;
+    }
+    CHECK(rounds <= 400);
+    int won = 0;
+    for (size_t t = 0; t < scheduler.size(); ++t) {
+        CHECK(scheduler.finished(t));
+        won += scheduler.game(t).getPlayers().size() == 1;
+    }
+    CHECK(won > 0);
+    CHECK_THROWS_AS(scheduler.resume(0, 0), ActionError);
+}
+
+namespace {
+    /** Records every frame body (opcode first) per connection. */
+    struct RecordingSink : FrameSink {
+        map<ConnectionId, vector<vector<uint8_t>>> frames;
+        map<ConnectionId, vector<Frame>> shared;
+
+        void push(const ConnectionId connection, Frame frame, uint32_t) override {
+            frames[connection].emplace_back(frame->begin() + wire::HEADER, frame->end());
+            shared[connection].push_back(move(frame));
+        }
+
+        vector<uint8_t> last(const ConnectionId connection) {
+            return frames[connection].back();
+        }
+    };
+}
+
+TEST_CASE("TableHost pushes per-viewer deltas against the last acknowledged view") {
+    TableHost host;
+    RecordingSink sink;
+    const uint32_t table = host.create(2, false).id; // P0 Governor, P1 Spy
+    const auto request = [&](const ConnectionId from, const vector<uint8_t>& frame) {
+        host.handle(from, frame.data() + wire::HEADER, frame.size() - wire::HEADER, sink);
+    };
+    const ConnectionId governor = 1, spy = 2, spectator = 3;
+    request(governor, wire::FrameWriter(wire::Op::Join).u32(table).u8(0).finish());
+    request(spy, wire::FrameWriter(wire::Op::Join).u32(table).u8(1).finish());
+    request(spectator, wire::FrameWriter(wire::Op::Join).u32(table).u8(wire::SPECTATOR).finish());
+    map<ConnectionId, TableView> base;
+    for (const ConnectionId c: {governor, spy, spectator}) {
+        const vector<uint8_t> snap = sink.last(c);
+        base[c] = TableView::fromSnapshot(snap.data(), snap.size());
+    }
+    CHECK(base[governor].seats[1].coins == -1); // opponents' purses are hidden
+    CHECK(base[spy].seats[0].coins == 0);       // except from a Spy
+
+    request(governor, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    vector<uint8_t> delta = sink.last(spectator);
+    REQUIRE(static_cast<wire::Op>(delta[0]) == wire::Op::Delta);
+    CHECK(delta.back() == 0);                   // nothing the spectator may see changed but the turn
+    CHECK(delta.size() < base[spectator].snapshot().size() - wire::HEADER);
+    for (const ConnectionId c: {governor, spy, spectator}) {
+        delta = sink.last(c);
+        const TableView next = TableView::applyDelta(base[c], delta.data(), delta.size());
+        CHECK(next.snapshot() == TableHost::snapshot(*host.find(table), host.find(table)->seatOwnedBy(c)));
+        CHECK(next.version == 1u);
+        CHECK(next.turn == 1);
+    }
+    delta = sink.last(spy);
+    CHECK(TableView::applyDelta(base[spy], delta.data(), delta.size()).seats[0].coins == 1);
+    delta = sink.last(governor);
+    CHECK(TableView::applyDelta(base[governor], delta.data(), delta.size()).seats[1].coins == -1);
+
+    // Without an Ack the next delta still builds on the version 0 view
+    request(spy, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    delta = sink.last(spy);
+    CHECK(wire::FrameReader(delta.data(), delta.size()).u32() == table);
+    TableView latest = TableView::applyDelta(base[spy], delta.data(), delta.size());
+    CHECK(latest.version == 2u);
+    CHECK(latest.seats[0].coins == 1);
+    CHECK(latest.seats[1].coins == 1);
+    CHECK_THROWS_AS(TableView::applyDelta(latest, delta.data(), delta.size()), ProtocolError);
+
+    request(spy, wire::FrameWriter(wire::Op::Ack).u32(table).u32(2).finish());
+    request(governor, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    delta = sink.last(spy);
+    latest = TableView::applyDelta(latest, delta.data(), delta.size());
+    CHECK(latest.version == 3u);
+    CHECK(latest.seats[0].coins == 2);
+
+    TableView gone = latest;
+    gone.version = 4;
+    gone.seats[0] = SeatView{0, static_cast<uint8_t>(Role::Unknown), 0, 0};
+    const vector<uint8_t> frame = gone.delta(latest);
+    CHECK(TableView::applyDelta(latest, frame.data() + wire::HEADER, frame.size() - wire::HEADER).seats[0].alive == 0);
+}
+
+TEST_CASE("TimerWheel fires deadlines on time and TableHost clocks skip and decline") {
+    TimerWheel wheel;
+    mt19937_64 rng(5);
+    map<uint64_t, uint64_t> due; // payload -> deadline
+    vector<TimerId> handles;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        const uint64_t deadline = 1 + rng() % (i % 10 == 0 ? 20000000 : 5000);
+        handles.push_back(wheel.arm(deadline, i));
+        due[i] = deadline;
+        CHECK(handles.back() != 0);
+    }
+    for (uint64_t i = 0; i < 5000; i += 3) {
+        CHECK(wheel.cancel(handles[i]));
+        CHECK_FALSE(wheel.cancel(handles[i]));
+        due.erase(i);
+    }
+    CHECK(wheel.size() == due.size());
+    vector<uint64_t> fired;
+    bool onTime = true;
+    for (uint64_t now = 0, before = 0; now <= 20000000; before = now, now += 1 + rng() % 997) {
+        fired.clear();
+        wheel.advance(now, fired);
+        for (const uint64_t payload: fired) {
+            onTime &= due.count(payload) && due[payload] <= now && due[payload] > before;
+            due.erase(payload);
+        }
+    }
+    wheel.advance(20001000, fired);
+    CHECK(onTime);
+    CHECK(due.empty());
+    CHECK(wheel.size() == 0u);
+    CHECK_FALSE(wheel.cancel(handles[1])); // a fired handle is stale
+
+    TableHost host;
+    RecordingSink sink;
+    host.setClocks(100, 50);
+    HostedTable &table = host.create(2, false); // P0 Governor, P1 Spy
+    CHECK(host.pendingDeadlines() == 1u);
+    CHECK(host.expire(90, sink) == 0u);
+    CHECK(host.expire(100, sink) == 1u);          // P0 ran out of time and skipped
+    CHECK(table.version == 1u);
+    CHECK(table.pipeline.decider()->getName() == "P1");
+    CHECK(table.seatPlayer(0)->getCoins() == 0);
+
+    const auto request = [&](const ConnectionId from, const vector<uint8_t>& frame) {
+        host.handle(from, frame.data() + wire::HEADER, frame.size() - wire::HEADER, sink);
+    };
+    request(2, wire::FrameWriter(wire::Op::Join).u32(table.id).u8(1).finish());
+    request(2, wire::FrameWriter(wire::Op::Act).u32(table.id).u8(actions::TAX).finish());
+    REQUIRE(table.pipeline.awaiting() == Await::Block); // P0's Governor may block
+    CHECK(host.expire(140, sink) == 0u);
+    CHECK(host.expire(150, sink) == 1u);          // the block window closed unanswered
+    CHECK(table.seatPlayer(1)->getCoins() == 2);
+    CHECK(table.pipeline.decider()->getName() == "P0");
+    CHECK(static_cast<wire::Op>(sink.last(2)[0]) == wire::Op::Delta);
+    CHECK(host.pendingDeadlines() == 1u);
+}
+
+TEST_CASE("Games pack compactly and idle tables hibernate under a memory budget") {
+    mt19937 rng(21);
+    Game game(vector<string>{"A", "B", "C", "D"}, true);
+    for (int step = 0; step < 30 && game.getPlayers().size() > 1; ++step) {
+        vector<int> options;
+        const uint32_t legal = legalActionMask(game);
+        for (int a = 0; a < 32; ++a) {
+            if (legal >> a & 1u) options.push_back(a);
+        }
+        applyAction(game, options[rng() % options.size()]);
+    }
+    const vector<uint8_t> packed = game.pack();
+    CHECK(packed.size() < 128u);
+    const Game copy = Game::unpack(packed.data(), packed.size());
+    CHECK(copy.pack() == packed);
+    REQUIRE(copy.getPlayers().size() == game.getPlayers().size());
+    for (size_t i = 0; i < game.getPlayers().size(); ++i) {
+        CHECK(copy.getPlayers()[i]->getName() == game.getPlayers()[i]->getName());
+        CHECK(copy.getPlayers()[i]->getRole() == game.getPlayers()[i]->getRole());
+        CHECK(copy.getPlayers()[i]->getCoins() == game.getPlayers()[i]->getCoins());
+    }
+    CHECK(copy.getTurn() == game.getTurn());
+    CHECK(copy.getTurnCount() == game.getTurnCount());
+    CHECK(copy.recentActionCount() == game.recentActionCount());
+    CHECK(copy.recentAction(0).action == game.recentAction(0).action);
+    CHECK_THROWS_AS(Game::unpack(packed.data(), packed.size() - 1), InitError);
+
+    TableHost host;
+    RecordingSink sink;
+    vector<uint32_t> ids;
+    for (int i = 0; i < 50; ++i) {
+        ids.push_back(host.create(3, false).id);
+    }
+    const size_t perTable = host.residentBytes() / 50;
+    host.setMemoryBudget(perTable * 4);
+    CHECK(host.residentBytes() <= perTable * 4);
+    CHECK(host.hibernatingCount() == 46u);
+    HostedTable &oldest = *host.find(ids[0]);
+    REQUIRE(oldest.hibernating());
+    CHECK(oldest.game.getPlayers().empty()); // players are freed, not just hidden
+
+    const auto request = [&](const ConnectionId from, const vector<uint8_t>& frame) {
+        host.handle(from, frame.data() + wire::HEADER, frame.size() - wire::HEADER, sink);
+    };
+    request(1, wire::FrameWriter(wire::Op::Join).u32(ids[0]).u8(0).finish());
+    request(1, wire::FrameWriter(wire::Op::Act).u32(ids[0]).u8(actions::GATHER).finish());
+    CHECK(static_cast<wire::Op>(sink.last(1)[0]) == wire::Op::Delta);
+    CHECK_FALSE(oldest.hibernating());       // woken by the request, kept as most recent
+    CHECK(oldest.seatPlayer(0)->getCoins() == 1);
+    CHECK(host.hibernate(ids[0]));
+    request(1, wire::FrameWriter(wire::Op::State).u32(ids[0]).finish());
+    const vector<uint8_t> state = sink.last(1);
+    const TableView view = TableView::fromSnapshot(state.data(), state.size());
+    CHECK(view.seats[0].coins == 1);          // state survived a sleep
+    CHECK(view.turn == 1);
+    CHECK(host.hibernatingCount() == 46u);
+    CHECK(host.residentBytes() <= perTable * 4);
+
+    // The last arrest survives a sleep: woken players point at each other, not at freed clones
+    host.wake(oldest);
+    oldest.game.arrest(oldest.seatPlayer(1), oldest.seatPlayer(0));
+    const vector<uint8_t> arrested = oldest.game.pack();
+    REQUIRE(host.hibernate(ids[0]));
+    host.wake(oldest);
+    CHECK(oldest.seatPlayer(1)->getLastArrestedPlayer() == oldest.seatPlayer(0));
+    CHECK(oldest.game.pack() == arrested);
+    CHECK_THROWS_AS(oldest.game.arrest(oldest.seatPlayer(1), oldest.seatPlayer(0)), ArrestTwiceInRow);
+}
+
+TEST_CASE("Matchmaker forms tables by rating and widens the search over time") {
+    Matchmaker::Options bad;
+    bad.maxSeats = 7;
+    CHECK_THROWS_AS(Matchmaker{bad}, InitError);
+
+    Matchmaker queue;
+    for (uint64_t p = 1; p <= 5; ++p) CHECK(queue.enqueue(p, 1500 + static_cast<int>(p), 0));
+    CHECK_FALSE(queue.enqueue(3, 1500, 0));
+    CHECK(queue.enqueue(6, 1900, 0));
+    CHECK(queue.enqueue(7, 3500, 0));
+    CHECK(queue.match(0).empty());           // five within reach, the sixth too far for now
+    const vector<Match> widened = queue.match(6000); // +300 after six seconds
+    REQUIRE(widened.size() == 1u);
+    CHECK(widened[0].players.size() == 6u);
+    CHECK(widened[0].players[0] == 1u);      // the oldest anchors the table
+    CHECK(widened[0].players[5] == 6u);      // the far one comes last
+    CHECK(widened[0].longestWaitMs == 6000u);
+    CHECK(queue.size() == 1u);
+    CHECK(queue.waiting(7));
+
+    CHECK(queue.enqueue(8, 3560, 6000));
+    CHECK(queue.match(9000).empty());        // two players wait for a fuller table...
+    const vector<Match> shortTable = queue.match(16000);
+    REQUIRE(shortTable.size() == 1u);        // ...until the anchor has waited long enough
+    CHECK(shortTable[0].players == vector<uint64_t>{7, 8});
+    CHECK(queue.enqueue(9, 100, 16000));
+    CHECK(queue.enqueue(10, 2000, 16000));
+    CHECK(queue.match(60000).empty());       // the spread stops growing at maxSpread
+    CHECK(queue.cancel(9));
+    CHECK_FALSE(queue.cancel(9));
+    CHECK(queue.size() == 1u);
+
+    // A large queue: every table is full and stays within its spread
+    Matchmaker big;
+    mt19937 rng(46);
+    constexpr uint64_t crowd = 200000;
+    for (uint64_t p = 0; p < crowd; ++p) big.enqueue(p, 1000 + static_cast<int>(rng() % 1000), p / 100);
+    const vector<Match> batch = big.match(crowd / 100, 1000);
+    CHECK(batch.size() == 1000u);
+    const vector<Match> rest = big.match(crowd / 100);
+    bool full = true, close = true;
+    size_t seated = 0;
+    for (const vector<Match>* formed: {&batch, &rest}) {
+        for (const Match& m: *formed) {
+            full &= m.players.size() == 6u;
+            const auto range = minmax_element(m.ratings.begin(), m.ratings.end());
+            close &= *range.second - *range.first < 2 * (m.spread + 50);
+            seated += m.players.size();
+        }
+    }
+    CHECK(full);
+    CHECK(close);
+    CHECK(seated + big.size() == crowd);
+    CHECK(big.size() < 6 * 21u);             // at most a short table's worth per bucket is left
+
+    const vector<Game> games = Matchmaker::games(widened, [](const uint64_t p) { return "u" + to_string(p); }, false);
+    REQUIRE(games.size() == 1u);
+    CHECK(games[0].getPlayers().size() == 6u);
+    CHECK(games[0].getPlayers()[5]->getName() == "u6");
+}
+
+TEST_CASE("Rating engine applies multiplayer Glicko-2 over parallel periods") {
+    // Glickman's worked example: 1500/200 beats 1400/30, loses to 1550/100 and 1700/300
+    RatingEngine paper;
+    paper.set(0, Rating{1500, 200, 0.06, 0});
+    paper.set(1, Rating{1400, 30, 0.06, 0});
+    paper.set(2, Rating{1550, 100, 0.06, 0});
+    paper.set(3, Rating{1700, 300, 0.06, 0});
+    paper.recordFinish({0, 1});
+    paper.recordFinish({2, 0});
+    paper.recordFinish({3, 0});
+    CHECK(paper.pending() == 3u);
+    paper.closePeriod();
+    CHECK(paper.rating(0).rating == doctest::Approx(1464.06).epsilon(0.0001));
+    CHECK(paper.rating(0).deviation == doctest::Approx(151.52).epsilon(0.0001));
+    CHECK(paper.rating(0).volatility == doctest::Approx(0.05999).epsilon(0.0001));
+    CHECK(paper.rating(0).games == 3u);
+    CHECK(paper.pending() == 0u);
+    CHECK_THROWS_AS(paper.record({1, 1}, {0, 1}), InitError);
+    CHECK_THROWS_AS(paper.recordFinish({1}), InitError);
+
+    // Free-for-all tables of hidden skill: the ratings recover the order, whatever the thread count
+    mt19937 rng(47);
+    constexpr uint32_t players = 3000;
+    RatingEngine::Options parallel;
+    parallel.threads = 4;
+    RatingEngine one;
+    RatingEngine four(parallel);
+    for (int period = 0; period < 6; ++period) {
+        for (int game = 0; game < 20000; ++game) {
+            const size_t seats = 2 + rng() % 5;
+            vector<pair<double, uint32_t>> table;
+            while (table.size() < seats) {
+                const uint32_t p = rng() % players;
+                bool seated = false;
+                for (const auto& s: table) seated |= s.second == p;
+                if (!seated) table.emplace_back(p + normal_distribution<double>(0, 600)(rng), p);
+            }
+            sort(table.rbegin(), table.rend()); // the strongest performance wins
+            vector<uint32_t> finish;
+            for (const auto& s: table) finish.push_back(s.second);
+            one.recordFinish(finish);
+            four.recordFinish(finish);
+        }
+        one.closePeriod();
+        four.closePeriod();
+    }
+    CHECK(four.periods() == 6u);
+    bool same = true;
+    double weakest = 0, strongest = 0;
+    for (uint32_t p = 0; p < players; ++p) {
+        same &= one.rating(p).rating == four.rating(p).rating && one.rating(p).deviation == four.rating(p).deviation;
+        if (p < players / 10) weakest += four.rating(p).rating;
+        if (p >= players - players / 10) strongest += four.rating(p).rating;
+    }
+    CHECK(same);
+    CHECK(strongest - weakest > 300.0 * (players / 10));
+    CHECK(four.rating(players - 1).deviation < 100.0);
+
+    const string path = "ratings_test.bin";
+    four.save(path);
+    RatingEngine restored;
+    restored.load(path);
+    CHECK(restored.playerCount() == players);
+    CHECK(restored.periods() == 6u);
+    CHECK(restored.rating(7).rating == doctest::Approx(four.rating(7).rating).epsilon(0.00001));
+    CHECK(restored.rating(7).games == four.rating(7).games);
+    {
+        // A corrupt count is caught against the file size, not by trying to allocate it
+        fstream store(path, ios::binary | ios::in | ios::out);
+        const uint64_t huge = UINT32_MAX;
+        store.seekp(12);
+        store.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    CHECK_THROWS_AS(restored.load(path), runtime_error);
+    CHECK(restored.playerCount() == players);
+    std::remove(path.c_str());
+    CHECK_THROWS_AS(restored.load(path), runtime_error);
+}
+
+TEST_CASE("Leaderboard answers rank, top and neighbourhood queries under updates") {
+    Leaderboard board;
+    board.update(7, 1500);
+    board.update(3, 1700);
+    board.update(9, 1500);
+    CHECK(board.size() == 3u);
+    CHECK(board.rank(3) == 0u);
+    CHECK(board.rank(7) == 1u);              // equal scores rank by player id
+    CHECK(board.rank(9) == 2u);
+    board.update(9, 1800);
+    CHECK(board.rank(9) == 0u);
+    CHECK(board.at(2).player == 7u);
+    CHECK(board.remove(3));
+    CHECK_FALSE(board.remove(3));
+    CHECK_THROWS_AS(board.rank(3), InitError);
+    CHECK_THROWS_AS(board.at(2), InitError);
+
+    // Against a sorted copy under a stream of moves and removals
+    mt19937 rng(48);
+    constexpr uint32_t players = 20000;
+    Leaderboard big(5);
+    big.reserve(players);
+    vector<double> score(players, -1);
+    for (int step = 0; step < 200000; ++step) {
+        const uint32_t p = rng() % players;
+        if (rng() % 10 == 0) {
+            big.remove(p);
+            score[p] = -1;
+        } else {
+            score[p] = static_cast<double>(1000 + rng() % 2000);
+            big.update(p, score[p]);
+        }
+    }
+    vector<pair<double, uint32_t>> sorted;
+    for (uint32_t p = 0; p < players; ++p) {
+        if (score[p] >= 0) sorted.emplace_back(-score[p], p);
+    }
+    sort(sorted.begin(), sorted.end());
+    REQUIRE(big.size() == sorted.size());
+    bool ranks = true;
+    for (size_t r = 0; r < sorted.size(); r += 97) {
+        ranks &= big.rank(sorted[r].second) == r && big.at(r).player == sorted[r].second;
+    }
+    CHECK(ranks);
+    const vector<Standing> best = big.top(50);
+    REQUIRE(best.size() == 50u);
+    bool topMatches = true;
+    for (size_t r = 0; r < best.size(); ++r) {
+        topMatches &= best[r].player == sorted[r].second && best[r].rank == r && best[r].score == -sorted[r].first;
+    }
+    CHECK(topMatches);
+    const uint32_t middle = sorted[sorted.size() / 2].second;
+    const vector<Standing> near = big.around(middle, 5);
+    REQUIRE(near.size() == 11u);
+    CHECK(near[5].player == middle);
+    CHECK(near[0].rank == sorted.size() / 2 - 5);
+    CHECK(big.around(sorted[1].second, 3).size() == 5u); // clipped at the top
+    CHECK(big.range(sorted.size() - 2, 10).size() == 2u); // and at the bottom
+}
+
+#ifdef __linux__
+namespace {
+    int connectTcp(const uint16_t port) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        return fd;
+    }
+
+    int connectUnix(const string& path) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        return fd;
+    }
+
+    void sendFrame(const int fd, const vector<uint8_t>& frame) {
+        REQUIRE(::send(fd, frame.data(), frame.size(), 0) == static_cast<ssize_t>(frame.size()));
+    }
+
+    bool readExact(const int fd, uint8_t* out, size_t length) {
+        while (length > 0) {
+            const ssize_t got = recv(fd, out, length, 0);
+            if (got <= 0) return false;
+            out += got;
+            length -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    /** Body (opcode first) of the next frame on a blocking socket. */
+    vector<uint8_t> readFrame(const int fd) {
+        uint8_t header[wire::HEADER];
+        REQUIRE(readExact(fd, header, sizeof(header)));
+        vector<uint8_t> body(header[0] | header[1] << 8);
+        REQUIRE(readExact(fd, body.data(), body.size()));
+        return body;
+    }
+}
+
+TEST_CASE("GameServer hosts tables over TCP and Unix sockets") {
+    GameServer server;
+    const uint16_t port = server.listenTcp(0);
+    const string path = "coup_test_server.sock";
+    server.listenUnix(path);
+    thread loop([&] { server.run(); });
+
+    const int alice = connectTcp(port);
+    const int bob = connectTcp(port);
+    sendFrame(alice, wire::FrameWriter(wire::Op::Create).u8(2).u8(0).finish());
+    vector<uint8_t> reply = readFrame(alice);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Created);
+    const uint32_t table = wire::FrameReader(reply.data(), reply.size()).u32();
+
+    sendFrame(alice, wire::FrameWriter(wire::Op::Join).u32(table).u8(0).finish());
+    CHECK(static_cast<wire::Op>(readFrame(alice)[0]) == wire::Op::Ok);
+    CHECK(static_cast<wire::Op>(readFrame(alice)[0]) == wire::Op::Snapshot);
+    sendFrame(bob, wire::FrameWriter(wire::Op::Join).u32(table).u8(1).finish());
+    CHECK(static_cast<wire::Op>(readFrame(bob)[0]) == wire::Op::Ok);
+    CHECK(static_cast<wire::Op>(readFrame(bob)[0]) == wire::Op::Snapshot);
+    sendFrame(bob, wire::FrameWriter(wire::Op::Join).u32(table).u8(0).finish());
+    reply = readFrame(bob);
+    CHECK(reply[1] == static_cast<uint8_t>(wire::ErrorCode::SeatTaken));
+
+    sendFrame(bob, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    reply = readFrame(bob);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Error);
+    CHECK(reply[1] == static_cast<uint8_t>(wire::ErrorCode::NotYourTurn));
+
+    sendFrame(alice, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    reply = readFrame(alice);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Ok);
+    CHECK(static_cast<wire::Op>(readFrame(alice)[0]) == wire::Op::Delta); // both watchers get the change
+    CHECK(static_cast<wire::Op>(readFrame(bob)[0]) == wire::Op::Delta);
+
+    const int watcher = connectUnix(path);
+    sendFrame(watcher, wire::FrameWriter(wire::Op::State).u32(table).finish());
+    reply = readFrame(watcher);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Snapshot);
+    wire::FrameReader snap(reply.data(), reply.size());
+    CHECK(snap.u32() == table);
+    CHECK(snap.u32() == 1u);                                    // version
+    CHECK(snap.u8() == static_cast<uint8_t>(Await::Action));
+    CHECK(snap.u8() == 1);                                      // Bob decides now
+    snap.u8();
+    CHECK(snap.u8() == 1);                                      // turn seat
+    CHECK(snap.u8() == 2);                                      // seats
+    CHECK(snap.u8() == 1);                                      // seat 0 alive
+    snap.u8();
+    CHECK(snap.i16() == -1);                                    // a spectator cannot see coins
+    sendFrame(alice, wire::FrameWriter(wire::Op::State).u32(table).finish());
+    reply = readFrame(alice);
+    CHECK(TableView::fromSnapshot(reply.data(), reply.size()).seats[0].coins == 1); // Alice gathered one coin
+
+    sendFrame(watcher, wire::FrameWriter(wire::Op::State).u32(999).finish());
+    CHECK(readFrame(watcher)[1] == static_cast<uint8_t>(wire::ErrorCode::NoTable));
+    sendFrame(watcher, wire::FrameWriter(static_cast<wire::Op>(0x7F)).finish());
+    CHECK(readFrame(watcher)[1] == static_cast<uint8_t>(wire::ErrorCode::Malformed));
+
+    ::close(alice);
+    ::close(bob);
+    ::close(watcher);
+    server.stop();
+    loop.join();
+    CHECK(server.host().tableCount() == 1u);
+}
+
+TEST_CASE("Spectators share one immutable frame and slow consumers coalesce") {
+    TableHost host;
+    RecordingSink sink;
+    const uint32_t table = host.create(2, false).id;
+    const auto request = [&](const ConnectionId from, const vector<uint8_t>& frame) {
+        host.handle(from, frame.data() + wire::HEADER, frame.size() - wire::HEADER, sink);
+    };
+    request(1, wire::FrameWriter(wire::Op::Join).u32(table).u8(0).finish());
+    for (ConnectionId c = 10; c < 1010; ++c) {
+        request(c, wire::FrameWriter(wire::Op::Join).u32(table).u8(wire::SPECTATOR).finish());
+    }
+    request(1, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    const Frame first = sink.shared[10].back();
+    for (ConnectionId c = 11; c < 1010; ++c) {
+        CHECK(sink.shared[c].back() == first); // one buffer for every spectator
+    }
+    CHECK(sink.shared[1].back() != first);     // the seated player sees its own coins
+
+    OutQueue queue;
+    queue.push(make_shared<const vector<uint8_t>>(vector<uint8_t>{1, 2, 3}), 0);
+    queue.push(first, table);
+    queue.push(make_shared<const vector<uint8_t>>(vector<uint8_t>{4}), 0);
+    const Frame latest = make_shared<const vector<uint8_t>>(vector<uint8_t>{5, 6});
+    queue.push(latest, table); // replaces the stale push in place
+    CHECK(queue.frames() == 3u);
+    CHECK(queue.bytes() == 6u);
+    queue.consume(2);
+    queue.push(make_shared<const vector<uint8_t>>(vector<uint8_t>{7, 8, 9}), 7);
+    iovec iov[8];
+    REQUIRE(queue.gather(iov, 8) == 4u);
+    CHECK(*static_cast<uint8_t*>(iov[0].iov_base) == 3);
+    CHECK(iov[1].iov_base == latest->data()); // queued without a copy
+    queue.consume(4);                          // 3, 5, 6 and 4
+    CHECK(queue.frames() == 1u);
+    queue.consume(1);
+    queue.push(make_shared<const vector<uint8_t>>(vector<uint8_t>{1}), 7); // the front is part sent, so queue behind
+    CHECK(queue.frames() == 2u);
+    queue.consume(queue.bytes());
+    CHECK(queue.empty());
+}
+
+TEST_CASE("ActionLog group-commits records and GameServer recovers tables from it") {
+    const string path = "coup_test_actions.wal";
+    remove(path.c_str());
+    {
+        ActionLog log(path);
+        for (uint32_t i = 0; i < 1000; ++i) {
+            log.append(vector<uint8_t>{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)});
+        }
+        log.sync();
+        CHECK(log.durable() == log.appended());
+        CHECK(log.commits() < 1000u); // records share syncs
+    }
+    {
+        ofstream out(path, ios::binary | ios::app);
+        const char torn[] = {9, 0, 0, 0, 'a', 'b', 'c'}; // a record cut short by a crash
+        out.write(torn, sizeof torn);
+    }
+    uint32_t seen = 0;
+    bool inOrder = true;
+    ActionLog::replay(path, [&](const uint8_t* record, const size_t length) {
+        inOrder &= length == 2 && static_cast<uint32_t>(record[0] | record[1] << 8) == seen;
+        ++seen;
+    });
+    CHECK(seen == 1000u);
+    CHECK(inOrder);
+    {
+        ActionLog log(path); // cuts the torn tail before appending
+        log.append(vector<uint8_t>{7});
+    }
+    seen = 0;
+    ActionLog::replay(path, [&](const uint8_t*, size_t) { ++seen; });
+    CHECK(seen == 1001u);
+    remove(path.c_str());
+
+    uint32_t table;
+    vector<uint8_t> before;
+    {
+        GameServer server;
+        CHECK(server.openLog(path) == 0u);
+        const uint16_t port = server.listenTcp(0);
+        thread loop([&] { server.run(); });
+        const int client = connectTcp(port);
+        sendFrame(client, wire::FrameWriter(wire::Op::Create).u8(3).u8(1).finish());
+        vector<uint8_t> reply = readFrame(client);
+        REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Created);
+        table = wire::FrameReader(reply.data(), reply.size()).u32();
+        sendFrame(client, wire::FrameWriter(wire::Op::Join).u32(table).u8(0).finish());
+        readFrame(client);
+        readFrame(client);
+        sendFrame(client, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+        CHECK(static_cast<wire::Op>(readFrame(client)[0]) == wire::Op::Ok); // only once durable
+        ::close(client);
+        server.stop();
+        loop.join();
+        before = server.host().find(table)->game.pack();
+    }
+    {
+        GameServer restarted;
+        CHECK(restarted.openLog(path) == 2u); // created, then one answer
+        HostedTable* recovered = restarted.host().find(table);
+        REQUIRE(recovered);
+        CHECK(recovered->game.pack() == before); // random roles included
+        CHECK(recovered->version == 1u);
+        CHECK(restarted.host().create(2, false).id > table);
+    }
+    remove(path.c_str());
+
+    // A log that cannot grow (here: a file size limit) must stop the server rather than hold replies forever
+    const pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        signal(SIGXFSZ, SIG_IGN);
+        const rlimit limit{16, 16};
+        setrlimit(RLIMIT_FSIZE, &limit);
+        int status = 1;
+        try {
+            ActionLog log(path);
+            log.append(vector<uint8_t>(64, 1));
+            try {
+                log.sync();
+            } catch (const runtime_error&) {
+                status = log.failed() ? 2 : 1;
+            }
+            remove(path.c_str());
+            GameServer server;
+            server.openLog(path);
+            const uint16_t port = server.listenTcp(0);
+            const int client = connectTcp(port);
+            sendFrame(client, wire::FrameWriter(wire::Op::Create).u8(3).u8(1).finish());
+            for (int round = 0; round < 100 && status == 2; ++round) {
+                try {
+                    server.poll(20);
+                } catch (const runtime_error&) {
+                    status = 0;
+                }
+            }
+        } catch (const exception&) {
+        }
+        _exit(status);
+    }
+    int status = -1;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    remove(path.c_str());
+}
+
+TEST_CASE("Fork checkpoints capture every table and bound log replay") {
+    RecordingSink sink;
+    TableHost host;
+    HostedTable &idle = host.create(3, true);
+    HostedTable &blocked = host.create(2, false); // P0 Governor, P1 Spy
+    blocked.pipeline.resume(actions::GATHER);
+    blocked.pipeline.resume(actions::TAX);
+    REQUIRE(blocked.pipeline.awaiting() == Await::Block);
+    ++blocked.version;
+    HostedTable &jailed = host.create(2, false);
+    jailed.seatPlayer(0)->addCoins(1);
+    jailed.game.arrest(jailed.seatPlayer(1), jailed.seatPlayer(0));
+    REQUIRE(host.hibernate(idle.id));
+    const vector<uint8_t> image = host.checkpoint(77);
+    TableHost copy;
+    CHECK(copy.restore(image.data(), image.size()) == 77u);
+    CHECK(copy.tableCount() == 3u);
+    HostedTable* restored = copy.find(blocked.id);
+    REQUIRE(restored);
+    CHECK(restored->version == 1u);
+    CHECK(restored->game.pack() == blocked.game.pack());
+    CHECK(restored->pipeline.pack() == blocked.pipeline.pack()); // still waiting for P0's block answer
+    REQUIRE(copy.find(idle.id));
+    CHECK(copy.find(idle.id)->game.pack() == idle.packed);
+    HostedTable *released = copy.find(jailed.id);
+    REQUIRE(released);
+    CHECK(released->seatPlayer(1)->getLastArrestedPlayer() == released->seatPlayer(0)); // not the image's players
+    CHECK(released->game.pack() == jailed.game.pack());
+    CHECK_THROWS_AS(released->game.arrest(released->seatPlayer(1), released->seatPlayer(0)), ArrestTwiceInRow);
+    CHECK(copy.create(2, false).id > jailed.id);
+    const vector<uint8_t> torn(image.begin(), image.end() - 1);
+    TableHost empty;
+    CHECK_THROWS_AS(empty.restore(torn.data(), torn.size()), InitError);
+
+    const string path = "coup_test_checkpoint.wal";
+    const string imagePath = path + ".ckpt";
+    remove(path.c_str());
+    remove(imagePath.c_str());
+    const auto request = [&](GameServer &server, const vector<uint8_t> &frame) {
+        server.host().handle(1, frame.data() + wire::HEADER, frame.size() - wire::HEADER, sink);
+    };
+    uint32_t first, second;
+    uint64_t cut = 0;
+    vector<uint8_t> firstGame, secondGame;
+    {
+        GameServer server;
+        CHECK_FALSE(server.checkpoint()); // nothing to checkpoint next to
+        server.openLog(path);
+        first = server.host().create(2, false).id;
+        request(server, wire::FrameWriter(wire::Op::Join).u32(first).u8(0).finish());
+        request(server, wire::FrameWriter(wire::Op::Act).u32(first).u8(actions::GATHER).finish());
+        REQUIRE(server.checkpoint());
+        CHECK_FALSE(server.checkpoint()); // one child at a time
+        second = server.host().create(3, true).id; // after the fork, so only in the log
+        for (int i = 0; i < 500 && server.checkpointPending(); ++i) server.poll(10);
+        CHECK_FALSE(server.checkpointPending());
+        CHECK(server.checkpointedLsn() > 0u);
+        firstGame = server.host().find(first)->game.pack();
+        secondGame = server.host().find(second)->game.pack();
+        cut = server.checkpointedLsn();
+    }
+    {
+        // The records the image covers are gone from the log: it starts at the checkpoint
+        ifstream in(path, ios::binary);
+        vector<uint8_t> head(12);
+        REQUIRE(in.read(reinterpret_cast<char*>(head.data()), 12));
+        uint64_t base = 0;
+        for (int i = 0; i < 8; ++i) base |= static_cast<uint64_t>(head[4 + i]) << (8 * i);
+        CHECK(string(head.begin(), head.begin() + 4) == "CWAL");
+        CHECK(base == cut);
+        CHECK_THROWS_AS(ActionLog::replay(path, [](const uint8_t*, size_t) {}, 0), InitError);
+    }
+    GameServer restarted;
+    CHECK(restarted.openLog(path) == 1u); // the checkpoint covers everything up to the fork
+    REQUIRE(restarted.host().find(first));
+    REQUIRE(restarted.host().find(second));
+    CHECK(restarted.host().find(first)->game.pack() == firstGame);
+    CHECK(restarted.host().find(first)->version == 1u);
+    CHECK(restarted.host().find(second)->game.pack() == secondGame);
+
+    // A periodic checkpoint only starts once something changed
+    const uint64_t saved = restarted.checkpointedLsn();
+    restarted.setCheckpointInterval(1);
+    for (int i = 0; i < 500 && restarted.checkpointedLsn() == saved; ++i) restarted.poll(10);
+    const uint64_t covered = restarted.checkpointedLsn();
+    CHECK(covered > saved); // the records replayed above were not in the old image
+    restarted.poll(5);
+    CHECK_FALSE(restarted.checkpointPending()); // nothing new to save
+    restarted.host().create(2, false);
+    for (int i = 0; i < 500 && restarted.checkpointedLsn() == covered; ++i) restarted.poll(10);
+    CHECK(restarted.checkpointedLsn() > covered);
+    remove(path.c_str());
+    remove(imagePath.c_str());
+}
+
+TEST_CASE("ShardedServer routes requests to the shard owning the table") {
+    SpscQueue<int> queue(3);
+    CHECK(queue.capacity() == 4u);
+    long long sum = 0;
+    thread producer([&] {
+        for (int i = 1; i <= 20000; ++i) {
+            while (!queue.tryPush(i)) this_thread::yield();
+        }
+    });
+    for (int received = 0; received < 20000;) {
+        int value;
+        if (queue.tryPop(value)) {
+            sum += value;
+            ++received;
+        }
+    }
+    producer.join();
+    CHECK(sum == 20000LL * 20001 / 2);
+
+    ShardedServer server(3);
+    const uint16_t port = server.listenTcp(0);
+    const string path = "coup_test_sharded.sock";
+    server.listenUnix(path); // lives on shard 0
+    server.start();
+
+    // Open TCP clients until one lands on a shard other than 0, so its table is remote for shard 0
+    vector<int> clients;
+    uint32_t table = 0;
+    int owner = -1;
+    for (int attempt = 0; attempt < 64 && table == 0; ++attempt) {
+        const int fd = connectTcp(port);
+        clients.push_back(fd);
+        sendFrame(fd, wire::FrameWriter(wire::Op::Create).u8(2).u8(0).finish());
+        const vector<uint8_t> reply = readFrame(fd);
+        REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Created);
+        const uint32_t id = wire::FrameReader(reply.data(), reply.size()).u32();
+        if ((id - 1) % 3 != 0) {
+            table = id;
+            owner = fd;
+        }
+    }
+    REQUIRE(table != 0);
+
+    const int local = connectUnix(path);
+    sendFrame(owner, wire::FrameWriter(wire::Op::Join).u32(table).u8(0).finish());
+    CHECK(static_cast<wire::Op>(readFrame(owner)[0]) == wire::Op::Ok);
+    readFrame(owner);
+    sendFrame(local, wire::FrameWriter(wire::Op::Join).u32(table).u8(1).finish());
+    CHECK(static_cast<wire::Op>(readFrame(local)[0]) == wire::Op::Ok);
+    readFrame(local);
+
+    sendFrame(owner, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::GATHER).finish());
+    CHECK(static_cast<wire::Op>(readFrame(owner)[0]) == wire::Op::Ok);
+    CHECK(static_cast<wire::Op>(readFrame(local)[0]) == wire::Op::Delta); // pushed across shards
+    sendFrame(local, wire::FrameWriter(wire::Op::Act).u32(table).u8(actions::TAX).finish());
+    vector<uint8_t> reply = readFrame(local);
+    CHECK(static_cast<wire::Op>(reply[0]) == wire::Op::Ok);
+    CHECK(wire::FrameReader(reply.data(), reply.size()).u32() == table);
+
+    for (const int fd: clients) ::close(fd);
+    ::close(local);
+    server.stop();
+    size_t tables = 0;
+    for (size_t i = 0; i < server.shardCount(); ++i) tables += server.shard(i).host().tableCount();
+    CHECK(tables == clients.size());
+}
+namespace {
+    /** Fork a process serving one GameServer on a Unix socket until it is killed. */
+    pid_t spawnEngine(const string& path) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            try {
+                GameServer engine;
+                engine.listenControl(path);
+                while (true) engine.poll(-1);
+            } catch (...) {
+            }
+            _exit(1);
+        }
+        return pid;
+    }
+
+    /** A stand-in engine on path that answers every request with an Error. */
+    pid_t spawnRefusingEngine(const string& path) {
+        remove(path.c_str());
+        const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        REQUIRE(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        REQUIRE(listen(listener, 1) == 0);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            const int fd = accept(listener, nullptr, nullptr);
+            const vector<uint8_t> refusal = wire::errorFrame(wire::ErrorCode::Illegal, "Refused");
+            vector<uint8_t> in;
+            uint8_t chunk[4096];
+            ssize_t n;
+            while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) {
+                in.insert(in.end(), chunk, chunk + n);
+                size_t body;
+                while ((body = wire::completeFrame(in.data(), in.size())) > 0) {
+                    in.erase(in.begin(), in.begin() + static_cast<ptrdiff_t>(wire::HEADER + body));
+                    if (::write(fd, refusal.data(), refusal.size()) < 0) _exit(1);
+                }
+            }
+            _exit(0);
+        }
+        ::close(listener);
+        return pid;
+    }
+
+    size_t attachEngine(Coordinator& coordinator, const string& path) {
+        for (int attempt = 0;; ++attempt) {
+            try {
+                return coordinator.addEngine(path);
+            } catch (const runtime_error&) {
+                if (attempt == 500) throw; // the engine never came up
+                this_thread::sleep_for(chrono::milliseconds(5));
+            }
+        }
+    }
+
+    /** Body of the next Ok frame reporting a given table version, skipping everything else. */
+    vector<uint8_t> readOk(const int fd, const uint32_t version) {
+        while (true) {
+            vector<uint8_t> reply = readFrame(fd);
+            if (static_cast<wire::Op>(reply[0]) != wire::Op::Ok) continue;
+            wire::FrameReader in(reply.data(), reply.size());
+            in.u32();
+            if (in.u32() == version) return reply;
+        }
+    }
+}
+
+TEST_CASE("Coordinator places tables on engine processes and migrates them") {
+    HashRing ring;
+    ring.add("a");
+    ring.add("b");
+    ring.add("c");
+    map<string, int> share;
+    vector<string> owners;
+    for (uint32_t key = 1; key <= 9000; ++key) {
+        owners.push_back(ring.owner(key));
+        ++share[owners.back()];
+    }
+    for (const auto& node: share) CHECK(node.second > 1800); // each near a third
+    ring.add("d");
+    int moved = 0;
+    bool onlyToNew = true;
+    for (uint32_t key = 1; key <= 9000; ++key) {
+        if (ring.owner(key) == owners[key - 1]) continue;
+        ++moved;
+        onlyToNew &= ring.owner(key) == "d";
+    }
+    CHECK(onlyToNew);
+    CHECK(moved > 1200);
+    CHECK(moved < 3500);
+    ring.remove("d");
+    bool restored = true;
+    for (uint32_t key = 1; key <= 9000; ++key) restored &= ring.owner(key) == owners[key - 1];
+    CHECK(restored);
+    CHECK_THROWS_AS(HashRing().owner(1), InitError);
+
+    const vector<string> engines{"coup_test_engine.0.sock", "coup_test_engine.1.sock", "coup_test_engine.2.sock"};
+    vector<pid_t> pids{spawnEngine(engines[0]), spawnEngine(engines[1])};
+    Coordinator coordinator;
+    const uint16_t port = coordinator.listenTcp(0);
+    attachEngine(coordinator, engines[0]);
+    attachEngine(coordinator, engines[1]);
+    thread loop([&] { coordinator.run(); });
+
+    // Create tables until one is bound for the third engine once it joins
+    const int client = connectTcp(port);
+    HashRing grown;
+    for (const string& engine: engines) grown.add(engine);
+    vector<uint32_t> tables;
+    uint32_t moving = 0;
+    while (moving == 0) {
+        sendFrame(client, wire::FrameWriter(wire::Op::Create).u8(2).u8(0).finish());
+        const vector<uint8_t> reply = readFrame(client);
+        REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Created);
+        tables.push_back(wire::FrameReader(reply.data(), reply.size()).u32());
+        if (grown.owner(tables.back()) == engines[2]) moving = tables.back();
+    }
+    sendFrame(client, wire::FrameWriter(wire::Op::Join).u32(moving).u8(0).finish());
+    sendFrame(client, wire::FrameWriter(wire::Op::Join).u32(moving).u8(1).finish());
+    sendFrame(client, wire::FrameWriter(wire::Op::Act).u32(moving).u8(actions::GATHER).finish());
+    readOk(client, 1);
+    coordinator.stop();
+    loop.join();
+    CHECK(coordinator.ownerOf(moving) != engines[2]);
+
+    pids.push_back(spawnEngine(engines[2]));
+    const size_t expected = static_cast<size_t>(count_if(tables.begin(), tables.end(), [&](const uint32_t t) {
+        return grown.owner(t) == engines[2];
+    }));
+    CHECK(attachEngine(coordinator, engines[2]) == expected);
+    CHECK(coordinator.ownerOf(moving) == engines[2]);
+    loop = thread([&] { coordinator.run(); });
+    // Seats were joined again on the new engine, and the game carries on from P1's turn
+    sendFrame(client, wire::FrameWriter(wire::Op::Act).u32(moving).u8(actions::TAX).finish());
+    readOk(client, 2);
+    coordinator.stop();
+    loop.join();
+
+    CHECK(coordinator.removeEngine(engines[0]) ==
+          static_cast<size_t>(count_if(tables.begin(), tables.end(), [&](const uint32_t t) {
+              return grown.owner(t) == engines[0];
+          })));
+    CHECK(coordinator.engineCount() == 2u);
+    CHECK(coordinator.tableCount() == tables.size());
+    for (const uint32_t table: tables) CHECK(coordinator.ownerOf(table) != engines[0]);
+
+    // A crashed engine takes only its own tables down
+    kill(pids[1], SIGKILL);
+    waitpid(pids[1], nullptr, 0);
+    for (int i = 0; i < 200 && coordinator.engineCount() == 2; ++i) coordinator.poll(10);
+    CHECK(coordinator.engineCount() == 1u);
+    CHECK(coordinator.ownerOf(moving) == engines[2]);
+    uint32_t lost = 0;
+    for (const uint32_t table: tables) {
+        if (coordinator.ownerOf(table).empty()) lost = table;
+    }
+    loop = thread([&] { coordinator.run(); });
+    sendFrame(client, wire::FrameWriter(wire::Op::State).u32(moving).finish());
+    vector<uint8_t> reply;
+    do {
+        reply = readFrame(client);
+    } while (static_cast<wire::Op>(reply[0]) == wire::Op::Delta); // the push after TAX
+    CHECK(static_cast<wire::Op>(reply[0]) == wire::Op::Snapshot);
+    if (lost != 0) {
+        sendFrame(client, wire::FrameWriter(wire::Op::State).u32(lost).finish());
+        CHECK(static_cast<wire::Op>(readFrame(client)[0]) == wire::Op::Error);
+    }
+    coordinator.stop();
+    loop.join();
+
+    // A failed move leaves the table on its old engine, seats and all
+    string refusing;
+    for (int n = 3; refusing.empty(); ++n) {
+        HashRing next;
+        next.add(engines[2]);
+        next.add("coup_test_engine." + to_string(n) + ".sock");
+        if (next.owner(moving) != engines[2]) refusing = next.owner(moving);
+    }
+    const pid_t stub = spawnRefusingEngine(refusing);
+    const size_t held = coordinator.tableCount();
+    CHECK_THROWS_AS(coordinator.addEngine(refusing), runtime_error);
+    CHECK(coordinator.ownerOf(moving) == engines[2]);
+    CHECK(coordinator.tableCount() == held);
+    loop = thread([&] { coordinator.run(); });
+    const int latecomer = connectTcp(port);
+    sendFrame(latecomer, wire::FrameWriter(wire::Op::Join).u32(moving).u8(0).finish());
+    reply = readFrame(latecomer);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Error);
+    CHECK(reply[1] == static_cast<uint8_t>(wire::ErrorCode::SeatTaken)); // joined again on the old engine
+    ::close(latecomer);
+    coordinator.stop();
+    loop.join();
+    ::close(client);
+    for (const pid_t pid: {pids[0], pids[2], stub}) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    for (const string& engine: engines) remove(engine.c_str());
+    remove(refusing.c_str());
+
+    // Moving tables is for the coordinator's control socket only, and images are checked before they land
+    const string publicPath = "coup_test_public.sock";
+    const string controlPath = "coup_test_control.sock";
+    GameServer engine;
+    engine.listenUnix(publicPath);
+    engine.listenControl(controlPath);
+    loop = thread([&] { engine.run(); });
+    const int player = connectUnix(publicPath);
+    sendFrame(player, wire::FrameWriter(wire::Op::Create).u8(2).u8(0).finish());
+    reply = readFrame(player);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Created);
+    const uint32_t seated = wire::FrameReader(reply.data(), reply.size()).u32();
+    sendFrame(player, wire::FrameWriter(wire::Op::Join).u32(seated).u8(0).finish());
+    readFrame(player);
+    readFrame(player);
+    sendFrame(player, wire::FrameWriter(wire::Op::Export).u32(seated).finish());
+    reply = readFrame(player);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Error);
+    CHECK(reply[1] == static_cast<uint8_t>(wire::ErrorCode::Malformed));
+    ::close(player);
+    const int other = connectUnix(publicPath);
+    sendFrame(other, wire::FrameWriter(wire::Op::Relay).u32(1).u8(static_cast<uint8_t>(wire::Op::State)).u32(seated)
+                             .finish());
+    CHECK(static_cast<wire::Op>(readFrame(other)[0]) == wire::Op::Error);
+    ::close(other);
+
+    const int control = connectUnix(controlPath);
+    sendFrame(control, wire::FrameWriter(wire::Op::State).u32(seated).finish());
+    CHECK(static_cast<wire::Op>(readFrame(control)[0]) == wire::Op::Snapshot); // the table survived
+    sendFrame(control, wire::FrameWriter(wire::Op::Export).u32(seated).finish());
+    reply = readFrame(control);
+    REQUIRE(static_cast<wire::Op>(reply[0]) == wire::Op::Image);
+    vector<uint8_t> image(reply.begin() + 1, reply.end());
+    const auto importImage = [&](const vector<uint8_t>& bytes) {
+        sendFrame(control, wire::FrameWriter(wire::Op::Import).u32(seated).raw(bytes.data(), bytes.size()).finish());
+        return static_cast<wire::Op>(readFrame(control)[0]);
+    };
+    const uint8_t seats = image[28]; // after the 20-byte header, the table id and its version
+    CHECK(seats == 2u);
+    for (const uint8_t bad: {0, 1, 7}) {
+        image[28] = bad;
+        CHECK(importImage(image) == wire::Op::Error);
+    }
+    image[28] = seats;
+    CHECK(importImage(image) == wire::Op::Ok);
+    ::close(control);
+    engine.stop();
+    loop.join();
+    REQUIRE(engine.host().find(seated));
+    CHECK(engine.host().find(seated)->seatOwner.size() == 2u);
+
+    Game two({"P0", "P1"}, false);
+    TurnPipeline pipeline(two);
+    vector<uint8_t> packed = pipeline.pack();
+    packed[1] = actions::COUNT;
+    CHECK_THROWS_AS(pipeline.unpack(packed.data(), packed.size()), InitError);
+    packed = pipeline.pack();
+    packed[2] = static_cast<uint8_t>(ActionType::Skip) + 1;
+    CHECK_THROWS_AS(pipeline.unpack(packed.data(), packed.size()), InitError);
+}
+
+TEST_CASE("Out-of-process bots answer through a shared-memory ring") {
+    const string name = "/coup_test_bot." + to_string(getpid());
+    BotChannel channel = BotChannel::create(name, 6); // smaller than a batch, so the rings wrap
+    CHECK(channel.capacity() == 8u);
+    const auto lowest = [](const uint32_t legal) {
+        int answer = 0;
+        while (!(legal >> answer & 1u)) ++answer;
+        return answer;
+    };
+    const pid_t bot = fork();
+    if (bot == 0) {
+        int status = 1;
+        try {
+            BotChannel mine = BotChannel::attach(name);
+            serveBot(mine, [&](const BotRequest& request) {
+                // An observation that did not arrive intact gets an illegal answer
+                if (request.kind == DecisionKind::Turn && request.observation[obs::IS_MY_TURN] != 1) return 99;
+                return lowest(request.legal);
+            });
+            status = 0;
+        } catch (...) {
+        }
+        _exit(status);
+    }
+
+    DecisionService remote(remoteBatchPolicy(channel), 32);
+    DecisionService local([&](const vector<DecisionRequest>& requests, vector<int>& answers) {
+        for (size_t i = 0; i < requests.size(); ++i) answers[i] = lowest(requests[i].legal);
+    }, 32);
+    for (int g = 0; g < 24; ++g) {
+        vector<string> names;
+        for (int seat = 0; seat < 2 + g % 5; ++seat) names.push_back("P" + to_string(seat));
+        remote.addGame(Game(names), 400);
+        local.addGame(Game(names), 400);
+    }
+    remote.run();
+    local.run();
+    CHECK(remote.requestsAnswered() == local.requestsAnswered());
+    bool same = true;
+    for (size_t g = 0; g < remote.size(); ++g) {
+        same &= remote.decisions(g) == local.decisions(g);
+        same &= (remote.winner(g) ? remote.winner(g)->getName() : "") ==
+                (local.winner(g) ? local.winner(g)->getName() : "");
+    }
+    CHECK(same);
+
+    channel.close();
+    int status = -1;
+    waitpid(bot, &status, 0);
+    CHECK((WIFEXITED(status) && WEXITSTATUS(status) == 0));
+    CHECK_THROWS_AS(BotChannel::attach("/coup_test_no_such_bot"), runtime_error);
+
+    // Answers to a batch that timed out do not count for the next one
+    const string lateName = name + ".late";
+    BotChannel late = BotChannel::create(lateName, 8);
+    const BatchPolicy impatient = remoteBatchPolicy(late, 200);
+    const Game two(vector<string>{"P0", "P1"});
+    vector<DecisionRequest> requests(4);
+    for (DecisionRequest& request: requests) {
+        request.state = &two;
+        request.player = two.getPlayers()[0];
+        request.legal = 1u << 1;
+    }
+    vector<int> answers(requests.size(), -1);
+    CHECK_THROWS_AS(impatient(requests, answers), runtime_error); // nobody serves yet
+    thread server([&] {
+        BotChannel mine = BotChannel::attach(lateName);
+        serveBot(mine, [&](const BotRequest& request) {
+            if (request.legal == 1u << 3) this_thread::sleep_for(chrono::milliseconds(5)); // old answers come first
+            return lowest(request.legal);
+        });
+    });
+    for (DecisionRequest& request: requests) request.legal = 1u << 3;
+    impatient(requests, answers);
+    CHECK(answers == vector<int>(requests.size(), 3));
+    late.close();
+    server.join();
+}
+
+TEST_CASE("Action inbox takes answers from many threads and applies them on the owner") {
+    MpscQueue<uint64_t> queue(100);
+    CHECK(queue.capacity() == 128u);
+    constexpr uint64_t producers = 4, perProducer = 20000;
+    vector<thread> threads;
+    for (uint64_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (uint64_t i = 0; i < perProducer; ++i) {
+                uint64_t value = p << 32 | i;
+                while (!queue.tryPush(value)) this_thread::yield();
+            }
+        });
+    }
+    vector<uint64_t> next(producers, 0);
+    bool ordered = true;
+    uint64_t popped = 0;
+    while (popped < producers * perProducer) {
+        uint64_t value;
+        if (!queue.tryPop(value)) continue;
+        const uint64_t p = value >> 32;
+        ordered &= p < producers && (value & 0xffffffffu) == next[p];
+        if (p < producers) ++next[p];
+        ++popped;
+    }
+    for (thread& t: threads) t.join();
+    CHECK(ordered); // each producer's values arrive once and in order
+    uint64_t extra;
+    CHECK_FALSE(queue.tryPop(extra));
+
+    Game game(vector<string>{"Gov", "Spy"});
+    Player* gov = game.getPlayers()[0];
+    Player* spy = game.getPlayers()[1];
+    TurnPipeline pipeline(game);
+    ActionInbox inbox(pipeline, 4);
+    using Source = Submission::Source;
+    CHECK(inbox.submit({Source::Player, spy, Await::Action, actions::GATHER, 0, 1}));  // not Spy's turn
+    CHECK(inbox.submit({Source::Player, gov, Await::Action, actions::GATHER, 0, 2}));
+    CHECK(inbox.submit({Source::Timer, nullptr, Await::Action, 0, 0, 3}));             // lost the race
+    CHECK(inbox.submit({Source::Player, spy, Await::Action, actions::TAX, 1, 4}));
+    CHECK_FALSE(inbox.submit({Source::Player, spy, Await::Action, actions::TAX, 1, 5})); // full
+    vector<uint64_t> applied;
+    CHECK(inbox.drain([&](const Submission& s, const bool ok) { if (ok) applied.push_back(s.tag); }) == 2u);
+    CHECK(applied == vector<uint64_t>{2, 4});
+    CHECK(inbox.rejected() == 2u);
+    CHECK(inbox.version() == 2u);
+    REQUIRE(pipeline.awaiting() == Await::Block);
+    CHECK(pipeline.decider() == gov);
+
+    // The Governor's block and the block clock race from two threads; exactly one wins
+    thread blocker([&] { inbox.submit({Source::Player, gov, Await::Block, 1, 2, 6}); });
+    thread timer([&] { inbox.submit({Source::Timer, nullptr, Await::Block, 0, 2, 7}); });
+    blocker.join();
+    timer.join();
+    CHECK(inbox.drain() == 1u);
+    CHECK(inbox.version() == 3u);
+    CHECK(pipeline.awaiting() == Await::Action);
+    CHECK((spy->getCoins() == 0 || spy->getCoins() == 2)); // blocked, or the clock let the tax through
+}
+
+TEST_CASE("Game mirror lets readers copy snapshots while the owner plays") {
+    GameMirror mirror;
+    CHECK(mirror.version() == 0u);
+    CHECK_THROWS_AS(mirror.publish(Game(vector<string>{"A", "B", "C", "D", "E", "F", "G"}, false)), InitError);
+
+    // The owner plays games out through an inbox and keeps its own copy of every publication
+    vector<vector<uint8_t>> published;
+    published.reserve(20000);
+    const auto remember = [&] {
+        const GameSnapshot snapshot = mirror.read();
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&snapshot);
+        published.emplace_back(bytes, bytes + sizeof(snapshot));
+    };
+    atomic<bool> playing{true};
+    struct Sample {
+        vector<uint8_t> bytes;
+        uint64_t version;
+    };
+    vector<vector<Sample>> samples(3);
+    atomic<bool> sane{true};
+    vector<thread> readers;
+    for (size_t r = 0; r < samples.size(); ++r) {
+        readers.emplace_back([&, r] {
+            uint64_t last = 0;
+            while (mirror.version() == 0) this_thread::yield();
+            while (playing.load()) {
+                const GameSnapshot s = mirror.read();
+                if (s.version < last || s.playerCount < 1 || s.playerCount > 6 || s.turn >= s.playerCount ||
+                    s.nameOf(0).empty()) {
+                    sane = false;
+                }
+                last = s.version;
+                if (samples[r].size() < 2000) {
+                    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&s);
+                    samples[r].push_back({vector<uint8_t>(bytes, bytes + sizeof(s)), s.version});
+                }
+            }
+        });
+    }
+    mt19937 rng(45);
+    for (int g = 0; g < 30; ++g) {
+        vector<string> names;
+        for (int seat = 0; seat < 2 + g % 5; ++seat) names.push_back("Player" + to_string(seat) + "WithALongName");
+        Game game(names);
+        TurnPipeline pipeline(game);
+        ActionInbox inbox(pipeline);
+        inbox.setMirror(&mirror);
+        remember();
+        for (int d = 0; d < 300 && pipeline.awaiting() != Await::Done; ++d) {
+            const uint32_t legal = pipeline.legal();
+            vector<int> choices;
+            for (int a = 0; a < 32; ++a) if (legal >> a & 1u) choices.push_back(a);
+            inbox.submit({Submission::Source::Player, pipeline.decider(), pipeline.awaiting(),
+                          choices[rng() % choices.size()], inbox.version(), 0});
+            if (inbox.drain() == 1) remember();
+        }
+        const GameSnapshot last = mirror.read();
+        CHECK(last.playerCount == game.getPlayers().size());
+        CHECK(last.nameOf(0) == game.getPlayers()[0]->getName().substr(0, GameSnapshot::NAME_LENGTH));
+        CHECK(last.over() == (pipeline.awaiting() == Await::Done));
+    }
+    playing = false;
+    for (thread& t: readers) t.join();
+    CHECK(sane.load());
+    CHECK(mirror.version() == published.size());
+    bool exact = true;
+    for (const vector<Sample>& mine: samples) {
+        for (const Sample& sample: mine) {
+            exact &= sample.version < published.size() && sample.bytes == published[sample.version];
+        }
+    }
+    CHECK(exact); // every copy a reader took is exactly one published state, never a mix
+}
+
+TEST_CASE("Tournament rotates bots through every role and resumes from its journal") {
+    CHECK_THROWS_AS(Game({"A", "B"}, vector<Role>{Role::Spy}), InitError);
+    CHECK_THROWS_AS(Game({"A", "B"}, vector<Role>{Role::Spy, Role::Unknown}), InitError);
+    const Game dealt({"A", "B", "C"}, vector<Role>{Role::Merchant, Role::Merchant, Role::Judge});
+    CHECK(dealt.getPlayers()[1]->getRole() == Role::Merchant);
+    CHECK(dealt.getPlayers()[2]->getRole() == Role::Judge);
+
+    CHECK(placementPoints({0, 2, 1}, 0) == doctest::Approx(1.0));
+    CHECK(placementPoints({0, 2, 1}, 1) == doctest::Approx(0.0));
+    CHECK(placementPoints({0, 0, 2}, 1) == doctest::Approx(0.75)); // unfinished: survivors share first and second
+
+    const BotRegistry registry = BotRegistry::builtins();
+    BotRegistry more = registry;
+    CHECK_THROWS_AS(more.add("random", [] { return BatchPolicy(heuristicBatchPolicy); }), InitError);
+    CHECK(more.names().size() == 3u);
+    BatchPolicy heuristic = registry.create("heuristic");
+    BatchPolicy passive = registry.create("passive");
+    const SeatedResult game = playSeated({&heuristic, &passive}, {Role::Baron, Role::Spy}, 500);
+    CHECK(game.finished);
+    CHECK(game.ranks[0] + game.ranks[1] == 1);
+
+    Tournament::Options options;
+    options.seats = {2, 3};
+    options.threads = 1;
+    const vector<string> bots{"heuristic", "random", "passive"};
+    CHECK_THROWS_AS(Tournament(registry, {"heuristic"}, options), InitError);
+    CHECK_THROWS_AS(Tournament(registry, {"heuristic", "nobody"}, options), InitError);
+
+    Tournament serial(registry, bots, options);
+    CHECK(serial.run() == 3 * 6 + 6);
+    bool everyRole = true;
+    for (const EntrantRecord& r: serial.standings()) {
+        CHECK(r.games == 2 * 6 + 6);
+        for (size_t slot = 0; slot < ROLE_CYCLE.size(); ++slot) everyRole &= r.roleGames[slot] == 3;
+    }
+    CHECK(everyRole);
+    CHECK(serial.standings()[serial.ranking()[0]].bot == "heuristic");
+
+    options.threads = 4;
+    Tournament parallel(registry, bots, options);
+    parallel.run();
+    bool same = true;
+    for (size_t e = 0; e < bots.size(); ++e) {
+        same &= parallel.standings()[e].points == serial.standings()[e].points;
+        same &= parallel.standings()[e].roleWins == serial.standings()[e].roleWins;
+    }
+    CHECK(same);
+
+    // Cut the journal short in the middle of a line, as a crash would
+    const string path = "tournament_test.journal";
+    std::remove(path.c_str());
+    options.journal = path;
+    Tournament first(registry, bots, options);
+    CHECK(first.run() == 24u);
+    vector<string> lines;
+    {
+        ifstream in(path);
+        for (string line; getline(in, line);) lines.push_back(line);
+    }
+    REQUIRE(lines.size() == 25u);
+    {
+        ofstream out(path, ios::trunc);
+        for (size_t i = 0; i < 11; ++i) out << lines[i] << '\n';
+        out << lines[11].substr(0, 3);
+    }
+    Tournament resumed(registry, bots, options);
+    CHECK(resumed.run() == 14u);
+    CHECK(resumed.resumed() == 10u);
+    same = true;
+    for (size_t e = 0; e < bots.size(); ++e) same &= resumed.standings()[e].points == serial.standings()[e].points;
+    CHECK(same);
+    Tournament again(registry, bots, options);
+    CHECK(again.run() == 0u);
+    CHECK(again.resumed() == 24u);
+
+    Tournament stranger(registry, {"random", "heuristic", "passive"}, options);
+    CHECK_THROWS_AS(stranger.run(), InitError);
+    std::remove(path.c_str());
+
+    Tournament::Options swiss;
+    swiss.format = Tournament::Format::Swiss;
+    swiss.rounds = 3;
+    swiss.seats = {2, 4};
+    swiss.threads = 3;
+    Tournament ladder(registry, {"heuristic", "random", "passive", "random", "heuristic"}, swiss);
+    CHECK(ladder.roundCount() == 3u);
+    CHECK(ladder.run() == (2 + 1 + 2) * 6u); // pairs, then a table of four, then pairs; the odd one sits out
+    uint32_t games = 0;
+    for (const EntrantRecord& r: ladder.standings()) games += r.games;
+    CHECK(games == (4 + 4 + 4) * 6u);
+}
+
+TEST_CASE("SPRT harness stops once mirrored pairs decide which bot is stronger") {
+    PairStats stats;
+    CHECK(stats.mean() == doctest::Approx(0.5));
+    CHECK(stats.llr(0.0, 30.0) == doctest::Approx(0.0));
+    stats.add(1.0, 0.5);  // 3/4
+    stats.add(0.0, 0.5);  // 1/4
+    stats.add(1.0, 1.0);  // 1
+    stats.add(0.5, 0.5);  // 1/2
+    CHECK(stats.pairs() == 4u);
+    CHECK(stats.outcomes()[3] == 1u);
+    CHECK(stats.mean() == doctest::Approx(0.625));
+    CHECK(stats.variance() == doctest::Approx((0.015625 + 0.140625 + 0.140625 + 0.015625) / 4));
+    const double s1 = 1.0 / (1.0 + pow(10.0, -30.0 / 400.0));
+    CHECK(stats.llr(0.0, 30.0) == doctest::Approx(4 * (s1 - 0.5) * (1.25 - 0.5 - s1) / (2 * stats.variance())));
+    CHECK(stats.llr(0.0, -30.0) < 0.0);
+    CHECK(stats.elo() == doctest::Approx(-400.0 * log10(1.0 / 0.625 - 1.0)));
+    PairStats more;
+    more.add(0.0, 0.0);
+    more.merge(stats);
+    CHECK(more.pairs() == 5u);
+    CHECK(more.mean() == doctest::Approx(0.5));
+    CHECK_THROWS_AS(more.add(1.0, 1.5), InitError);
+
+    set<pair<Role, Role>> matchups;
+    for (uint64_t p = 0; p < 30; ++p) {
+        const array<Role, 2> roles = Sprt::pairRoles(p);
+        CHECK(roles[0] != roles[1]);
+        matchups.insert({roles[0], roles[1]});
+    }
+    CHECK(matchups.size() == 30u); // every ordered pair of different roles once per 30 pairs
+
+    const BotRegistry registry = BotRegistry::builtins();
+    Sprt::Options options;
+    CHECK_THROWS_AS(Sprt(registry, "heuristic", "nobody", options), InitError);
+    options.alpha = 0.5;
+    CHECK_THROWS_AS(Sprt(registry, "heuristic", "passive", options), InitError);
+    options.alpha = 0.05;
+    options.threads = 2;
+
+    Sprt better(registry, "heuristic", "passive", options);
+    CHECK(better.run() == Sprt::Verdict::Stronger);
+    CHECK(better.verdict() == Sprt::Verdict::Stronger);
+    CHECK(better.llrStronger() >= better.upper());
+    CHECK(better.games() < 200u);
+    bool everyRole = true;
+    for (size_t slot = 0; slot < ROLE_CYCLE.size(); ++slot) everyRole &= better.roleGames()[slot] > 0;
+    CHECK(everyRole);
+    CHECK(Sprt(registry, "passive", "heuristic", options).run() == Sprt::Verdict::Weaker);
+    CHECK(Sprt(registry, "heuristic", "heuristic", options).run() == Sprt::Verdict::Equal);
+
+    // The verdict comes at the same pair however many threads play
+    options.threads = 1;
+    Sprt serial(registry, "random", "passive", options);
+    const Sprt::Verdict verdict = serial.run();
+    CHECK(verdict != Sprt::Verdict::Undecided);
+    options.threads = 4;
+    options.batch = 3;
+    Sprt parallel(registry, "random", "passive", options);
+    size_t batches = 0;
+    CHECK(parallel.run([&batches](const Sprt&) { ++batches; }) == verdict);
+    CHECK(parallel.games() == serial.games());
+    CHECK(parallel.stats().outcomes() == serial.stats().outcomes());
+    CHECK(parallel.roleWins() == serial.roleWins());
+    CHECK(batches == (serial.games() / 2 + 11) / 12);
+
+    options.maxPairs = 2;
+    Sprt capped(registry, "random", "passive", options);
+    CHECK(capped.run() == Sprt::Verdict::Undecided);
+    CHECK(capped.games() == 4u);
+    CHECK(string(verdictName(capped.verdict())) == "undecided");
+}
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file coup_server.cpp
+ * @brief Headless Coup table server.
+ *
+ * Usage: coup_server [--port N] [--unix PATH] [--shards N] [--turn-ms N] [--block-ms N] [--budget-mb N] [--log PATH]
+ *                    [--checkpoint-ms N] [--cluster N]
+ * With no options it listens on 127.0.0.1:7777 on one thread, without clocks.
+ * --cluster N forks N engine processes on Unix sockets and serves clients from
+ * a Coordinator in this process; it does not combine with --shards or --log.
+ */
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../game/server/Coordinator.hpp"
+#include "../game/server/GameServer.hpp"
+#include "../game/server/ShardedServer.hpp"
+
+using namespace std;
+
+namespace {
+    coup::GameServer *running = nullptr;
+    coup::Coordinator *coordinating = nullptr;
+    volatile sig_atomic_t interrupted = 0;
+
+    void onSignal(int) {
+        interrupted = 1;
+        if (running) running->stop();
+        if (coordinating) coordinating->stop();
+    }
+
+    /** @brief Engine process of a cluster: one GameServer on a Unix socket until the coordinator exits. */
+    void runEngine(const string &path, const uint32_t turnMs, const uint32_t blockMs, const size_t budget) {
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        try {
+            coup::GameServer engine;
+            engine.host().setClocks(turnMs, blockMs);
+            engine.host().setMemoryBudget(budget);
+            engine.listenControl(path);
+            running = &engine;
+            signal(SIGINT, SIG_IGN); // the coordinator decides when engines stop
+            signal(SIGTERM, onSignal);
+            engine.run();
+            running = nullptr;
+        } catch (const exception &e) {
+            cerr << "Engine " << path << " failed: " << e.what() << endl;
+            _exit(1);
+        }
+        _exit(0);
+    }
+
+    int runCluster(const int engines, const int port, const string &unixPath, const uint32_t turnMs,
+                   const uint32_t blockMs, const size_t budget) {
+        coup::Coordinator coordinator;
+        vector<pid_t> children;
+        for (int i = 0; i < engines; ++i) {
+            const string path = "/tmp/coup-engine." + to_string(getpid()) + "." + to_string(i) + ".sock";
+            const pid_t child = fork();
+            if (child == 0) runEngine(path, turnMs, blockMs, budget);
+            children.push_back(child);
+            // The engine binds its socket right after fork; retry until it answers
+            for (int attempt = 0;; ++attempt) {
+                try {
+                    coordinator.addEngine(path);
+                    break;
+                } catch (const exception &) {
+                    if (attempt == 1000) throw;
+                    this_thread::sleep_for(chrono::milliseconds(5));
+                }
+            }
+        }
+        cout << "Coordinating " << engines << " engine processes" << endl;
+        if (port >= 0) {
+            cout << "Listening on 127.0.0.1:" << coordinator.listenTcp(static_cast<uint16_t>(port)) << endl;
+        }
+        if (!unixPath.empty()) {
+            coordinator.listenUnix(unixPath);
+            cout << "Listening on " << unixPath << endl;
+        }
+        coordinating = &coordinator;
+        signal(SIGINT, onSignal);
+        signal(SIGTERM, onSignal);
+        coordinator.run();
+        coordinating = nullptr;
+        for (const pid_t child: children) {
+            kill(child, SIGTERM);
+            waitpid(child, nullptr, 0);
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int port = -1;
+    string unixPath;
+    int shards = 1;
+    uint32_t turnMs = 0;
+    uint32_t blockMs = 0;
+    size_t budget = 0;
+    string logPath;
+    int checkpointMs = 0;
+    int cluster = 0;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--unix" && i + 1 < argc) {
+            unixPath = argv[++i];
+        } else if (arg == "--shards" && i + 1 < argc) {
+            shards = atoi(argv[++i]);
+        } else if (arg == "--turn-ms" && i + 1 < argc) {
+            turnMs = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--block-ms" && i + 1 < argc) {
+            blockMs = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--budget-mb" && i + 1 < argc) {
+            budget = static_cast<size_t>(atoi(argv[++i])) << 20;
+        } else if (arg == "--log" && i + 1 < argc) {
+            logPath = argv[++i];
+        } else if (arg == "--checkpoint-ms" && i + 1 < argc) {
+            checkpointMs = atoi(argv[++i]);
+        } else if (arg == "--cluster" && i + 1 < argc) {
+            cluster = atoi(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--port N] [--unix PATH] [--shards N] [--turn-ms N] [--block-ms N]"
+                    " [--budget-mb N] [--log PATH] [--checkpoint-ms N] [--cluster N]" << endl;
+            return 2;
+        }
+    }
+    if (cluster > 0 && (shards > 1 || !logPath.empty())) {
+        cerr << "--cluster does not combine with --shards or --log" << endl;
+        return 2;
+    }
+    if (port < 0 && unixPath.empty()) port = 7777;
+
+    try {
+        if (cluster > 0) {
+            return runCluster(cluster, port, unixPath, turnMs, blockMs, budget);
+        }
+        if (shards > 1) {
+            coup::ShardedServer server(static_cast<size_t>(shards));
+            server.setClocks(turnMs, blockMs);
+            server.setMemoryBudget(budget);
+            if (!logPath.empty()) {
+                cout << "Recovered " << server.openLogs(logPath) << " logged changes" << endl;
+                server.setCheckpointInterval(checkpointMs);
+            }
+            if (port >= 0) {
+                cout << "Listening on 127.0.0.1:" << server.listenTcp(static_cast<uint16_t>(port))
+                     << " with " << shards << " shards" << endl;
+            }
+            if (!unixPath.empty()) {
+                server.listenUnix(unixPath);
+                cout << "Listening on " << unixPath << endl;
+            }
+            signal(SIGINT, onSignal);
+            signal(SIGTERM, onSignal);
+            server.start();
+            while (!interrupted) pause();
+            server.stop();
+            return 0;
+        }
+        coup::GameServer server;
+        server.host().setClocks(turnMs, blockMs);
+        server.host().setMemoryBudget(budget);
+        if (!logPath.empty()) {
+            cout << "Recovered " << server.openLog(logPath) << " logged changes" << endl;
+            server.setCheckpointInterval(checkpointMs);
+        }
+        if (port >= 0) {
+            cout << "Listening on 127.0.0.1:" << server.listenTcp(static_cast<uint16_t>(port)) << endl;
+        }
+        if (!unixPath.empty()) {
+            server.listenUnix(unixPath);
+            cout << "Listening on " << unixPath << endl;
+        }
+        running = &server;
+        signal(SIGINT, onSignal);
+        signal(SIGTERM, onSignal);
+        server.run();
+        running = nullptr;
+    } catch (const exception &e) {
+        cerr << "Server failed: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
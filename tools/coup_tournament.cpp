@@ -0,0 +1,145 @@
+/**
+ * @file coup_tournament.cpp
+ * @brief Plays bots against each other and prints the standings.
+ *
+ * Usage: coup_tournament [--swiss N] [--seats 2,3,4,5,6] [--threads N] [--journal PATH] [--max-decisions N] BOT BOT...
+ *        coup_tournament --sprt [--elo N] [--alpha P] [--beta P] [--max-pairs N] [--threads N] [--max-decisions N]
+ *                        CANDIDATE BASELINE
+ * A BOT is a builtin (heuristic, random, passive) or mlp:PATH for a saved network.
+ * Without --swiss every group of bots meets once at every table size. With
+ * --journal an interrupted run started again with the same options resumes.
+ * --sprt plays CANDIDATE against BASELINE until a sequential test calls it
+ * stronger, weaker or equal (exit status 0, 3 and 4; 5 when undecided).
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../game/bot/Mlp.hpp"
+#include "../game/sim/Sprt.hpp"
+#include "../game/sim/Tournament.hpp"
+
+using namespace std;
+
+namespace {
+    vector<int> parseSeats(const string &list) {
+        vector<int> seats;
+        istringstream in(list);
+        string item;
+        while (getline(in, item, ',')) seats.push_back(atoi(item.c_str()));
+        return seats;
+    }
+
+    int runSprt(const coup::BotRegistry &registry, const vector<string> &bots, const coup::Sprt::Options &options) {
+        coup::Sprt sprt(registry, bots[0], bots[1], options);
+        const coup::Sprt::Verdict verdict = sprt.run([](const coup::Sprt &s) {
+            cerr << "\r" << s.games() << " games, elo " << s.stats().elo() << ", llr " << s.llrStronger() << " / "
+                 << s.llrWeaker() << " in [" << s.lower() << ", " << s.upper() << "]   " << flush;
+        });
+        cerr << endl;
+        const auto &outcomes = sprt.stats().outcomes();
+        printf("%s against %s: %s after %llu games, elo %+.1f, pairs %llu/%llu/%llu/%llu/%llu\n", bots[0].c_str(),
+               bots[1].c_str(), coup::verdictName(verdict), static_cast<unsigned long long>(sprt.games()),
+               sprt.stats().elo(), static_cast<unsigned long long>(outcomes[0]),
+               static_cast<unsigned long long>(outcomes[1]), static_cast<unsigned long long>(outcomes[2]),
+               static_cast<unsigned long long>(outcomes[3]), static_cast<unsigned long long>(outcomes[4]));
+        printf("wins by role G/S/B/Ge/J/M:");
+        for (size_t slot = 0; slot < sprt.roleGames().size(); ++slot) {
+            printf(" %u/%u", sprt.roleWins()[slot], sprt.roleGames()[slot]);
+        }
+        printf("\n");
+        switch (verdict) {
+            case coup::Sprt::Verdict::Stronger: return 0;
+            case coup::Sprt::Verdict::Weaker: return 3;
+            case coup::Sprt::Verdict::Equal: return 4;
+            default: return 5;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    coup::Tournament::Options options;
+    coup::Sprt::Options sprt;
+    bool sequential = false;
+    vector<string> entrants;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "--swiss" && i + 1 < argc) {
+            options.format = coup::Tournament::Format::Swiss;
+            options.rounds = atoi(argv[++i]);
+        } else if (arg == "--seats" && i + 1 < argc) {
+            options.seats = parseSeats(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg == "--journal" && i + 1 < argc) {
+            options.journal = argv[++i];
+        } else if (arg == "--max-decisions" && i + 1 < argc) {
+            options.maxDecisions = atoi(argv[++i]);
+        } else if (arg == "--sprt") {
+            sequential = true;
+        } else if (arg == "--elo" && i + 1 < argc) {
+            sprt.elo = atof(argv[++i]);
+        } else if (arg == "--alpha" && i + 1 < argc) {
+            sprt.alpha = atof(argv[++i]);
+        } else if (arg == "--beta" && i + 1 < argc) {
+            sprt.beta = atof(argv[++i]);
+        } else if (arg == "--max-pairs" && i + 1 < argc) {
+            sprt.maxPairs = strtoull(argv[++i], nullptr, 10);
+        } else if (arg.rfind("--", 0) != 0) {
+            entrants.push_back(arg);
+        } else {
+            entrants.clear();
+            break;
+        }
+    }
+    if (entrants.size() < 2 || (sequential && entrants.size() != 2)) {
+        cerr << "Usage: " << argv[0] << " [--swiss N] [--seats 2,3,4,5,6] [--threads N] [--journal PATH]"
+                " [--max-decisions N] BOT BOT...\n"
+                "       " << argv[0] << " --sprt [--elo N] [--alpha P] [--beta P] [--max-pairs N] [--threads N]"
+                " [--max-decisions N] CANDIDATE BASELINE" << endl;
+        return 2;
+    }
+
+    try {
+        coup::BotRegistry registry = coup::BotRegistry::builtins();
+        for (const string &bot: entrants) {
+            if (registry.has(bot) || bot.rfind("mlp:", 0) != 0) continue;
+            // One network per file, shared by every worker: evaluation does not modify it
+            auto net = make_shared<coup::Mlp>(coup::Mlp::load(bot.substr(4)));
+            registry.add(bot, [net] { return coup::mlpBatchPolicy(*net); });
+        }
+        if (sequential) {
+            sprt.threads = options.threads;
+            sprt.maxDecisions = options.maxDecisions;
+            return runSprt(registry, entrants, sprt);
+        }
+        coup::Tournament tournament(registry, entrants, options);
+
+        size_t games = 0;
+        const size_t played = tournament.run([&games](const coup::Fixture &, const coup::SeatedResult &) {
+            if (++games % 100 == 0) cerr << "\r" << games << " games" << flush;
+        });
+        cerr << "\r" << games << " games (" << tournament.resumed() << " from the journal, " << played
+             << " played)" << endl;
+
+        const auto &records = tournament.standings();
+        printf("%-4s %-24s %7s %7s %7s  %s\n", "#", "bot", "games", "wins", "score", "wins by role G/S/B/Ge/J/M");
+        size_t place = 0;
+        for (const size_t e: tournament.ranking()) {
+            const coup::EntrantRecord &r = records[e];
+            printf("%-4zu %-24s %7u %7u %7.4f ", ++place, r.bot.c_str(), r.games, r.wins, r.score());
+            for (size_t slot = 0; slot < r.roleGames.size(); ++slot) {
+                printf(" %u/%u", r.roleWins[slot], r.roleGames[slot]);
+            }
+            printf("\n");
+        }
+    } catch (const exception &e) {
+        cerr << "Tournament failed: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}